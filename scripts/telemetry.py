@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+soxim-telemetry: Watch a running simulation
+
+Polls the Telemetry.stats block a simulation run with --telemetry K
+publishes, and optionally stops runs that have saturated.
+"""
+
+import argparse
+import mmap
+import os
+import signal
+import struct
+import sys
+import time
+from pathlib import Path
+
+# "SOXTEL01" u64(sequence) TelemetrySnapshot, see src/Telemetry.h
+MAGIC = b'SOXTEL01'
+SNAPSHOT = struct.Struct('=6q2d2q')
+FIELDS = ('process_id', 'cycle', 'total_cycles', 'injected', 'in_flight',
+          'delivered', 'mean_latency', 'p99_latency', 'queue_flits',
+          'max_queue_flits')
+BLOCK_SIZE = 16 + SNAPSHOT.size
+
+
+def parse_arguments():
+    """Parse command line arguments."""
+    parser = argparse.ArgumentParser(
+        description='Watch a running simulation through its telemetry',
+        formatter_class=argparse.RawDescriptionHelpFormatter,
+        epilog='''
+Examples:
+  %(prog)s traffic/                         # print progress until the run ends
+  %(prog)s traffic/Telemetry.stats --once   # print one snapshot
+  %(prog)s traffic/ --kill-saturated        # stop the run once it saturates
+        '''
+    )
+
+    parser.add_argument('input', help='Telemetry.stats or the output directory')
+    parser.add_argument('-i', '--interval', type=float, default=1.0,
+                        help='Seconds between polls')
+    parser.add_argument('--once', action='store_true',
+                        help='Print one snapshot and exit')
+    parser.add_argument('--kill-saturated', action='store_true',
+                        help='Send SIGTERM to the run once it saturates')
+    parser.add_argument('--window', type=int, default=5,
+                        help='Snapshots in-flight packets must grow in a row to count as saturated')
+    parser.add_argument('--max-queue-flits', type=int, default=1000,
+                        help='Source queue depth of the fullest terminal that counts as saturated')
+
+    return parser.parse_args()
+
+
+def read_snapshot(block):
+    """Copy a consistent snapshot out of the seqlock; None if not ready."""
+    if block[:8] != MAGIC:
+        return None
+    for _ in range(1000):
+        before, = struct.unpack_from('=Q', block, 8)
+        if before % 2:
+            continue
+        values = SNAPSHOT.unpack_from(block, 16)
+        after, = struct.unpack_from('=Q', block, 8)
+        if before == after:
+            return dict(zip(FIELDS, values))
+    return None
+
+
+def format_snapshot(snapshot):
+    """One progress line."""
+    progress = snapshot['cycle'] / max(snapshot['total_cycles'], 1) * 100
+    return (f"cycle {snapshot['cycle']}/{snapshot['total_cycles']} ({progress:.1f}%)  "
+            f"injected {snapshot['injected']}  in flight {snapshot['in_flight']}  "
+            f"delivered {snapshot['delivered']}  "
+            f"latency mean {snapshot['mean_latency']:.1f} p99 {snapshot['p99_latency']:.0f}  "
+            f"queue {snapshot['queue_flits']} (max {snapshot['max_queue_flits']})")
+
+
+def is_saturated(history, window, max_queue_flits):
+    """In-flight packets grew over the whole window and a source queue is full."""
+    if len(history) <= window:
+        return False
+    recent = history[-window - 1:]
+    growing = all(b['in_flight'] > a['in_flight'] for a, b in zip(recent, recent[1:]))
+    return growing and recent[-1]['max_queue_flits'] >= max_queue_flits
+
+
+def watch(block, args):
+    """Print snapshots until the run ends or is stopped."""
+    history = []
+    while True:
+        snapshot = read_snapshot(block)
+        if snapshot is not None and (not history or snapshot['cycle'] != history[-1]['cycle']):
+            history.append(snapshot)
+            print(format_snapshot(snapshot), flush=True)
+            if snapshot['cycle'] >= snapshot['total_cycles']:
+                return 0
+            if args.kill_saturated and is_saturated(history, args.window,
+                                                    args.max_queue_flits):
+                print(f"Saturated, stopping process {snapshot['process_id']}")
+                try:
+                    os.kill(snapshot['process_id'], signal.SIGTERM)
+                except ProcessLookupError:
+                    pass
+                return 2
+        if snapshot is not None and not process_exists(snapshot['process_id']):
+            print("The simulation exited before its last cycle")
+            return 1
+        time.sleep(args.interval)
+
+
+def process_exists(process_id):
+    """Whether the simulation is still running."""
+    try:
+        os.kill(process_id, 0)
+    except ProcessLookupError:
+        return False
+    except PermissionError:
+        pass
+    return True
+
+
+def main():
+    args = parse_arguments()
+    path = Path(args.input)
+    if path.is_dir():
+        path = path / 'Telemetry.stats'
+
+    # the run creates the file when it starts
+    while not path.exists() or path.stat().st_size < BLOCK_SIZE:
+        if args.once:
+            print(f"Error: No telemetry at {path}", file=sys.stderr)
+            return 1
+        time.sleep(args.interval)
+
+    with open(path, 'rb') as f:
+        block = mmap.mmap(f.fileno(), BLOCK_SIZE, access=mmap.ACCESS_READ)
+    if args.once:
+        snapshot = read_snapshot(block)
+        if snapshot is None:
+            print(f"Error: No telemetry at {path}", file=sys.stderr)
+            return 1
+        print(format_snapshot(snapshot))
+        return 0
+    return watch(block, args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
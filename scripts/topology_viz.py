@@ -25,6 +25,7 @@ Examples:
   %(prog)s --topology MESH --x 4 --y 4              # 4x4 Mesh
   %(prog)s --topology TORUS --x 4 --y 4             # 4x4 Torus
   %(prog)s traffic/TrafficInformation.csv --topology MESH --x 4 --y 4
+  %(prog)s --link-counters traffic/LinkCounters.json  # hot links
         '''
     )
 
@@ -41,6 +42,11 @@ Examples:
                         help='Highlight specific nodes')
     parser.add_argument('--show-labels', action='store_true',
                         help='Show node labels')
+    parser.add_argument('--link-counters',
+                        help='LinkCounters.json to overlay; sets the topology')
+    parser.add_argument('--link-metric', default='utilisation',
+                        choices=['utilisation', 'credit_stalls', 'occupancy'],
+                        help='Link counter to color links by')
 
     return parser.parse_args()
 
@@ -58,6 +64,62 @@ def load_traffic_data(filepath):
     return df
 
 
+def load_link_counters(filepath):
+    """Load LinkCounters.json into its header and a DataFrame of ports."""
+    with open(filepath) as f:
+        counters = json.load(f)
+    df = pd.DataFrame(counters['rows'], columns=counters['columns'])
+    cycles = max(counters['cycles'], 1)
+    df['utilisation'] = df['flits'] / cycles
+    df['credit_stalls'] = df['credit_stalls'] / cycles
+    return counters, df
+
+
+def plot_link_counters(ax, df, metric, x_dim, y_dim):
+    """Color each link direction by a counter; router-to-router ports only."""
+    links = df[df['port'] >= 0]
+    if len(links) == 0:
+        return
+    vmax = max(links[metric].max(), 1e-9)
+    cmap = plt.cm.hot_r
+    offset = 0.08  # the two directions of a link side by side
+
+    for _, row in links.iterrows():
+        src, dst = int(row['router']), int(row['port'])
+        if metric == 'occupancy':
+            # the input buffers of a port hold flits coming from its neighbor
+            src, dst = dst, src
+        src_x, src_y = src % x_dim, (src // x_dim) % y_dim
+        dst_x, dst_y = dst % x_dim, (dst // x_dim) % y_dim
+        dx, dy = dst_x - src_x, dst_y - src_y
+        end = 1.0
+        if abs(dx) > 1 or abs(dy) > 1:
+            # torus wrap-around: a stub leaving the edge
+            dx, dy = -np.sign(dx), -np.sign(dy)
+            end = 0.4
+        # shift to the right of the direction of travel
+        shift_x, shift_y = dy * offset, -dx * offset
+        color = cmap(row[metric] / vmax)
+        ax.annotate('', xy=(src_x + dx * end * 0.8 + shift_x, src_y + dy * end * 0.8 + shift_y),
+                    xytext=(src_x + dx * 0.2 + shift_x, src_y + dy * 0.2 + shift_y),
+                    arrowprops=dict(arrowstyle='->', color=color, linewidth=3),
+                    zorder=2)
+
+    labels = {'utilisation': 'flits per cycle',
+              'credit_stalls': 'credit stalls per cycle',
+              'occupancy': 'mean buffered flits at the input'}
+    mappable = plt.cm.ScalarMappable(cmap=cmap, norm=plt.Normalize(0, vmax))
+    ax.figure.colorbar(mappable, ax=ax, label=labels[metric])
+
+    hottest = links.sort_values(metric, ascending=False).head(5)
+    print(f"Hottest links by {metric}:")
+    for _, row in hottest.iterrows():
+        src, dst = int(row['router']), int(row['port'])
+        if metric == 'occupancy':
+            src, dst = dst, src
+        print(f"  {src} -> {dst}: {row[metric]:.4f}")
+
+
 def plot_mesh_topology(ax, x_dim, y_dim, z_dim=1):
     """Plot 2D/3D mesh topology."""
     if z_dim > 1:
@@ -215,7 +277,14 @@ def plot_highlighted_nodes(ax, nodes, x_dim, y_dim):
 def create_topology_plot(args):
     """Create topology visualization."""
     fig, ax = plt.subplots(figsize=(12, 10))
-    
+
+    counters_df = None
+    if args.link_counters:
+        counters, counters_df = load_link_counters(args.link_counters)
+        args.topology = counters['shape']
+        args.x, args.y, args.z = counters['x'], counters['y'], counters['z']
+        print(f"Loaded link counters from: {args.link_counters}")
+
     # Plot topology
     if args.topology == 'MESH':
         plot_mesh_topology(ax, args.x, args.y, args.z)
@@ -242,6 +311,13 @@ def create_topology_plot(args):
         plot_traffic_overlay(ax, df, args.x, args.y, args.z)
         plot_routing_paths(ax, df, args.x, args.y)
     
+    # Add link counter overlay
+    if counters_df is not None:
+        if args.z > 1:
+            print("Warning: Link counters are drawn for 2D networks only")
+        else:
+            plot_link_counters(ax, counters_df, args.link_metric, args.x, args.y)
+
     # Highlight nodes
     if args.highlight_nodes:
         plot_highlighted_nodes(ax, args.highlight_nodes, args.x, args.y)
@@ -0,0 +1,115 @@
+#include "Arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <sys/mman.h>
+
+Arena::Arena(const std::string_view hugePages, const size_t capacity)
+	:
+	m_transparentHugePages{ hugePages == "thp" || hugePages == "hugetlb" },
+	m_hugeTLB{ hugePages == "hugetlb" }
+{
+	map(capacity);
+}
+
+Arena::~Arena()
+{
+	if (s_active == this)
+		s_active = nullptr;
+	for (auto& mapping : m_mappings)
+		::munmap(mapping.m_begin, mapping.m_size);
+}
+
+void Arena::map(const size_t size)
+{
+	// whole huge pages, so that none is split with other mappings
+	const size_t mappingSize{ (std::max(size, c_hugePageSize) + c_hugePageSize - 1)
+		/ c_hugePageSize * c_hugePageSize };
+	if (m_hugeTLB)
+	{
+		void* mapping{ ::mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0) };
+		if (mapping != MAP_FAILED)
+		{
+			m_mappings.push_back({ static_cast<char*>(mapping), mappingSize });
+			return;
+		}
+		std::cerr << "Warning: No huge pages reserved, "
+			<< "the network arena uses transparent huge pages\n";
+		m_hugeTLB = false;
+	}
+
+	// one huge page more, to start the mapping on a huge page boundary
+	const size_t reservedSize{ mappingSize + (m_transparentHugePages ? c_hugePageSize : 0) };
+	void* mapping{ ::mmap(nullptr, reservedSize, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0) };
+	if (mapping == MAP_FAILED)
+		throw std::bad_alloc{};
+	char* begin{ static_cast<char*>(mapping) };
+	if (m_transparentHugePages)
+	{
+		char* aligned{ reinterpret_cast<char*>(
+			(reinterpret_cast<std::uintptr_t>(begin) + c_hugePageSize - 1)
+			& ~(c_hugePageSize - 1)) };
+		if (aligned > begin)
+			::munmap(begin, aligned - begin);
+		const size_t tail{ reservedSize - (aligned - begin) - mappingSize };
+		if (tail)
+			::munmap(aligned + mappingSize, tail);
+		begin = aligned;
+		::madvise(begin, mappingSize, MADV_HUGEPAGE);
+	}
+	m_mappings.push_back({ begin, mappingSize });
+}
+
+void* Arena::allocate(const size_t size, const size_t alignment)
+{
+	size_t offset{ (m_used + alignment - 1) / alignment * alignment };
+	if (offset + size > m_mappings.back().m_size)
+	{
+		m_usedBefore += m_used;
+		map(size);
+		offset = 0;
+	}
+	m_used = offset + size;
+	return m_mappings.back().m_begin + offset;
+}
+
+bool Arena::contains(const void* address) const
+{
+	const char* byte{ static_cast<const char*>(address) };
+	for (auto& mapping : m_mappings)
+	{
+		if (byte >= mapping.m_begin && byte < mapping.m_begin + mapping.m_size)
+			return true;
+	}
+	return false;
+}
+
+size_t Arena::getMappedBytes() const
+{
+	size_t bytes{};
+	for (auto& mapping : m_mappings)
+		bytes += mapping.m_size;
+	return bytes;
+}
+
+size_t Arena::getUsedBytes() const
+{
+	return m_usedBefore + m_used;
+}
+
+bool Arena::isHugeTLB() const
+{
+	return m_hugeTLB;
+}
+
+void Arena::setActive(Arena* arena)
+{
+	s_active = arena;
+}
+
+Arena* Arena::getActive()
+{
+	return s_active;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <cassert>
+#include <new>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Network arena
+//
+// While a network is built, its routers, ports, links and terminal
+// interfaces are placed one after another in a few large mappings instead
+// of scattered over the heap: the routers in ID order, then every link next
+// to its two ports, in the order the topology connects them, and every
+// terminal interface next to its link. The mappings can be backed by
+// transparent huge pages ("thp") or by reserved huge pages ("hugetlb"),
+// which falls back to transparent huge pages if none are reserved. The
+// buffers the objects hold, e.g. the flits of a virtual channel, stay on
+// the heap.
+class Arena
+{
+public:
+	// hugePages: "none", "thp" or "hugetlb"; capacity: bytes to map first
+	Arena(const std::string_view hugePages, const size_t capacity);
+	~Arena(); // unmaps; the objects in it must be destroyed before
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	void* allocate(const size_t size, const size_t alignment);
+	bool contains(const void* address) const;
+	size_t getMappedBytes() const;
+	size_t getUsedBytes() const;
+	bool isHugeTLB() const; // backed by reserved huge pages
+
+	// the arena create() places objects of this thread in; none puts them
+	// on the heap
+	static void setActive(Arena* arena);
+	static Arena* getActive();
+
+	template<typename T, typename... Arguments>
+	static T* create(Arguments&&... arguments)
+	{
+		if (!s_active)
+			return new T{ std::forward<Arguments>(arguments)... };
+		return new (s_active->allocate(sizeof(T), alignof(T)))
+			T{ std::forward<Arguments>(arguments)... };
+	}
+	// an object of create(), while the arena it was made in is active, or
+	// none if it was made on the heap
+	template<typename T>
+	static void destroy(T* object)
+	{
+		if (!s_active)
+		{
+			delete object;
+			return;
+		}
+		assert(s_active->contains(object));
+		object->~T();
+	}
+
+private:
+	void map(const size_t size);
+
+private:
+	struct Mapping
+	{
+		char* m_begin{};
+		size_t m_size{};
+	};
+
+	static constexpr size_t c_hugePageSize{ 2 << 20 };
+
+	bool m_transparentHugePages{};
+	bool m_hugeTLB{};
+	std::vector<Mapping> m_mappings{};
+	size_t m_used{}; // of the last mapping
+	size_t m_usedBefore{}; // of the mappings before it
+
+	static inline thread_local Arena* s_active{};
+};
+
+// makes an arena active for its lifetime
+class ActiveArena
+{
+public:
+	ActiveArena(Arena* arena)
+		:
+		m_previous{ Arena::getActive() }
+	{
+		Arena::setActive(arena);
+	}
+	~ActiveArena()
+	{
+		Arena::setActive(m_previous);
+	}
+	ActiveArena(const ActiveArena&) = delete;
+	ActiveArena& operator=(const ActiveArena&) = delete;
+
+private:
+	Arena* m_previous{};
+};
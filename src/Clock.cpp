@@ -1,8 +1,8 @@
 #include "Clock.h"
 
-float Clock::get()
+double Clock::get()
 {
-	return s_clock;
+	return static_cast<double>(s_clock);
 }
 
 void Clock::tick()
@@ -15,7 +15,17 @@ bool Clock::trigger()
 	return (s_clock >= m_clock) ? true : false;
 }
 
-void Clock::set(const float interval)
+bool Clock::trigger(const double cycle)
+{
+	return cycle >= m_clock;
+}
+
+void Clock::set(const double interval)
 {
 	m_clock += interval;
-}
\ No newline at end of file
+}
+
+void Clock::reset()
+{
+	s_clock = 0;
+}
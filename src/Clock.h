@@ -4,12 +4,14 @@ class Clock
 {
 public:
 	Clock() = default;
-	float get();
+	double get(); // cycles; exact far beyond the 2^24 of a float
 	void tick();
 	bool trigger();
-	void set(const float interval);
+	bool trigger(const double cycle); // whether the local clock is due at cycle
+	void set(const double interval);
+	static void reset(); // rewind the clock of this thread for a new simulation
 
 private:
-	static inline float s_clock{}; // global clock
-	float m_clock{}; // local clock
+	static inline thread_local long long s_clock{}; // global clock of this thread
+	double m_clock{}; // local clock
 };
\ No newline at end of file
@@ -0,0 +1,489 @@
+#include "CompactTrace.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <map>
+
+constexpr std::string_view c_headerMagic{ "SOXTRC01" };
+constexpr std::string_view c_footerMagic{ "SOXTIDX1" };
+constexpr int c_columnNumber{ 6 }; // per status group
+constexpr long long c_footerSize{ 8 + 4 + 8 };
+
+static void writeVarint(std::string& bytes, unsigned long long value)
+{
+	while (value >= 0x80)
+	{
+		bytes.push_back(static_cast<char>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	bytes.push_back(static_cast<char>(value));
+}
+
+static unsigned long long readVarint(const std::string& bytes, size_t& position)
+{
+	unsigned long long value{};
+	for (int shift{}; position < bytes.size() && shift < 64; shift += 7)
+	{
+		const auto byte{ static_cast<unsigned char>(bytes[position++]) };
+		value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			break;
+	}
+	return value;
+}
+
+static unsigned long long encodeZigzag(const long long value)
+{
+	return (static_cast<unsigned long long>(value) << 1)
+		^ static_cast<unsigned long long>(value >> 63);
+}
+
+static long long decodeZigzag(const unsigned long long value)
+{
+	return static_cast<long long>(value >> 1)
+		^ -static_cast<long long>(value & 1);
+}
+
+// little-endian fixed-width integers
+template <typename T> static void writeFixed(std::string& bytes, const T value)
+{
+	for (size_t i{}; i < sizeof(T); ++i)
+		bytes.push_back(static_cast<char>(
+			(static_cast<unsigned long long>(value) >> (8 * i)) & 0xFF));
+}
+
+template <typename T> static T readFixed(const char* bytes)
+{
+	unsigned long long value{};
+	for (size_t i{}; i < sizeof(T); ++i)
+		value |= static_cast<unsigned long long>(
+			static_cast<unsigned char>(bytes[i])) << (8 * i);
+	return static_cast<T>(value);
+}
+
+static size_t getVarintSize(unsigned long long value)
+{
+	size_t size{ 1 };
+	for (; value >= 0x80; value >>= 7)
+		size++;
+	return size;
+}
+
+static int getBitLength(unsigned long long value)
+{
+	int length{};
+	for (; value; value >>= 1)
+		length++;
+	return length;
+}
+
+// column transforms; sent and received records interleave, so records
+// are grouped by status and inside a group every column is turned into
+// small unsigned values by differencing against the value it most likely
+// repeats: the previous record, or for packet IDs the previous packet of
+// the same source
+static long long getStatus(const TrafficInformationEntry& entry)
+{
+	return entry.m_status.empty() ? 0 : entry.m_status.front();
+}
+
+static std::vector<unsigned long long> encodeStatusColumn(
+	const std::vector<TrafficInformationEntry>& block)
+{
+	std::vector<unsigned long long> values{};
+	long long previous{};
+	for (auto& entry : block)
+	{
+		values.push_back(encodeZigzag(getStatus(entry) - previous));
+		previous = getStatus(entry);
+	}
+	return values;
+}
+
+static std::vector<unsigned long long> encodeColumn(
+	const std::vector<const TrafficInformationEntry*>& group, const int column)
+{
+	std::vector<unsigned long long> values{};
+	std::unordered_map<int, long long> packetIDs{}; // per source
+	long long previous{};
+	for (auto entry : group)
+	{
+		long long value{};
+		switch (column)
+		{
+		case 0:
+			value = entry->m_packetID - packetIDs[entry->m_source];
+			packetIDs[entry->m_source] = entry->m_packetID;
+			values.push_back(encodeZigzag(value));
+			continue;
+		case 1:
+			value = entry->m_source;
+			break;
+		case 2: // destinations are spread out, differencing does not help
+			values.push_back(encodeZigzag(entry->m_destination));
+			continue;
+		case 3:
+			value = entry->m_packetSize;
+			break;
+		case 4: // trace time, monotonic
+			value = getTraceTime(*entry);
+			break;
+		default: // latency of received packets, otherwise the received time
+			values.push_back(encodeZigzag(entry->m_status == "R"
+				? getTraceTime(*entry) - std::llround(entry->m_sentTime)
+				: std::llround(entry->m_receivedTime)));
+			continue;
+		}
+		values.push_back(encodeZigzag(value - previous));
+		previous = value;
+	}
+	return values;
+}
+
+static void decodeColumns(const long long status,
+	const std::vector<std::vector<unsigned long long>>& columns,
+	std::vector<TrafficInformationEntry>& group)
+{
+	std::unordered_map<int, long long> packetIDs{};
+	long long source{}, packetSize{}, time{};
+	for (size_t i{}; i < columns.front().size(); ++i)
+	{
+		source += decodeZigzag(columns.at(1).at(i));
+		packetSize += decodeZigzag(columns.at(3).at(i));
+		time += decodeZigzag(columns.at(4).at(i));
+		const long long otherTime{ decodeZigzag(columns.at(5).at(i)) };
+
+		TrafficInformationEntry entry{};
+		entry.m_source = static_cast<int>(source);
+		entry.m_packetID = static_cast<int>(packetIDs[entry.m_source]
+			+= decodeZigzag(columns.at(0).at(i)));
+		entry.m_destination = static_cast<int>(decodeZigzag(columns.at(2).at(i)));
+		entry.m_packetSize = static_cast<int>(packetSize);
+		entry.m_status = status ? std::string(1, static_cast<char>(status))
+			: std::string{};
+		if (entry.m_status == "R")
+		{
+			entry.m_receivedTime = static_cast<float>(time);
+			entry.m_sentTime = static_cast<float>(time - otherTime);
+		}
+		else
+		{
+			entry.m_sentTime = static_cast<float>(time);
+			entry.m_receivedTime = static_cast<float>(otherTime);
+		}
+		group.push_back(entry);
+	}
+}
+
+// patched bit packing: values below the escape code (all ones) are packed
+// with the width that minimises the column, the rest follow as varints;
+// a constant column is stored as its value only
+constexpr unsigned char c_constantColumn{ 0xFF };
+
+static void writeColumn(std::string& bytes,
+	const std::vector<unsigned long long>& values)
+{
+	if (std::all_of(values.begin(), values.end(),
+		[&](auto value) { return value == values.front(); }))
+	{
+		bytes.push_back(static_cast<char>(c_constantColumn));
+		writeVarint(bytes, values.front());
+		return;
+	}
+
+	// exception bytes by the bit length of value + 1
+	std::vector<size_t> exceptionBytes(66);
+	for (auto value : values)
+	{
+		const int length{ value == ~0ULL ? 65 : getBitLength(value + 1) };
+		exceptionBytes.at(length) += getVarintSize(value);
+	}
+	int width{};
+	size_t bestSize{ ~size_t{} };
+	for (int i{}; i < 64; ++i)
+	{
+		size_t size{ (values.size() * i + 7) / 8 };
+		for (int length{ i + 1 }; length < 66; ++length)
+			size += exceptionBytes.at(length);
+		if (size < bestSize)
+		{
+			bestSize = size;
+			width = i;
+		}
+	}
+
+	bytes.push_back(static_cast<char>(width));
+	const unsigned long long escape{ (1ULL << width) - 1 };
+	unsigned long long accumulator{};
+	int accumulatedBits{};
+	for (auto value : values)
+	{
+		unsigned long long packed{ value < escape ? value : escape };
+		// at most 32 bits at a time, so the accumulator never overflows
+		for (int remainingBits{ width }; remainingBits > 0;)
+		{
+			const int bits{ std::min(remainingBits, 32) };
+			accumulator |= (packed & ((1ULL << bits) - 1)) << accumulatedBits;
+			accumulatedBits += bits;
+			packed >>= bits;
+			remainingBits -= bits;
+			for (; accumulatedBits >= 8; accumulatedBits -= 8)
+			{
+				bytes.push_back(static_cast<char>(accumulator & 0xFF));
+				accumulator >>= 8;
+			}
+		}
+	}
+	if (accumulatedBits > 0)
+		bytes.push_back(static_cast<char>(accumulator & 0xFF));
+	for (auto value : values)
+	{
+		if (value >= escape)
+			writeVarint(bytes, value);
+	}
+}
+
+static std::vector<unsigned long long> readColumn(const std::string& bytes,
+	size_t& position, const size_t valueNumber)
+{
+	const auto width{ static_cast<unsigned char>(bytes.at(position++)) };
+	if (width == c_constantColumn)
+		return std::vector<unsigned long long>(valueNumber,
+			readVarint(bytes, position));
+
+	std::vector<unsigned long long> values(valueNumber);
+	const unsigned long long escape{ (1ULL << width) - 1 };
+	unsigned long long accumulator{};
+	int accumulatedBits{};
+	for (auto& value : values)
+	{
+		for (int readBits{}; readBits < width;)
+		{
+			const int bits{ std::min(width - readBits, 32) };
+			while (accumulatedBits < bits)
+			{
+				accumulator |= static_cast<unsigned long long>(
+					static_cast<unsigned char>(bytes.at(position++)))
+					<< accumulatedBits;
+				accumulatedBits += 8;
+			}
+			value |= (accumulator & ((1ULL << bits) - 1)) << readBits;
+			accumulator >>= bits;
+			accumulatedBits -= bits;
+			readBits += bits;
+		}
+	}
+	for (auto& value : values)
+	{
+		if (value >= escape)
+			value = readVarint(bytes, position);
+	}
+	return values;
+}
+
+long long getTraceTime(const TrafficInformationEntry& entry)
+{
+	return entry.m_status == "R" ? std::llround(entry.m_receivedTime)
+		: std::llround(entry.m_sentTime);
+}
+
+CompactTraceWriter::CompactTraceWriter(const std::string& filePath,
+	const int recordsPerBlock)
+	:
+	// block offsets are recorded in the index, nothing may be dropped
+	m_traceWriter{ filePath, static_cast<size_t>(g_traceBufferSize),
+		g_traceBufferNumber, BackpressurePolicy::Block },
+	m_recordsPerBlock{ std::max(recordsPerBlock, 1) }
+{
+	std::string header{ c_headerMagic };
+	writeFixed<unsigned int>(header, m_recordsPerBlock);
+	m_traceWriter.write(header.data(), header.size());
+	m_traceWriter.endRecord();
+	m_offset = header.size();
+	m_block.reserve(m_recordsPerBlock);
+}
+
+CompactTraceWriter::~CompactTraceWriter()
+{
+	close();
+}
+
+void CompactTraceWriter::write(const TrafficInformationEntry& entry)
+{
+	m_block.push_back(entry);
+	if (static_cast<int>(m_block.size()) == m_recordsPerBlock)
+		writeBlock();
+}
+
+void CompactTraceWriter::close()
+{
+	if (m_closed)
+		return;
+	m_closed = true;
+	writeBlock();
+
+	std::string index{};
+	for (auto& block : m_blockIndex)
+	{
+		writeFixed<unsigned long long>(index, block.m_offset);
+		writeFixed<unsigned int>(index, block.m_recordNumber);
+		writeFixed<long long>(index, block.m_minTime);
+		writeFixed<long long>(index, block.m_maxTime);
+	}
+	writeFixed<unsigned long long>(index, m_offset);
+	writeFixed<unsigned int>(index,
+		static_cast<unsigned int>(m_blockIndex.size()));
+	index.append(c_footerMagic);
+	m_traceWriter.write(index.data(), index.size());
+	m_traceWriter.endRecord();
+	m_traceWriter.close();
+}
+
+void CompactTraceWriter::writeBlock()
+{
+	if (m_block.empty())
+		return;
+
+	CompactTraceBlock block{ m_offset,
+		static_cast<unsigned int>(m_block.size()),
+		getTraceTime(m_block.front()), getTraceTime(m_block.front()) };
+	for (auto& entry : m_block)
+	{
+		block.m_minTime = std::min(block.m_minTime, getTraceTime(entry));
+		block.m_maxTime = std::max(block.m_maxTime, getTraceTime(entry));
+	}
+
+	std::string bytes{};
+	writeVarint(bytes, m_block.size());
+	writeColumn(bytes, encodeStatusColumn(m_block));
+	std::map<long long, std::vector<const TrafficInformationEntry*>> groups{};
+	for (auto& entry : m_block)
+		groups[getStatus(entry)].push_back(&entry);
+	for (auto& [status, group] : groups)
+	{
+		for (int column{}; column < c_columnNumber; ++column)
+			writeColumn(bytes, encodeColumn(group, column));
+	}
+	m_traceWriter.write(bytes.data(), bytes.size());
+	m_traceWriter.endRecord();
+
+	m_offset += bytes.size();
+	m_blockIndex.push_back(block);
+	m_block.clear();
+}
+
+CompactTraceReader::CompactTraceReader(const std::string& filePath)
+{
+	m_file.open(filePath, std::ios::in | std::ios::binary);
+	if (!m_file.is_open())
+		return;
+
+	char header[12]{};
+	m_file.read(header, sizeof(header));
+	if (!m_file || std::string_view(header, 8) != c_headerMagic)
+		return;
+
+	char footer[c_footerSize]{};
+	m_file.seekg(-c_footerSize, std::ios::end);
+	m_file.read(footer, c_footerSize);
+	if (!m_file || std::string_view(footer + 12, 8) != c_footerMagic)
+		return;
+	m_indexOffset = readFixed<unsigned long long>(footer);
+	const auto blockNumber{ readFixed<unsigned int>(footer + 8) };
+
+	constexpr size_t entrySize{ 8 + 4 + 8 + 8 };
+	std::string index(blockNumber * entrySize, '\0');
+	m_file.seekg(static_cast<std::streamoff>(m_indexOffset));
+	m_file.read(index.data(), static_cast<std::streamsize>(index.size()));
+	if (!m_file)
+		return;
+	for (size_t i{}; i < blockNumber; ++i)
+	{
+		const char* entry{ index.data() + i * entrySize };
+		m_blockIndex.push_back({ readFixed<unsigned long long>(entry),
+			readFixed<unsigned int>(entry + 8),
+			readFixed<long long>(entry + 12),
+			readFixed<long long>(entry + 20) });
+	}
+	m_open = true;
+}
+
+bool CompactTraceReader::isOpen()
+{
+	return m_open;
+}
+
+long long CompactTraceReader::getRecordNumber()
+{
+	long long recordNumber{};
+	for (auto& block : m_blockIndex)
+		recordNumber += block.m_recordNumber;
+	return recordNumber;
+}
+
+std::vector<TrafficInformationEntry> CompactTraceReader::read()
+{
+	std::vector<TrafficInformationEntry> entries{};
+	for (size_t i{}; i < m_blockIndex.size(); ++i)
+		readBlock(i, entries);
+	return entries;
+}
+
+std::vector<TrafficInformationEntry> CompactTraceReader::read(
+	const long long fromTime, const long long toTime)
+{
+	std::vector<TrafficInformationEntry> entries{};
+	for (size_t i{}; i < m_blockIndex.size(); ++i)
+	{
+		if (m_blockIndex.at(i).m_maxTime < fromTime ||
+			m_blockIndex.at(i).m_minTime >= toTime)
+			continue;
+		std::vector<TrafficInformationEntry> blockEntries{};
+		readBlock(i, blockEntries);
+		for (auto& entry : blockEntries)
+		{
+			if (getTraceTime(entry) >= fromTime && getTraceTime(entry) < toTime)
+				entries.push_back(entry);
+		}
+	}
+	return entries;
+}
+
+void CompactTraceReader::readBlock(const size_t blockIndex,
+	std::vector<TrafficInformationEntry>& entries)
+{
+	const unsigned long long begin{ m_blockIndex.at(blockIndex).m_offset };
+	const unsigned long long end{ blockIndex + 1 < m_blockIndex.size()
+		? m_blockIndex.at(blockIndex + 1).m_offset : m_indexOffset };
+	std::string bytes(end - begin, '\0');
+	m_file.clear();
+	m_file.seekg(static_cast<std::streamoff>(begin));
+	m_file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+	size_t position{};
+	const size_t recordNumber{ readVarint(bytes, position) };
+	std::vector<long long> statuses{};
+	std::map<long long, size_t> groupSizes{};
+	long long status{};
+	for (auto value : readColumn(bytes, position, recordNumber))
+	{
+		status += decodeZigzag(value);
+		statuses.push_back(status);
+		groupSizes[status]++;
+	}
+
+	std::map<long long, std::vector<TrafficInformationEntry>> groups{};
+	for (auto& [groupStatus, groupSize] : groupSizes)
+	{
+		std::vector<std::vector<unsigned long long>> columns{};
+		for (int column{}; column < c_columnNumber; ++column)
+			columns.push_back(readColumn(bytes, position, groupSize));
+		decodeColumns(groupStatus, columns, groups[groupStatus]);
+	}
+
+	// interleave the groups back into record order
+	std::map<long long, size_t> groupPositions{};
+	for (auto recordStatus : statuses)
+		entries.push_back(groups[recordStatus].at(groupPositions[recordStatus]++));
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "DataStructures.h"
+#include "TraceWriter.h"
+
+// Compact packet trace (.sxt)
+//
+// Records are grouped into blocks of a fixed number of records. A block
+// stores the status of every record, then the records of each status
+// (sent and received records interleave) column by column: each value is
+// differenced against the value it most likely repeats (the previous
+// record of the group, per source for packet IDs), zigzag encoded and
+// bit packed with the narrowest width that pays off; the few values that
+// do not fit follow as varints. Sequential packet IDs, monotonic
+// timestamps and fixed packet sizes thus take a few bits each.
+// A block index at the end of the file holds the offset and the time
+// range of every block, which lets the reader seek by time.
+//
+// file   := header block* index footer
+// header := "SOXTRC01" u32(recordsPerBlock)
+// block  := varint(recordNumber) column(status) group*
+// group  := column(packetID source destination packetSize time otherTime)
+// column := u8(0xFF) varint(value) | u8(width) packed exception*
+// index  := (u64(offset) u32(recordNumber) i64(minTime) i64(maxTime))*
+// footer := u64(indexOffset) u32(blockNumber) "SOXTIDX1"
+//
+// Groups are stored in ascending status order. The time of a record is
+// its received time if it was received, otherwise its sent time;
+// otherTime is the latency of a received record and the received time
+// of any other record.
+
+struct CompactTraceBlock
+{
+	unsigned long long m_offset{};
+	unsigned int m_recordNumber{};
+	long long m_minTime{}, m_maxTime{};
+};
+
+class CompactTraceWriter
+{
+public:
+	CompactTraceWriter(const std::string& filePath,
+		const int recordsPerBlock = 4096);
+	~CompactTraceWriter();
+
+	void write(const TrafficInformationEntry& entry);
+	void close();
+
+private:
+	void writeBlock();
+
+private:
+	TraceWriter m_traceWriter;
+	int m_recordsPerBlock{};
+	std::vector<TrafficInformationEntry> m_block{};
+	std::vector<CompactTraceBlock> m_blockIndex{};
+	unsigned long long m_offset{};
+	bool m_closed{};
+};
+
+class CompactTraceReader
+{
+public:
+	CompactTraceReader(const std::string& filePath);
+
+	bool isOpen();
+	long long getRecordNumber();
+	std::vector<TrafficInformationEntry> read(); // whole trace
+	// records with fromTime <= time < toTime, reading only the blocks
+	// whose time range overlaps
+	std::vector<TrafficInformationEntry> read(const long long fromTime,
+		const long long toTime);
+
+private:
+	void readBlock(const size_t blockIndex,
+		std::vector<TrafficInformationEntry>& entries);
+
+private:
+	std::ifstream m_file{};
+	std::vector<CompactTraceBlock> m_blockIndex{};
+	unsigned long long m_indexOffset{};
+	bool m_open{};
+};
+
+long long getTraceTime(const TrafficInformationEntry& entry);
@@ -1,4 +1,5 @@
 #include "DataStructures.h"
+#include <algorithm>
 
 // overloading << for std::vector
 template <typename T> std::ostream& operator<<(
@@ -11,17 +12,6 @@ template <typename T> std::ostream& operator<<(
 	return stream;
 }
 
-// overloading << for std::deque
-template <typename T> std::ostream& operator<<(
-	std::ostream& stream, const std::deque<T>& deque)
-{
-	for (auto element : deque)
-	{
-		stream << element << " ";
-	}
-	return stream;
-}
-
 std::ostream& operator<<(std::ostream& stream, const FlitType& flitType)
 {
 	switch (flitType)
@@ -40,10 +30,11 @@ std::ostream& operator<<(std::ostream& stream, const FlitType& flitType)
 }
 
 Flit::Flit(const int source,
-	const std::deque<int>& route)
+	const std::span<const int> route)
 	:
 	m_source{ source },
-	m_route{ route }
+	m_route{ route.empty() ? nullptr : route.data() },
+	m_destination{ route.empty() ? -1 : route.back() }
 {
 	m_flitType = FlitType::H;
 }
@@ -74,8 +65,11 @@ std::ostream& operator<<(std::ostream& stream, const Flit& flit)
 {
 	stream << flit.m_flitType << "|"
 		<< flit.m_flitVirtualChannel << "|"
-		<< flit.m_source << "|"
-		<< flit.m_route << "|"
+		<< flit.m_source << "|";
+	// the rest of the route, up to the destination terminal interface
+	for (const int* hop{ flit.m_route }; hop; hop = *hop < 0 ? nullptr : hop + 1)
+		stream << *hop << " ";
+	stream << "|"
 		<< flit.m_flitData << "|"
 		<< flit.m_flitNumberB << "|"
 		<< flit.m_packetID;
@@ -238,11 +232,11 @@ Coordinate Coordinate::decrementZ(const int zLimit)
 	return { m_x, m_y, m_z };
 }
 
-TrafficData::TrafficData(const float receivedPacketNumber,
-	const float receivedFlitNumber,
-	const float sentFlitNumber,
-	const float sentPacketNumber,
-	const float accumulatedLatency)
+TrafficData::TrafficData(const long long receivedPacketNumber,
+	const long long receivedFlitNumber,
+	const long long sentFlitNumber,
+	const long long sentPacketNumber,
+	const double accumulatedLatency)
 	:
 	m_receivedPacketNumber{ receivedPacketNumber },
 	m_receivedFlitNumber{ receivedFlitNumber },
@@ -251,6 +245,55 @@ TrafficData::TrafficData(const float receivedPacketNumber,
 	m_accumulatedLatency{ accumulatedLatency } {
 }
 
+void TrafficData::addLatencyBreakdown(const TrafficInformationEntry& entry)
+{
+	// the parts add up to receivedTime - sentTime - 1
+	m_accumulatedQueueingLatency += entry.m_networkEntryTime - entry.m_sentTime;
+	m_accumulatedNetworkLatency +=
+		entry.m_headArrivalTime - entry.m_networkEntryTime - 1;
+	m_accumulatedSerialisationLatency +=
+		entry.m_receivedTime - entry.m_headArrivalTime;
+}
+
+std::ostream& operator<<(std::ostream& stream,
+	const Performance& performance)
+{
+	stream << "************** Network performance **************\n"
+		<< "Throughput: " << performance.m_throughput << " flit/cycle/node\n"
+		<< "Demand: " << performance.m_demand << " flit/cycle/node\n"
+		<< "Average latency: " << performance.m_latency << " cycles\n"
+		<< "  Source queueing: " << performance.m_queueingLatency << " cycles\n"
+		<< "  Network (head): " << performance.m_networkLatency << " cycles\n"
+		<< "  Serialisation: " << performance.m_serialisationLatency << " cycles\n";
+	return stream;
+}
+
+void WindowStatistics::addSentPacket(const double sentTime,
+	const int packetSize)
+{
+	TrafficData& window{ getWindow(sentTime) };
+	window.m_sentPacketNumber++;
+	window.m_sentFlitNumber += packetSize;
+}
+
+void WindowStatistics::addReceivedPacket(const double sentTime,
+	const double receivedTime, const int packetSize)
+{
+	TrafficData& window{ getWindow(receivedTime) };
+	window.m_receivedPacketNumber++;
+	window.m_receivedFlitNumber += packetSize;
+	getWindow(sentTime).m_accumulatedLatency += receivedTime - sentTime - 1;
+}
+
+TrafficData& WindowStatistics::getWindow(const double time)
+{
+	const size_t index{ static_cast<size_t>(std::max(time, 0.0))
+		/ static_cast<size_t>(std::max(g_statisticsWindow, 1)) };
+	if (index >= m_windows.size())
+		m_windows.resize(index + 1);
+	return m_windows.at(index);
+}
+
 Benchmark::Benchmark()
 {
 	start = std::chrono::high_resolution_clock::now();
@@ -269,8 +312,8 @@ TrafficInformationEntry::TrafficInformationEntry(const int packetID,
 	const int destination,
 	const int packetSize,
 	const std::string status,
-	const float sentTime,
-	const float receivedTime)
+	const double sentTime,
+	const double receivedTime)
 	:
 	m_packetID{ packetID },
 	m_source{ source },
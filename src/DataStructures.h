@@ -2,6 +2,7 @@
 #include <iostream>
 #include <vector>
 #include <deque>
+#include <span>
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -23,7 +24,7 @@ std::ostream& operator<<(std::ostream& stream,
 struct Flit
 {
 	Flit(const int source,
-		const std::deque<int>& route);
+		const std::span<const int> route);
 	Flit(const std::vector<float>& flitData,
 		const int flitNumberB);
 	Flit(const int packetID);
@@ -32,10 +33,19 @@ struct Flit
 	FlitType m_flitType{};
 	int m_flitVirtualChannel{ -1 };
 	int m_source{ -1 };
-	std::deque<int> m_route{};
+	// head only; source routing: the next hop of a route that the source
+	// terminal interface or route table owns, null in distributed routing
+	const int* m_route{};
+	int m_destination{ -1 }; // head only; destination terminal interface ID
+	int m_routingPhase{}; // head only; per-packet state of distributed routing
+	int m_intermediate{ -1 }; // head only; router ID VAL and ROMM pass first
 	std::vector<float> m_flitData{ std::vector<float>(g_flitSize) };
 	int m_flitNumberB{ -1 };
 	int m_packetID{ -1 };
+	double m_sentTime{}; // head only; time the packet entered the source queue
+	double m_networkEntryTime{}; // head only; time the head left the source queue
+	double m_headArrivalTime{}; // head only; time the head reached the destination
+	int m_traceID{ -1 }; // sampled packets only; the packet in the flit trace
 };
 
 std::ostream& operator<<(std::ostream& stream, const Flit& flit);
@@ -50,6 +60,9 @@ struct Packet
 
 	int m_packetID{}, m_source{}, m_destination{};
 	std::vector<float> m_data{};
+	double m_sentTime{};
+	double m_networkEntryTime{};
+	double m_headArrivalTime{};
 };
 
 std::ostream& operator<<(std::ostream& stream,
@@ -87,6 +100,7 @@ struct ControlField
 	VirtualChannelState m_virtualChannelState{
 		VirtualChannelState::I };
 	int m_routedOutputPort{ -1 }; // initial value is the router ID that it resides in
+	int m_escapeOutputPort{ -1 }; // DOR output port if the adaptive VCs are taken
 	int m_allocatedVirtualChannel{ -1 };
 
 	// output
@@ -172,20 +186,58 @@ struct Coordinate
 //	Fixed
 //};
 
+struct TrafficInformationEntry;
+
 struct TrafficData
 {
 	TrafficData() = default;
-	TrafficData(const float receivedPacketNumber,
-		const float receivedFlitNumber,
-		const float sentFlitNumber,
-		const float sentPacketNumber,
-		const float accumulatedLatency);
+	TrafficData(const long long receivedPacketNumber,
+		const long long receivedFlitNumber,
+		const long long sentFlitNumber,
+		const long long sentPacketNumber,
+		const double accumulatedLatency);
 
-	float m_receivedPacketNumber{},
+	// counts and sums stay exact over runs of many more than 2^24 cycles
+	long long m_receivedPacketNumber{},
 		m_receivedFlitNumber{},
 		m_sentPacketNumber{},
-		m_sentFlitNumber{},
-		m_accumulatedLatency{};
+		m_sentFlitNumber{};
+	double m_accumulatedLatency{};
+	// the accumulated latency split into its parts, see addLatencyBreakdown
+	double m_accumulatedQueueingLatency{},
+		m_accumulatedNetworkLatency{},
+		m_accumulatedSerialisationLatency{};
+
+	void addLatencyBreakdown(const TrafficInformationEntry& entry);
+};
+
+// network performance over the measurement window
+struct Performance
+{
+	float m_throughput{}; // flit/cycle/node
+	float m_demand{}; // flit/cycle/node
+	float m_latency{}; // cycles
+	// parts of the latency: waiting in the source queue, the head crossing
+	// the network, and the rest of the packet following the head
+	float m_queueingLatency{}; // cycles
+	float m_networkLatency{}; // cycles
+	float m_serialisationLatency{}; // cycles
+};
+
+std::ostream& operator<<(std::ostream& stream,
+	const Performance& performance);
+
+// traffic data per window of g_statisticsWindow cycles over the whole run;
+// a packet is counted in the windows it was sent and received in, and its
+// latency in the window it was sent in, the same as for the measurement
+struct WindowStatistics
+{
+	void addSentPacket(const double sentTime, const int packetSize);
+	void addReceivedPacket(const double sentTime, const double receivedTime,
+		const int packetSize);
+	TrafficData& getWindow(const double time);
+
+	std::vector<TrafficData> m_windows{};
 };
 
 struct Benchmark
@@ -206,14 +258,16 @@ struct TrafficInformationEntry
 		const int destination,
 		const int packetSize,
 		const std::string status,
-		const float sentTime,
-		const float receivedTime);
+		const double sentTime,
+		const double receivedTime);
 
 	int m_packetID{};
 	int m_source{};
 	int m_destination{};
 	int m_packetSize{};
 	std::string m_status{ "V"};
-	float m_sentTime{};
-	float m_receivedTime{};
+	double m_sentTime{};
+	double m_receivedTime{};
+	double m_networkEntryTime{}; // received packets only
+	double m_headArrivalTime{}; // received packets only
 };
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "FlitTracer.h"
+#include <bit>
+#include <cstring>
+#include "Clock.h"
+
+static constexpr char c_flitTraceMagic[]{ "SOXFLT01" };
+
+const char* getFlitTraceEventName(const FlitTraceEvent event)
+{
+	switch (event)
+	{
+	case FlitTraceEvent::INJECT:
+		return "inject";
+	case FlitTraceEvent::SEND:
+		return "send";
+	case FlitTraceEvent::ARRIVE:
+		return "arrive";
+	case FlitTraceEvent::ROUTE:
+		return "route";
+	case FlitTraceEvent::VA_GRANT:
+		return "va_grant";
+	case FlitTraceEvent::SA_GRANT:
+		return "sa_grant";
+	case FlitTraceEvent::DEPART:
+		return "depart";
+	case FlitTraceEvent::EJECT:
+		return "eject";
+	}
+	return "unknown";
+}
+
+FlitTracer::FlitTracer(const std::string& filePath, const size_t ringSize)
+	:
+	m_ring(std::bit_ceil(std::max<size_t>(ringSize, 2))),
+	m_mask{ m_ring.size() - 1 }
+{
+	m_file.open(filePath, std::ios::out | std::ios::binary);
+	if (!m_file.is_open())
+	{
+		std::cerr << "Error: Could not open flit trace: " << filePath << "\n";
+		return;
+	}
+	const unsigned int recordSize{ sizeof(FlitTraceRecord) };
+	m_file.write(c_flitTraceMagic, 8);
+	m_file.write(reinterpret_cast<const char*>(&recordSize), sizeof(recordSize));
+	m_spillThread = std::thread{ &FlitTracer::runSpillThread, this };
+}
+
+FlitTracer::~FlitTracer()
+{
+	close();
+	if (s_active == this)
+		s_active = nullptr;
+}
+
+bool FlitTracer::isOpen() const
+{
+	return m_file.is_open();
+}
+
+void FlitTracer::close()
+{
+	if (!m_spillThread.joinable())
+		return;
+	m_closing.store(true, std::memory_order_release);
+	m_spillThread.join();
+	spill(); // anything recorded after the last spill
+	m_file.close();
+	if (m_droppedRecordNumber)
+		std::cerr << "Warning: " << m_droppedRecordNumber
+		<< " flit trace records dropped, the spill thread fell behind\n";
+}
+
+long long FlitTracer::getRecordNumber() const
+{
+	return static_cast<long long>(m_head.load(std::memory_order_relaxed));
+}
+
+long long FlitTracer::getDroppedRecordNumber() const
+{
+	return m_droppedRecordNumber;
+}
+
+void FlitTracer::setActive(FlitTracer* tracer)
+{
+	s_active = tracer && tracer->isOpen() ? tracer : nullptr;
+}
+
+void FlitTracer::tagPacket(std::deque<Flit>::iterator head,
+	std::deque<Flit>::iterator end, const int packetID)
+{
+	if (!s_active || head == end || !isSampled(*head, packetID))
+		return;
+	const int traceID{ static_cast<int>(s_active->m_packets.size()) };
+	s_active->m_packets.push_back({ head->m_source, packetID });
+	for (auto flit{ head }; flit != end; ++flit)
+		flit->m_traceID = traceID;
+	s_active->record(*head, FlitTraceEvent::INJECT, head->m_source,
+		head->m_destination, -1);
+}
+
+bool FlitTracer::isSampled(const Flit& head, const int packetID)
+{
+	if (g_flitTraceSource >= 0 && -head.m_source - 1 != g_flitTraceSource)
+		return false;
+	if (g_flitTraceDestination >= 0 && -head.m_destination - 1 != g_flitTraceDestination)
+		return false;
+	return g_flitTraceSample > 0 && packetID % g_flitTraceSample == 0;
+}
+
+void FlitTracer::record(const Flit& flit, const FlitTraceEvent event,
+	const int node, const int port, const int virtualChannel)
+{
+	const TracedPacket& packet{ m_packets.at(flit.m_traceID) };
+	FlitTraceRecord record{};
+	record.m_cycle = static_cast<int>(Clock{}.get());
+	record.m_traceID = flit.m_traceID;
+	record.m_source = packet.m_source;
+	record.m_packetID = packet.m_packetID;
+	record.m_node = node;
+	record.m_port = port;
+	record.m_flitNumber = flit.m_flitNumberB;
+	record.m_virtualChannel = static_cast<short>(virtualChannel);
+	record.m_flitType = flit.m_flitType == FlitType::H ? 'H'
+		: flit.m_flitType == FlitType::B ? 'B' : 'T';
+	record.m_event = event;
+	push(record);
+}
+
+void FlitTracer::push(const FlitTraceRecord& record)
+{
+	const size_t head{ m_head.load(std::memory_order_relaxed) };
+	if (head - m_tail.load(std::memory_order_acquire) > m_mask)
+	{
+		++m_droppedRecordNumber; // full; never wait for the disk
+		return;
+	}
+	m_ring[head & m_mask] = record;
+	m_head.store(head + 1, std::memory_order_release);
+}
+
+void FlitTracer::runSpillThread()
+{
+	while (!m_closing.load(std::memory_order_acquire))
+	{
+		spill();
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+	}
+}
+
+void FlitTracer::spill()
+{
+	const size_t tail{ m_tail.load(std::memory_order_relaxed) };
+	const size_t head{ m_head.load(std::memory_order_acquire) };
+	if (head == tail)
+		return;
+	// the ring wraps at most once between tail and head
+	const size_t first{ tail & m_mask };
+	const size_t firstNumber{ std::min(head - tail, m_ring.size() - first) };
+	m_file.write(reinterpret_cast<const char*>(&m_ring[first]),
+		firstNumber * sizeof(FlitTraceRecord));
+	m_file.write(reinterpret_cast<const char*>(m_ring.data()),
+		(head - tail - firstNumber) * sizeof(FlitTraceRecord));
+	m_tail.store(head, std::memory_order_release);
+}
+
+std::vector<FlitTraceRecord> readFlitTrace(const std::string& filePath)
+{
+	std::ifstream file{ filePath, std::ios::in | std::ios::binary };
+	char magic[8]{};
+	unsigned int recordSize{};
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&recordSize), sizeof(recordSize));
+	if (!file || std::memcmp(magic, c_flitTraceMagic, sizeof(magic))
+		|| recordSize != sizeof(FlitTraceRecord))
+		return {};
+
+	std::vector<FlitTraceRecord> records{};
+	FlitTraceRecord record{};
+	while (file.read(reinterpret_cast<char*>(&record), sizeof(record)))
+		records.push_back(record);
+	return records;
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include "DataStructures.h"
+
+// Flit trace (.sft)
+//
+// Sampled packets are tagged when they enter their source queue; every
+// flit of a tagged packet carries its trace ID, and the routers and
+// terminal interfaces record its per-hop events. Records go into a
+// fixed-size single-producer single-consumer ring, which a spill thread
+// empties into the trace file; when the ring is full, records are dropped
+// and counted, so tracing never stalls the simulation.
+//
+// file   := header record*
+// header := "SOXFLT01" u32(recordSize)
+// record := FlitTraceRecord, native byte order
+
+enum class FlitTraceEvent : unsigned char
+{
+	INJECT, // the packet entered its source queue; node is the source, port the destination
+	SEND, // the flit left the source queue
+	ARRIVE, // the flit entered an input VC of a router
+	ROUTE, // the head was routed; port is the output port
+	VA_GRANT, // the head was granted a downstream VC of the output port
+	SA_GRANT, // the flit won the switch toward the output port
+	DEPART, // the flit crossed the switch into the output register
+	EJECT // the flit reached its destination terminal interface
+};
+
+struct FlitTraceRecord
+{
+	int m_cycle{};
+	int m_traceID{}; // tagged packets are numbered from 0 in the order they are tagged
+	int m_source{}; // terminal interface ID, with the packet ID as in TrafficInformation
+	int m_packetID{};
+	int m_node{}; // router ID, or terminal interface ID for INJECT, SEND and EJECT
+	int m_port{}; // port ID the event concerns
+	int m_flitNumber{ -1 }; // body flits only; the offset of their data in the packet
+	short m_virtualChannel{ -1 };
+	char m_flitType{}; // H, B or T
+	FlitTraceEvent m_event{};
+};
+
+static_assert(sizeof(FlitTraceRecord) == 32);
+
+const char* getFlitTraceEventName(const FlitTraceEvent event);
+
+// tracer of the simulation on this thread; one is active per thread at most
+class FlitTracer
+{
+public:
+	// ringSize records, rounded up to a power of two
+	FlitTracer(const std::string& filePath, const size_t ringSize);
+	~FlitTracer();
+	FlitTracer(const FlitTracer&) = delete;
+	FlitTracer& operator=(const FlitTracer&) = delete;
+
+	bool isOpen() const;
+	void close(); // spill the ring and join the spill thread
+	long long getRecordNumber() const;
+	long long getDroppedRecordNumber() const;
+
+	// the tracer the tag and trace calls of this thread record into
+	static void setActive(FlitTracer* tracer);
+	// tag the flits of a new packet if it is sampled: every
+	// g_flitTraceSample-th packet of a source, and every packet matching
+	// the source and destination filters
+	static void tagPacket(std::deque<Flit>::iterator head,
+		std::deque<Flit>::iterator end, const int packetID);
+	static void trace(const Flit& flit, const FlitTraceEvent event,
+		const int node, const int port, const int virtualChannel)
+	{
+		if (flit.m_traceID >= 0 && s_active)
+			s_active->record(flit, event, node, port, virtualChannel);
+	}
+
+private:
+	static bool isSampled(const Flit& head, const int packetID);
+	void record(const Flit& flit, const FlitTraceEvent event,
+		const int node, const int port, const int virtualChannel);
+	void push(const FlitTraceRecord& record);
+	void runSpillThread();
+	void spill();
+
+private:
+	struct TracedPacket
+	{
+		int m_source{}, m_packetID{};
+	};
+
+	std::ofstream m_file{};
+	std::vector<FlitTraceRecord> m_ring{};
+	size_t m_mask{};
+	std::atomic<size_t> m_head{}; // next record to write; the producer's
+	std::atomic<size_t> m_tail{}; // next record to spill; the spill thread's
+	std::atomic<bool> m_closing{};
+	long long m_droppedRecordNumber{};
+	std::vector<TracedPacket> m_packets{}; // per trace ID
+	std::thread m_spillThread{};
+
+	static inline thread_local FlitTracer* s_active{};
+};
+
+// read a flit trace back; empty if the file is not a flit trace
+std::vector<FlitTraceRecord> readFlitTrace(const std::string& filePath);
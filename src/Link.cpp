@@ -28,6 +28,7 @@ Link::Link(Router* leftRouter,
 
 void Link::runOneCycle()
 {
+	updateEnable();
 	if (m_leftPort->m_outputRegister.m_flitEnable)
 		m_rightPort->m_inputRegister.pushbackFlit(
 			m_leftPort->m_outputRegister.popfrontFlit());
@@ -42,22 +43,16 @@ void Link::runOneCycle()
 			m_rightPort->m_outputRegister.popfrontCredit());
 }
 
+// the links run first in a cycle, so what the registers hold now is what
+// the cycle starts with; this covers the input registers of the routers and
+// terminal interfaces as well, which only a link pushes into
 void Link::updateEnable()
 {
-	if (m_leftPort->m_outputRegister.isFlitRegisterEmpty())
-		m_leftPort->m_outputRegister.m_flitEnable = false;
-	else
-		m_leftPort->m_outputRegister.m_flitEnable = true;
-	if (m_leftPort->m_outputRegister.isCreditRegisterEmpty())
-		m_leftPort->m_outputRegister.m_creditEnable = false;
-	else
-		m_leftPort->m_outputRegister.m_creditEnable = true;
-	if (m_rightPort->m_outputRegister.isFlitRegisterEmpty())
-		m_rightPort->m_outputRegister.m_flitEnable = false;
-	else
-		m_rightPort->m_outputRegister.m_flitEnable = true;
-	if (m_rightPort->m_outputRegister.isCreditRegisterEmpty())
-		m_rightPort->m_outputRegister.m_creditEnable = false;
-	else
-		m_rightPort->m_outputRegister.m_creditEnable = true;
+	for (Port* port : { m_leftPort, m_rightPort })
+	{
+		port->m_outputRegister.m_flitEnable = !port->m_outputRegister.isFlitRegisterEmpty();
+		port->m_outputRegister.m_creditEnable = !port->m_outputRegister.isCreditRegisterEmpty();
+		port->m_inputRegister.m_flitEnable = !port->m_inputRegister.isFlitRegisterEmpty();
+		port->m_inputRegister.m_creditEnable = !port->m_inputRegister.isCreditRegisterEmpty();
+	}
 }
\ No newline at end of file
@@ -9,8 +9,8 @@ public:
 	Link(Router* leftRouter,
 		TerminalInterface* rightTerminalInterface);
 
-	void runOneCycle();
-	void updateEnable();
+	void runOneCycle(); // latches the enables of both ports, then moves
+	void updateEnable(); // of the input and output registers of both ports
 
 private:
 
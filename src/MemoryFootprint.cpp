@@ -0,0 +1,159 @@
+#include "MemoryFootprint.h"
+#include <bit>
+#include <iomanip>
+#include "Simulation.h"
+
+static const char* c_memorySubsystemNames[]{
+	"virtual channels",
+	"registers",
+	"routing tables",
+	"traffic buffers",
+	"reorder buffers",
+	"source queues"
+};
+
+constexpr double c_bytesPerMiB{ 1024.0 * 1024.0 };
+
+size_t getHeapBytes(const Flit& flit)
+{
+	return getHeapBytes(flit.m_flitData);
+}
+
+size_t getHeapBytes(const std::deque<Flit>& flits)
+{
+	size_t bytes{ getHeapBytes<Flit>(flits) };
+	for (auto& flit : flits)
+		bytes += getHeapBytes(flit);
+	return bytes;
+}
+
+size_t getHeapBytes(const std::vector<Flit>& flits)
+{
+	size_t bytes{ getHeapBytes<Flit>(flits) };
+	for (auto& flit : flits)
+		bytes += getHeapBytes(flit);
+	return bytes;
+}
+
+size_t& MemoryFootprint::operator[](const MemorySubsystem subsystem)
+{
+	return m_bytes.at(static_cast<size_t>(subsystem));
+}
+
+size_t MemoryFootprint::getTotal() const
+{
+	size_t total{};
+	for (auto& bytes : m_bytes)
+		total += bytes;
+	return total;
+}
+
+void MemoryFootprint::addPort(const Port& port)
+{
+	size_t& virtualChannels{ (*this)[MemorySubsystem::VIRTUAL_CHANNELS] };
+	virtualChannels += getHeapBytes(port.m_virtualChannels)
+		+ getHeapBytes(port.m_controlFields);
+	for (auto& virtualChannel : port.m_virtualChannels)
+		virtualChannels += getHeapBytes(virtualChannel);
+	(*this)[MemorySubsystem::REGISTERS] += port.m_inputRegister.getHeapBytes()
+		+ port.m_outputRegister.getHeapBytes();
+}
+
+MemoryAccount::MemoryAccount(const int nodeNumber)
+	:
+	m_nodeNumber{ nodeNumber }
+{
+}
+
+void MemoryAccount::sample(const std::string& phase,
+	const MemoryFootprint& footprint, std::ostream* stream)
+{
+	m_last = footprint;
+	for (size_t i{}; i < m_peak.m_bytes.size(); ++i)
+		m_peak.m_bytes.at(i) = std::max(m_peak.m_bytes.at(i), footprint.m_bytes.at(i));
+	m_peakTotal = std::max(m_peakTotal, footprint.getTotal());
+	if (stream)
+		*stream << "Memory after " << phase << ": " << std::fixed
+			<< std::setprecision(2) << footprint.getTotal() / c_bytesPerMiB
+			<< " MiB\n" << std::defaultfloat << std::setprecision(6);
+}
+
+void MemoryAccount::report(std::ostream& stream) const
+{
+	const double nodes{ static_cast<double>(std::max(m_nodeNumber, 1)) };
+	stream << "************** Memory footprint **************\n"
+		<< std::left << std::setw(20) << "subsystem" << std::right
+		<< std::setw(12) << "exit MiB" << std::setw(12) << "peak MiB"
+		<< std::setw(16) << "peak KiB/node" << "\n" << std::fixed;
+	for (size_t i{}; i < m_peak.m_bytes.size(); ++i)
+	{
+		stream << std::left << std::setw(20) << c_memorySubsystemNames[i] << std::right
+			<< std::setprecision(2) << std::setw(12) << m_last.m_bytes.at(i) / c_bytesPerMiB
+			<< std::setw(12) << m_peak.m_bytes.at(i) / c_bytesPerMiB
+			<< std::setprecision(1) << std::setw(16)
+			<< m_peak.m_bytes.at(i) / 1024.0 / nodes << "\n";
+	}
+	stream << std::left << std::setw(20) << "total" << std::right
+		<< std::setprecision(2) << std::setw(12) << m_last.getTotal() / c_bytesPerMiB
+		<< std::setw(12) << m_peakTotal / c_bytesPerMiB
+		<< std::setprecision(1) << std::setw(16) << m_peakTotal / 1024.0 / nodes
+		<< "\n" << std::defaultfloat << std::setprecision(6);
+}
+
+size_t MemoryAccount::getPeak() const
+{
+	return m_peakTotal;
+}
+
+MemoryFootprint estimateMemoryFootprint(const SimulationConfiguration& configuration)
+{
+	const size_t nodes{ static_cast<size_t>(configuration.m_x)
+		* configuration.m_y * configuration.m_z };
+	size_t ports{ 1 }; // the terminal port
+	for (int side : { configuration.m_x, configuration.m_y, configuration.m_z })
+		ports += side > 1 ? 2 : 0;
+	// the packed input VC states of a router, a byte and a bit per VC
+	const size_t packedStates{ (ports * configuration.m_virtualChannelNumber + 63) / 64
+		* (64 + sizeof(unsigned long long)) };
+	ports = nodes * (ports + 1); // and the port of the terminal interface
+
+	// every flit carries its data; a head points into its route
+	const size_t flitBytes{ sizeof(Flit) + configuration.m_flitSize * sizeof(float) };
+	const size_t packetFlits{ static_cast<size_t>(configuration.m_packetSize)
+		/ std::max(configuration.m_flitSize, 1) + 2 };
+	const size_t virtualChannels{ static_cast<size_t>(configuration.m_virtualChannelNumber) };
+
+	MemoryFootprint footprint{};
+	footprint[MemorySubsystem::VIRTUAL_CHANNELS] = ports * (sizeof(Port)
+		+ virtualChannels * (getHeapBytes(std::deque<Flit>{}) + sizeof(ControlField)
+			+ configuration.m_bufferSize * flitBytes)) + nodes * packedStates;
+	footprint[MemorySubsystem::REGISTERS] = ports * 2
+		* (getHeapBytes(std::deque<Flit>{}) + getHeapBytes(std::deque<Credit>{}) + flitBytes);
+	if (configuration.m_routingMode == "source"
+		&& configuration.m_routeCacheDirectory.empty())
+	{
+		// a route grows by push_back to the longest one of a mesh at most
+		const size_t hops{ static_cast<size_t>(configuration.m_x + configuration.m_y
+			+ configuration.m_z - 2) };
+		footprint[MemorySubsystem::ROUTING_TABLES] = nodes
+			* (std::bit_ceil(nodes) * sizeof(std::vector<int>)
+				+ nodes * std::bit_ceil(hops) * sizeof(int));
+	}
+
+	const size_t packets{ configuration.m_injectionProcess == "trace" ? 0
+		: nodes * static_cast<size_t>(configuration.m_totalCycles * configuration.m_injectionRate) };
+	const size_t packetBytes{ sizeof(TrafficInformationEntry) + sizeof(std::vector<float>)
+		+ configuration.m_packetSize * sizeof(float) };
+	const bool retained{ configuration.m_ejectionSink == "buffer" };
+	// with a sink packets are drawn when due
+	if (retained)
+		footprint[MemorySubsystem::TRAFFIC_BUFFERS] = packets * packetBytes * 2;
+	footprint[MemorySubsystem::REORDER_BUFFERS] = nodes * virtualChannels
+		* packetFlits * flitBytes;
+	size_t queuedFlits{ packets * packetFlits };
+	if (configuration.m_sourceQueueCapacity > 0) // takes a packet while below its capacity
+		queuedFlits = std::min(queuedFlits, nodes
+			* (configuration.m_sourceQueueCapacity + packetFlits - 1));
+	footprint[MemorySubsystem::SOURCE_QUEUES] = queuedFlits * flitBytes;
+	return footprint;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <array>
+#include <ostream>
+#include "Port.h"
+
+struct SimulationConfiguration;
+
+// the structures the simulator holds per node, accounted separately
+enum class MemorySubsystem
+{
+	VIRTUAL_CHANNELS, // router and terminal VC buffers, control fields and packed states
+	REGISTERS,        // port input and output registers
+	ROUTING_TABLES,   // source routing tables of the terminal interfaces
+	TRAFFIC_BUFFERS,  // generated and received traffic information and data
+	REORDER_BUFFERS,  // flits of packets the terminal interfaces reassemble
+	SOURCE_QUEUES,    // flits waiting for injection
+	COUNT
+};
+
+// heap bytes of a container, estimated from its size or capacity; a
+// libstdc++ deque holds its elements in 512-byte nodes and allocates one
+// node and a map of 8 pointers even when empty
+template <typename T>
+size_t getHeapBytes(const std::vector<T>& vector)
+{
+	return vector.capacity() * sizeof(T);
+}
+
+template <typename T>
+size_t getHeapBytes(const std::deque<T>& deque)
+{
+	const size_t nodeSize{ sizeof(T) < 512 ? 512 / sizeof(T) : 1 };
+	const size_t nodes{ deque.size() / nodeSize + 1 };
+	return nodes * nodeSize * sizeof(T) + std::max<size_t>(8, nodes + 2) * sizeof(T*);
+}
+
+size_t getHeapBytes(const Flit& flit); // its data
+size_t getHeapBytes(const std::deque<Flit>& flits);
+size_t getHeapBytes(const std::vector<Flit>& flits);
+
+// bytes held per subsystem at one moment
+struct MemoryFootprint
+{
+	size_t& operator[](const MemorySubsystem subsystem);
+	size_t getTotal() const;
+	void addPort(const Port& port); // its VCs, control fields and registers
+
+	std::array<size_t, static_cast<size_t>(MemorySubsystem::COUNT)> m_bytes{};
+};
+
+// footprints sampled at the phase boundaries of a run; each sample is
+// printed as it is taken, and the report gives the peak per subsystem and
+// its average per node
+class MemoryAccount
+{
+public:
+	MemoryAccount(const int nodeNumber);
+
+	void sample(const std::string& phase, const MemoryFootprint& footprint,
+		std::ostream* stream);
+	void report(std::ostream& stream) const;
+	size_t getPeak() const; // the largest total of all samples
+
+private:
+	int m_nodeNumber{};
+	MemoryFootprint m_last{};
+	MemoryFootprint m_peak{}; // per subsystem
+	size_t m_peakTotal{};
+};
+
+// bytes a run of the configuration holds at most, before it is started;
+// the source queues are taken as full, every packet of the run queued at
+// once as in a network saturated from the first cycle, or up to their
+// capacity if bounded
+MemoryFootprint estimateMemoryFootprint(const SimulationConfiguration& configuration);
@@ -0,0 +1,246 @@
+#include "NumpyWriter.h"
+#include <array>
+#include <cstring>
+
+template <typename T>
+static void writeLittleEndian(std::string& bytes, const T value)
+{
+	for (size_t i{}; i < sizeof(T); ++i)
+		bytes.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+static std::string makeHeader(const std::string& descr,
+	const std::string& shape)
+{
+	auto makeDictionary{ [&descr](const std::string& shape) {
+		return "{'descr': " + descr + ", 'fortran_order': False, 'shape': "
+			+ shape + ", }"; } };
+	// the widest shape a record number can give decides the length
+	const size_t widest{ makeDictionary("(18446744073709551615,)").size() };
+	const size_t length{ (10 + widest + 1 + 63) / 64 * 64 };
+
+	std::string dictionary{ makeDictionary(shape) };
+	dictionary.resize(length - 10 - 1, ' ');
+	dictionary.push_back('\n');
+
+	std::string header{ "\x93NUMPY\x01\x00", 8 };
+	writeLittleEndian(header, static_cast<unsigned short>(dictionary.size()));
+	return header + dictionary;
+}
+
+std::string makeNpyHeader(const std::vector<NpyField>& fields,
+	const unsigned long long recordNumber)
+{
+	std::string descr{ "[" };
+	for (auto& field : fields)
+		descr += "('" + field.m_name + "', '" + field.m_type + "'), ";
+	descr += "]";
+	return makeHeader(descr, "(" + std::to_string(recordNumber) + ",)");
+}
+
+std::string makeNpyHeader(const std::string_view type,
+	const unsigned long long recordNumber)
+{
+	return makeHeader("'" + std::string{ type } + "'",
+		"(" + std::to_string(recordNumber) + ",)");
+}
+
+static void appendFloat64(std::string& bytes, const double value)
+{
+	unsigned long long bits{};
+	std::memcpy(&bits, &value, sizeof(bits));
+	writeLittleEndian(bytes, bits);
+}
+
+std::string makeNpyArray(const std::vector<double>& values)
+{
+	std::string file{ makeNpyHeader("<f8", values.size()) };
+	for (auto value : values)
+		appendFloat64(file, value);
+	return file;
+}
+
+std::string makeNpyScalar(const double value)
+{
+	std::string file{ makeHeader("'<f8'", "()") };
+	appendFloat64(file, value);
+	return file;
+}
+
+void appendNpyValue(std::string& record, const int value)
+{
+	writeLittleEndian(record, static_cast<unsigned int>(value));
+}
+
+void appendNpyValue(std::string& record, const double value)
+{
+	appendFloat64(record, value);
+}
+
+void appendNpyValue(std::string& record, const char value)
+{
+	record.push_back(value);
+}
+
+NpyWriter::NpyWriter(const std::string& filePath,
+	const std::vector<NpyField>& fields)
+	:
+	m_filePath{ filePath },
+	m_fields{ fields },
+	m_traceWriter{ filePath, static_cast<size_t>(g_traceBufferSize),
+		g_traceBufferNumber, BackpressurePolicy::Block }
+{
+	const std::string header{ makeNpyHeader(m_fields, 0) };
+	m_traceWriter.write(header.data(), header.size());
+	m_traceWriter.endRecord();
+}
+
+NpyWriter::~NpyWriter()
+{
+	close();
+}
+
+void NpyWriter::write(const std::string& record)
+{
+	m_traceWriter.write(record.data(), record.size());
+	m_traceWriter.endRecord();
+	m_recordNumber++;
+}
+
+void NpyWriter::close()
+{
+	if (m_closed || !m_traceWriter.isOpen())
+		return;
+	m_closed = true;
+	m_traceWriter.close();
+
+	// the header has the same length for any record number
+	std::fstream file(m_filePath, std::ios::in | std::ios::out
+		| std::ios::binary);
+	const std::string header{ makeNpyHeader(m_fields, m_recordNumber) };
+	file.write(header.data(), static_cast<std::streamsize>(header.size()));
+}
+
+static unsigned int calculateCrc32(const std::string& data)
+{
+	static const std::array<unsigned int, 256> table{ [] {
+		std::array<unsigned int, 256> table{};
+		for (unsigned int i{}; i < 256; ++i)
+		{
+			unsigned int crc{ i };
+			for (int bit{}; bit < 8; ++bit)
+				crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+			table.at(i) = crc;
+		}
+		return table; }() };
+
+	unsigned int crc{ 0xFFFFFFFFu };
+	for (unsigned char byte : data)
+		crc = table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+	return crc ^ 0xFFFFFFFFu;
+}
+
+// zip header fields shared by the local and the central headers:
+// version needed, flags, method (stored), time, date, crc, sizes, name
+static void writeZipEntry(std::string& bytes, const unsigned int crc,
+	const unsigned int size, const std::string& name)
+{
+	writeLittleEndian(bytes, static_cast<unsigned short>(20));
+	writeLittleEndian(bytes, static_cast<unsigned short>(0));
+	writeLittleEndian(bytes, static_cast<unsigned short>(0));
+	writeLittleEndian(bytes, static_cast<unsigned short>(0));
+	writeLittleEndian(bytes, static_cast<unsigned short>(0x21)); // 1980-01-01
+	writeLittleEndian(bytes, crc);
+	writeLittleEndian(bytes, size);
+	writeLittleEndian(bytes, size);
+	writeLittleEndian(bytes, static_cast<unsigned short>(name.size()));
+	writeLittleEndian(bytes, static_cast<unsigned short>(0));
+}
+
+NpzWriter::NpzWriter(const std::string& filePath)
+{
+	m_file.open(filePath, std::ios::out | std::ios::binary);
+	if (!m_file.is_open())
+		std::cerr << "Error: Could not open result file: " << filePath << "\n";
+}
+
+NpzWriter::~NpzWriter()
+{
+	close();
+}
+
+void NpzWriter::add(const std::string& name, const std::string& npyFile)
+{
+	if (!m_file.is_open())
+		return;
+	Member member{ name + ".npy", calculateCrc32(npyFile),
+		static_cast<unsigned int>(npyFile.size()), m_offset };
+
+	std::string bytes{};
+	writeLittleEndian(bytes, 0x04034B50u);
+	writeZipEntry(bytes, member.m_crc, member.m_size, member.m_name);
+	bytes += member.m_name;
+	m_file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	m_file.write(npyFile.data(), static_cast<std::streamsize>(npyFile.size()));
+
+	m_offset += static_cast<unsigned int>(bytes.size() + npyFile.size());
+	m_members.push_back(member);
+}
+
+void NpzWriter::close()
+{
+	if (m_closed || !m_file.is_open())
+		return;
+	m_closed = true;
+
+	std::string bytes{};
+	for (auto& member : m_members)
+	{
+		writeLittleEndian(bytes, 0x02014B50u);
+		writeLittleEndian(bytes, static_cast<unsigned short>(20)); // made by
+		writeZipEntry(bytes, member.m_crc, member.m_size, member.m_name);
+		writeLittleEndian(bytes, static_cast<unsigned short>(0)); // comment
+		writeLittleEndian(bytes, static_cast<unsigned short>(0)); // disk
+		writeLittleEndian(bytes, static_cast<unsigned short>(0));
+		writeLittleEndian(bytes, 0u);
+		writeLittleEndian(bytes, member.m_offset);
+		bytes += member.m_name;
+	}
+	const unsigned int directorySize{ static_cast<unsigned int>(bytes.size()) };
+
+	writeLittleEndian(bytes, 0x06054B50u);
+	writeLittleEndian(bytes, static_cast<unsigned short>(0));
+	writeLittleEndian(bytes, static_cast<unsigned short>(0));
+	writeLittleEndian(bytes, static_cast<unsigned short>(m_members.size()));
+	writeLittleEndian(bytes, static_cast<unsigned short>(m_members.size()));
+	writeLittleEndian(bytes, directorySize);
+	writeLittleEndian(bytes, m_offset);
+	writeLittleEndian(bytes, static_cast<unsigned short>(0));
+	m_file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	m_file.close();
+}
+
+std::vector<NpyField> getTrafficInformationFields()
+{
+	return {
+		{ "packet_id", "<i4" },
+		{ "source", "<i4" },
+		{ "destination", "<i4" },
+		{ "packet_size", "<i4" },
+		{ "status", "|S1" },
+		{ "sent_time", "<f8" },
+		{ "received_time", "<f8" } };
+}
+
+std::string makeTrafficInformationRecord(const TrafficInformationEntry& entry)
+{
+	std::string record{};
+	appendNpyValue(record, entry.m_packetID);
+	appendNpyValue(record, entry.m_source);
+	appendNpyValue(record, entry.m_destination);
+	appendNpyValue(record, entry.m_packetSize);
+	appendNpyValue(record, entry.m_status.empty() ? ' ' : entry.m_status.front());
+	appendNpyValue(record, entry.m_sentTime);
+	appendNpyValue(record, entry.m_receivedTime);
+	return record;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include "DataStructures.h"
+#include "TraceWriter.h"
+
+// NumPy .npy (format version 1.0) and .npz writers, so the analysis
+// scripts can np.load results, memory mapped, instead of parsing CSV.
+// All values are little-endian.
+
+struct NpyField
+{
+	std::string m_name{};
+	std::string m_type{}; // NumPy type string, e.g. "<i4", "<f4", "|S1"
+};
+
+// header of a one-dimensional array of recordNumber records; its length
+// does not depend on recordNumber, so it can be patched in place
+std::string makeNpyHeader(const std::vector<NpyField>& fields,
+	const unsigned long long recordNumber);
+std::string makeNpyHeader(const std::string_view type,
+	const unsigned long long recordNumber);
+// whole .npy file of a one-dimensional float64 array
+std::string makeNpyArray(const std::vector<double>& values);
+// whole .npy file of a float64 scalar
+std::string makeNpyScalar(const double value);
+
+// append the raw little-endian bytes of a field to a record
+void appendNpyValue(std::string& record, const int value);
+void appendNpyValue(std::string& record, const double value);
+void appendNpyValue(std::string& record, const char value);
+
+// streams records of a structured type into a .npy file through a
+// background TraceWriter; the record number is patched into the header
+// on close
+class NpyWriter
+{
+public:
+	NpyWriter(const std::string& filePath, const std::vector<NpyField>& fields);
+	~NpyWriter();
+
+	void write(const std::string& record); // one complete record
+	void close();
+
+private:
+	std::string m_filePath{};
+	std::vector<NpyField> m_fields{};
+	TraceWriter m_traceWriter;
+	unsigned long long m_recordNumber{};
+	bool m_closed{};
+};
+
+// .npz archive: an uncompressed zip file of .npy members
+class NpzWriter
+{
+public:
+	NpzWriter(const std::string& filePath);
+	~NpzWriter();
+
+	// name without the .npy extension
+	void add(const std::string& name, const std::string& npyFile);
+	void close();
+
+private:
+	struct Member
+	{
+		std::string m_name{};
+		unsigned int m_crc{};
+		unsigned int m_size{};
+		unsigned int m_offset{};
+	};
+
+	std::ofstream m_file{};
+	std::vector<Member> m_members{};
+	unsigned int m_offset{};
+	bool m_closed{};
+};
+
+// per-packet record of TrafficInformation.npy and ReceivedTraffic.npy
+std::vector<NpyField> getTrafficInformationFields();
+std::string makeTrafficInformationRecord(const TrafficInformationEntry& entry);
@@ -0,0 +1,136 @@
+#include "PacketSink.h"
+
+void PacketSink::writeSentPacket(const TrafficInformationEntry&)
+{
+}
+
+void PacketSink::close()
+{
+}
+
+void StatisticsSink::writeSentPacket(const TrafficInformationEntry& entry)
+{
+	if (isMeasured(entry.m_sentTime))
+	{
+		m_trafficData.m_sentPacketNumber++;
+		m_trafficData.m_sentFlitNumber += entry.m_packetSize;
+	}
+	m_windowStatistics.addSentPacket(entry.m_sentTime, entry.m_packetSize);
+}
+
+void StatisticsSink::writeReceivedPacket(const TrafficInformationEntry& entry,
+	const std::vector<float>&)
+{
+	if (isMeasured(entry.m_receivedTime))
+	{
+		m_trafficData.m_receivedPacketNumber++;
+		m_trafficData.m_receivedFlitNumber += entry.m_packetSize;
+	}
+	// latency is accounted to the packets sent in the measurement window,
+	// the same as TrafficOperator::collectData does
+	if (isMeasured(entry.m_sentTime))
+	{
+		m_trafficData.m_accumulatedLatency +=
+		(entry.m_receivedTime - entry.m_sentTime - 1);
+		m_trafficData.addLatencyBreakdown(entry);
+	}
+	m_windowStatistics.addReceivedPacket(entry.m_sentTime,
+		entry.m_receivedTime, entry.m_packetSize);
+}
+
+bool StatisticsSink::isMeasured(const double time)
+{
+	return time >= g_warmupCycles
+		&& time < (g_warmupCycles + g_measurementCycles);
+}
+
+TraceSink::TraceSink(const std::string& traceFilePath)
+	:
+	m_traceWriter{ traceFilePath }
+{
+	m_traceWriter
+		<< "PacketID" << ','
+		<< "Source" << ','
+		<< "Destination" << ','
+		<< "PacketSize" << ','
+		<< "Status" << ','
+		<< "SentTime" << ','
+		<< "ReceivedTime" << ','
+		<< '\n';
+	m_traceWriter.endRecord();
+}
+
+void TraceSink::writeReceivedPacket(const TrafficInformationEntry& entry,
+	const std::vector<float>& data)
+{
+	StatisticsSink::writeReceivedPacket(entry, data);
+	m_traceWriter
+		<< entry.m_packetID << ','
+		<< entry.m_source << ','
+		<< entry.m_destination << ','
+		<< entry.m_packetSize << ','
+		<< entry.m_status << ','
+		<< entry.m_sentTime << ','
+		<< entry.m_receivedTime << ','
+		<< '\n';
+	m_traceWriter.endRecord();
+}
+
+void TraceSink::close()
+{
+	m_traceWriter.close();
+	if (m_traceWriter.getDroppedRecordNumber())
+		std::cerr << "Warning: " << m_traceWriter.getDroppedRecordNumber()
+		<< " trace records dropped under backpressure\n";
+}
+
+CompactTraceSink::CompactTraceSink(const std::string& traceFilePath)
+	:
+	m_traceWriter{ traceFilePath } {
+}
+
+void CompactTraceSink::writeSentPacket(const TrafficInformationEntry& entry)
+{
+	StatisticsSink::writeSentPacket(entry);
+	m_traceWriter.write(entry);
+}
+
+void CompactTraceSink::writeReceivedPacket(const TrafficInformationEntry& entry,
+	const std::vector<float>& data)
+{
+	StatisticsSink::writeReceivedPacket(entry, data);
+	m_traceWriter.write(entry);
+}
+
+void CompactTraceSink::close()
+{
+	m_traceWriter.close();
+}
+
+NpyTraceSink::NpyTraceSink(const std::string& traceFilePath)
+	:
+	m_npyWriter{ traceFilePath, getTrafficInformationFields() } {
+}
+
+void NpyTraceSink::writeReceivedPacket(const TrafficInformationEntry& entry,
+	const std::vector<float>& data)
+{
+	StatisticsSink::writeReceivedPacket(entry, data);
+	m_npyWriter.write(makeTrafficInformationRecord(entry));
+}
+
+void NpyTraceSink::close()
+{
+	m_npyWriter.close();
+}
+
+CallbackSink::CallbackSink(const Callback& callback)
+	:
+	m_callback{ callback } {
+}
+
+void CallbackSink::writeReceivedPacket(const TrafficInformationEntry& entry,
+	const std::vector<float>& data)
+{
+	m_callback(entry, data);
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <functional>
+#include "DataStructures.h"
+#include "TraceWriter.h"
+#include "CompactTrace.h"
+#include "NumpyWriter.h"
+
+// consumer of the packets a terminal interface sends and receives;
+// a terminal interface with a sink hands every delivered packet to it
+// instead of retaining it, so memory stays flat for long runs
+class PacketSink
+{
+public:
+	virtual ~PacketSink() = default;
+
+	virtual void writeSentPacket(const TrafficInformationEntry& entry);
+	virtual void writeReceivedPacket(const TrafficInformationEntry& entry,
+		const std::vector<float>& data) = 0;
+	virtual void close();
+};
+
+// update online statistics and drop the packet
+class StatisticsSink : public PacketSink
+{
+public:
+	StatisticsSink() = default;
+
+	void writeSentPacket(const TrafficInformationEntry& entry) override;
+	void writeReceivedPacket(const TrafficInformationEntry& entry,
+		const std::vector<float>& data) override;
+
+	TrafficData m_trafficData{};
+	WindowStatistics m_windowStatistics{};
+
+private:
+	bool isMeasured(const double time);
+};
+
+// update online statistics and stream the packet into a trace file
+class TraceSink : public StatisticsSink
+{
+public:
+	TraceSink(const std::string& traceFilePath);
+
+	void writeReceivedPacket(const TrafficInformationEntry& entry,
+		const std::vector<float>& data) override;
+	void close() override;
+
+private:
+	TraceWriter m_traceWriter;
+};
+
+// update online statistics and stream sent and received packets
+// into a compact, block indexed trace (see CompactTrace.h)
+class CompactTraceSink : public StatisticsSink
+{
+public:
+	CompactTraceSink(const std::string& traceFilePath);
+
+	void writeSentPacket(const TrafficInformationEntry& entry) override;
+	void writeReceivedPacket(const TrafficInformationEntry& entry,
+		const std::vector<float>& data) override;
+	void close() override;
+
+private:
+	CompactTraceWriter m_traceWriter;
+};
+
+// update online statistics and stream the packet into a .npy file
+class NpyTraceSink : public StatisticsSink
+{
+public:
+	NpyTraceSink(const std::string& traceFilePath);
+
+	void writeReceivedPacket(const TrafficInformationEntry& entry,
+		const std::vector<float>& data) override;
+	void close() override;
+
+private:
+	NpyWriter m_npyWriter;
+};
+
+// hand the packet to a user callback
+class CallbackSink : public PacketSink
+{
+public:
+	using Callback = std::function<void(const TrafficInformationEntry&,
+		const std::vector<float>&)>;
+
+	CallbackSink(const Callback& callback);
+
+	void writeReceivedPacket(const TrafficInformationEntry& entry,
+		const std::vector<float>& data) override;
+
+private:
+	Callback m_callback{};
+};
@@ -5,24 +5,58 @@
 // 0 off
 // 1 Router and Port
 #define BENCHMARK 1
+#ifndef PROFILE
+#define PROFILE 0 // 1 times the phases of every cycle, see Profiler.h
+#endif
 #define REPRODUCE_RANDOM 1
 #define MAGIC_NUMBER 42
+#define SOXIM_VERSION "1.0"
+// the version of the simulated model, which keys the result and route
+// caches; bump it with every change to simulation results, together with
+// the pinned results of ResultCacheTest.ModelVersionPinsResults
+#define SOXIM_MODEL_VERSION 2
 
-inline int g_x{}, g_y{}, g_z{};
-inline std::string_view g_shape{};
-inline std::string_view g_routingAlgorithm{};
-inline int g_virtualChannelNumber{};
-inline int g_bufferSize{};
-inline int g_flitSize{};
-inline int g_packetSize{};
-inline std::string_view g_packetSizeOption{};
-inline float g_injectionRate{};
-inline std::string_view g_injectionProcess{};
-inline float g_alpha{};
-inline float g_beta{};
-inline std::string_view g_trafficPattern{};
-inline int g_totalCycles{};
-inline int g_warmupCycles{};
-inline int g_measurementCycles{};
-inline int g_drainCycles{};
-inline int g_packetNumber{};
\ No newline at end of file
+// the configuration of the simulation running on this thread; a new
+// thread starts from these defaults, see SimulationConfiguration::apply
+inline thread_local int g_x{}, g_y{}, g_z{};
+inline thread_local std::string_view g_shape{};
+inline thread_local std::string_view g_routingAlgorithm{};
+inline thread_local std::string_view g_routingMode{ "source" }; // "source" tables or "distributed" per hop
+inline thread_local std::string_view g_selectionFunction{ "none" }; // output port selection of adaptive MAD and ODD_EVEN
+inline thread_local int g_escapeVirtualChannelNumber{ -1 }; // DOR-routed escape VCs per port of adaptive MAD; -1 as many as the shape needs
+inline thread_local std::string_view g_routeCacheDirectory{}; // empty if routes are not cached
+inline thread_local int g_virtualChannelNumber{};
+inline thread_local int g_bufferSize{};
+inline thread_local int g_sourceQueueCapacity{}; // flits below which a source queue takes packets; 0 is unbounded
+inline thread_local std::string_view g_sourceQueuePolicy{ "stall" }; // while full: "stall" defers new packets, "drop" drops them
+inline thread_local int g_flitSize{};
+inline thread_local int g_packetSize{};
+inline thread_local std::string_view g_packetSizeOption{};
+inline thread_local float g_injectionRate{};
+inline thread_local std::string_view g_injectionProcess{};
+inline thread_local std::string_view g_replayTraceFile{};
+inline thread_local float g_alpha{};
+inline thread_local float g_beta{};
+inline thread_local std::string_view g_trafficPattern{};
+inline thread_local int g_totalCycles{};
+inline thread_local int g_warmupCycles{};
+inline thread_local int g_measurementCycles{};
+inline thread_local int g_drainCycles{};
+inline thread_local int g_packetNumber{};
+inline thread_local std::string_view g_ejectionSink{};
+inline thread_local int g_traceBufferSize{ 1 << 22 }; // bytes per trace buffer
+inline thread_local int g_traceBufferNumber{ 2 }; // trace buffers per trace file
+inline thread_local std::string_view g_traceBackpressure{ "block" };
+inline thread_local std::string_view g_traceFormat{ "csv" };
+inline thread_local bool g_numpyExport{};
+inline thread_local bool g_memoryReport{}; // bytes held per subsystem at phase boundaries
+inline thread_local bool g_linkCounters{}; // write LinkCounters.json after the measurement window
+inline thread_local bool g_sourceQueueHistograms{}; // write SourceQueues.json after the measurement window
+inline thread_local int g_flitTraceSample{}; // trace every N-th packet of a source into FlitTrace.sft; 0 is off
+inline thread_local int g_flitTraceSource{ -1 }; // trace packets of this source node only; -1 is any
+inline thread_local int g_flitTraceDestination{ -1 }; // trace packets to this destination node only; -1 is any
+inline thread_local int g_flitTraceRingSize{ 1 << 16 }; // records the flit trace ring holds
+inline thread_local int g_telemetryInterval{}; // cycles between snapshots in Telemetry.stats; 0 is off
+inline thread_local std::string_view g_resultCacheDirectory{}; // empty if results are not cached
+inline thread_local int g_statisticsWindow{ 1000 }; // cycles per window of the statistics
+inline thread_local std::string_view g_hugePages{ "none" }; // backing of the network arena: "none", "thp" or "hugetlb"
\ No newline at end of file
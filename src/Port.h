@@ -2,6 +2,14 @@
 #include "DataStructures.h"
 #include "Register.h"
 
+// utilisation of a port since the counters were last reset
+struct PortCounters
+{
+	unsigned long long m_flits{}; // flits sent out over the link
+	unsigned long long m_creditStalls{}; // cycles an active VC waited for downstream credits
+	unsigned long long m_occupancy{}; // flits buffered in the input VCs, summed over cycles
+};
+
 struct Port
 {
 	Port() = default;
@@ -14,4 +22,5 @@ struct Port
 	Register m_inputRegister{}, m_outputRegister{};
 	std::vector<std::deque<Flit>> m_virtualChannels{ std::vector<std::deque<Flit>>(g_virtualChannelNumber) };
 	std::vector<ControlField> m_controlFields{ std::vector<ControlField>(g_virtualChannelNumber) };
+	PortCounters m_counters{};
 };
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "Profiler.h"
+#include <iomanip>
+
+static const char* c_profilePhaseNames[]{
+	"link traversal",
+	"receive flit",
+	"receive credit",
+	"compute route",
+	"allocate virtual channel",
+	"traverse switch",
+	"allocate switch",
+	"terminal inject",
+	"terminal eject"
+};
+
+void Profiler::reset()
+{
+	for (auto& ticks : s_ticks)
+		ticks = 0;
+	s_startTime = std::chrono::steady_clock::now();
+	s_startTicks = readTimer();
+}
+
+double Profiler::getTicksPerSecond()
+{
+	const std::chrono::duration<double> elapsed{
+		std::chrono::steady_clock::now() - s_startTime };
+	if (elapsed.count() <= 0.0)
+		return 1.0;
+	return static_cast<double>(readTimer() - s_startTicks) / elapsed.count();
+}
+
+double Profiler::getSeconds(const ProfilePhase phase)
+{
+	return static_cast<double>(s_ticks[static_cast<int>(phase)])
+		/ getTicksPerSecond();
+}
+
+void Profiler::report(std::ostream& stream, const long long cycles)
+{
+	const std::chrono::duration<double> elapsed{
+		std::chrono::steady_clock::now() - s_startTime };
+	const double ticksPerSecond{ getTicksPerSecond() };
+	unsigned long long totalTicks{};
+	for (auto& ticks : s_ticks)
+		totalTicks += ticks;
+
+	stream << "************** Simulator profile **************\n"
+		<< std::left << std::setw(26) << "phase"
+		<< std::right << std::setw(12) << "seconds" << std::setw(9) << "share\n";
+	for (int i{}; i < static_cast<int>(ProfilePhase::COUNT); ++i)
+	{
+		stream << std::left << std::setw(26) << c_profilePhaseNames[i]
+			<< std::right << std::fixed << std::setprecision(4) << std::setw(12)
+			<< s_ticks[i] / ticksPerSecond
+			<< std::setprecision(1) << std::setw(7)
+			<< (totalTicks ? 100.0 * s_ticks[i] / totalTicks : 0.0) << "%\n";
+	}
+	stream << std::defaultfloat << std::setprecision(6)
+		<< "Profiled: " << totalTicks / ticksPerSecond << " s of "
+		<< elapsed.count() << " s\n"
+		<< "Simulated cycles per second: "
+		<< (elapsed.count() > 0.0 ? cycles / elapsed.count() : 0.0) << "\n";
+}
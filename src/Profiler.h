@@ -0,0 +1,72 @@
+#pragma once
+#include <chrono>
+#include <ostream>
+#include "Parameters.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// phases of a network cycle the profiler times
+enum class ProfilePhase
+{
+	LINK_TRAVERSAL,
+	RECEIVE_FLIT,
+	RECEIVE_CREDIT,
+	COMPUTE_ROUTE,
+	ALLOCATE_VIRTUAL_CHANNEL,
+	TRAVERSE_SWITCH,
+	ALLOCATE_SWITCH,
+	INJECT,
+	EJECT,
+	COUNT
+};
+
+// wall-clock time per phase of the simulation on this thread; timed by the
+// TSC where there is one, steady_clock elsewhere, and converted to seconds
+// against steady_clock at the report
+class Profiler
+{
+public:
+	static void reset();
+	static unsigned long long readTimer()
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+	}
+	static void add(const ProfilePhase phase, const unsigned long long ticks)
+	{
+		s_ticks[static_cast<int>(phase)] += ticks;
+	}
+	static double getSeconds(const ProfilePhase phase);
+	// per-phase breakdown and simulated cycles per second since reset()
+	static void report(std::ostream& stream, const long long cycles);
+
+private:
+	static double getTicksPerSecond();
+
+	static inline thread_local unsigned long long
+		s_ticks[static_cast<int>(ProfilePhase::COUNT)]{};
+	static inline thread_local unsigned long long s_startTicks{};
+	static inline thread_local std::chrono::steady_clock::time_point s_startTime{};
+};
+
+// times the enclosing scope as one phase
+struct ProfileScope
+{
+	ProfileScope(const ProfilePhase phase)
+		: m_phase{ phase }, m_start{ Profiler::readTimer() } {}
+	~ProfileScope() { Profiler::add(m_phase, Profiler::readTimer() - m_start); }
+
+	ProfilePhase m_phase{};
+	unsigned long long m_start{};
+};
+
+// compiled out unless PROFILE is set
+#if PROFILE
+#define PROFILE_SCOPE(phase) ProfileScope profileScope{ phase }
+#else
+#define PROFILE_SCOPE(phase)
+#endif
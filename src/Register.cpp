@@ -1,4 +1,5 @@
 #include "Register.h"
+#include "MemoryFootprint.h"
 
 void Register::pushbackFlit(const Flit flit)
 {
@@ -34,6 +35,11 @@ bool Register::isCreditRegisterEmpty()
 	return m_creditRegister.empty();
 }
 
+size_t Register::getHeapBytes() const
+{
+	return ::getHeapBytes(m_flitRegister) + ::getHeapBytes(m_creditRegister);
+}
+
 void Register::debug()
 {
 #if (DEBUG > 0)
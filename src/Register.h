@@ -11,6 +11,7 @@ public:
 	Credit popfrontCredit();
 	bool isFlitRegisterEmpty();
 	bool isCreditRegisterEmpty();
+	size_t getHeapBytes() const; // of the queued flits and credits
 	void debug();
 
 	bool m_flitEnable{};
@@ -1,9 +1,16 @@
 #include "RegularNetwork.h"
-#include <random>
+#include "Profiler.h"
+#include "MemoryFootprint.h"
+#include "Arena.h"
 #include <cmath>
 
 RegularNetwork::RegularNetwork()
 {
+	// a router has 7 ports and 4 links at most, with its terminal's
+	const size_t routers{ static_cast<size_t>(m_dimension.getProduct()) };
+	m_arena = new Arena{ g_hugePages, routers * (sizeof(Router) + 7 * sizeof(Port)
+		+ 4 * sizeof(Link) + sizeof(TerminalInterface)) };
+	ActiveArena activeArena{ m_arena };
 	createRouters();
 	if (g_shape == "MESH")
 		connectMESH();
@@ -13,22 +20,25 @@ RegularNetwork::RegularNetwork()
 
 RegularNetwork::~RegularNetwork()
 {
-	deleteRouters();
-	deleteLinks();
-	deleteTerminalInterfaces();
+	{
+		ActiveArena activeArena{ m_arena };
+		deleteRouters();
+		deleteLinks();
+		deleteTerminalInterfaces();
+	}
+	delete m_arena;
+	m_arena = nullptr;
 }
 
+// every component once; the links go first and latch the register enables
+// the cycle starts with, the routers enable their VCs themselves
 void RegularNetwork::runOneCycle()
 {
-	for (auto& link : m_links)
-		link->updateEnable();
-	for (auto& router : m_routers)
-		router->updateEnable();
-	for (auto& terminalInterface : m_terminalInterfaces)
-		terminalInterface->updateEnable();
-
-	for (auto& link : m_links)
-		link->runOneCycle();
+	{
+		PROFILE_SCOPE(ProfilePhase::LINK_TRAVERSAL);
+		for (auto& link : m_links)
+			link->runOneCycle();
+	}
 	for (auto& router : m_routers)
 		router->runOneCycle();
 	for (auto& terminalInterface : m_terminalInterfaces)
@@ -40,32 +50,138 @@ int RegularNetwork::getRouterNumber()
 	return m_dimension.getProduct();
 }
 
-void RegularNetwork::connectTerminal(const int routerID,
-	TerminalInterface* terminalInterface)
+TerminalInterface* RegularNetwork::connectTerminal(const int routerID)
 {
-	Link* link{ new Link{m_routers.at(routerID), terminalInterface} };
+	ActiveArena activeArena{ m_arena };
+	TerminalInterface* terminalInterface{ Arena::create<TerminalInterface>(-routerID - 1) };
+	Link* link{ Arena::create<Link>(m_routers.at(routerID), terminalInterface) };
 	m_links.push_back(link);
 	m_terminalInterfaces.push_back(terminalInterface);
 	terminalInterface->m_terminalInterfaceIDTorus =
 		convertIDToCoordinate(terminalInterface->m_port.m_portID);
+	return terminalInterface;
 }
 
 void RegularNetwork::loadNetworkData()
 {
-	generateRoutes();
+	// routers route by themselves in distributed routing
+	if (!RoutingFunction::isDistributedRouting())
+		generateRoutes();
+	updatePriorities();
+}
+
+void RegularNetwork::loadNetworkData(const RoutingTables& routingTables)
+{
+	for (size_t i{}; i < m_terminalInterfaces.size(); ++i)
+		m_terminalInterfaces.at(i)->m_sourceRoutingTable = routingTables.at(i);
+	updatePriorities();
+}
+
+void RegularNetwork::loadNetworkData(const RouteTable* routeTable)
+{
+	for (auto& terminalInterface : m_terminalInterfaces)
+	{
+		terminalInterface->m_sourceRoutingTable.clear();
+		terminalInterface->m_routeTable = routeTable;
+	}
 	updatePriorities();
 }
 
+RoutingTables RegularNetwork::getRoutingTables()
+{
+	RoutingTables routingTables{};
+	for (auto& terminalInterface : m_terminalInterfaces)
+		routingTables.push_back(terminalInterface->m_sourceRoutingTable);
+	return routingTables;
+}
+
+void RegularNetwork::measureMemory(MemoryFootprint& footprint) const
+{
+	for (auto& router : m_routers)
+		router->measureMemory(footprint);
+	for (auto& terminalInterface : m_terminalInterfaces)
+		terminalInterface->measureMemory(footprint);
+}
+
+void RegularNetwork::resetPortCounters()
+{
+	for (auto& router : m_routers)
+		router->resetCounters();
+}
+
+bool RegularNetwork::writePortCounters(const std::string& filePath,
+	const int cycles) const
+{
+	std::ofstream file{ filePath };
+	if (!file)
+		return false;
+	file << "{\"shape\": \"" << g_shape << "\", \"x\": " << g_x << ", \"y\": " << g_y
+		<< ", \"z\": " << g_z << ", \"cycles\": " << cycles << ",\n"
+		<< " \"columns\": [\"router\", \"port\", \"flits\", \"credit_stalls\", \"occupancy\"],\n"
+		<< " \"rows\": [";
+	const char* separator{ "\n" };
+	for (auto& router : m_routers)
+	{
+		for (auto& port : router->m_ports)
+		{
+			file << separator << "  [" << router->m_routerID << ", " << port->m_portID
+				<< ", " << port->m_counters.m_flits << ", " << port->m_counters.m_creditStalls
+				<< ", " << static_cast<double>(port->m_counters.m_occupancy)
+				/ std::max(cycles, 1) << "]";
+			separator = ",\n";
+		}
+	}
+	file << "\n ]}\n";
+	return static_cast<bool>(file);
+}
+
+void RegularNetwork::resetSourceQueueStatistics()
+{
+	for (auto& terminalInterface : m_terminalInterfaces)
+		terminalInterface->resetSourceQueueStatistics();
+}
+
+bool RegularNetwork::writeSourceQueueStatistics(const std::string& filePath,
+	const int cycles) const
+{
+	std::ofstream file{ filePath };
+	if (!file)
+		return false;
+	size_t bucketNumber{};
+	for (auto& terminalInterface : m_terminalInterfaces)
+		bucketNumber = std::max(bucketNumber,
+			terminalInterface->m_sourceQueueDepthHistogram.size());
+	file << "{\"capacity\": " << g_sourceQueueCapacity << ", \"policy\": \""
+		<< g_sourceQueuePolicy << "\", \"cycles\": " << cycles << ",\n"
+		<< " \"depth_buckets\": [";
+	for (size_t i{}; i < bucketNumber; ++i)
+		file << (i ? ", " : "") << TerminalInterface::getDepthBucketStart(static_cast<int>(i));
+	file << "],\n"
+		<< " \"columns\": [\"terminal\", \"stalled\", \"dropped\", \"depth_cycles\"],\n"
+		<< " \"rows\": [";
+	const char* separator{ "\n" };
+	for (auto& terminalInterface : m_terminalInterfaces)
+	{
+		const std::vector<long long>& histogram{
+			terminalInterface->m_sourceQueueDepthHistogram };
+		file << separator << "  [" << terminalInterface->m_terminalInterfaceID << ", "
+			<< terminalInterface->m_stalledPacketNumber << ", "
+			<< terminalInterface->m_droppedPacketNumber << ", [";
+		for (size_t i{}; i < bucketNumber; ++i)
+			file << (i ? ", " : "") << (i < histogram.size() ? histogram[i] : 0);
+		file << "]]";
+		separator = ",\n";
+	}
+	file << "\n ]}\n";
+	return static_cast<bool>(file);
+}
+
 void RegularNetwork::generateRoutes()
 {
 	if (g_routingAlgorithm == "DOR")
 		routeDOR();
-	else if (g_routingAlgorithm == "ROMM")
-		routeROMM();
 	else if (g_routingAlgorithm == "MAD")
 		routeMAD();
-	else if (g_routingAlgorithm == "VAL")
-		routeVAL();
 	else if (g_routingAlgorithm == "ODD_EVEN")
 		routeOddEven();
 }
@@ -80,7 +196,7 @@ void RegularNetwork::createRouters()
 {
 	for (int i{}; i < m_dimension.getProduct(); ++i)
 	{
-		Router* router{ new Router{i} };
+		Router* router{ Arena::create<Router>(i) };
 		m_routers.push_back(router);
 	}
 }
@@ -89,7 +205,7 @@ void RegularNetwork::deleteRouters()
 {
 	for (auto& router : m_routers)
 	{
-		delete router;
+		Arena::destroy(router);
 		router = nullptr;
 	}
 }
@@ -105,40 +221,40 @@ void RegularNetwork::connectMESH()
 				// x-axis connections
 				if (i != m_dimension.m_x - 1)
 				{
-					Link* linkX{ new Link{
+					Link* linkX{ Arena::create<Link>(
 						m_routers.at(i
 						+ j * m_dimension.m_x
 						+ k * m_dimension.m_x * m_dimension.m_y),
 
 						m_routers.at(i + 1
 						+ j * m_dimension.m_x
-						+ k * m_dimension.m_x * m_dimension.m_y)} };
+						+ k * m_dimension.m_x * m_dimension.m_y)) };
 					m_links.push_back(linkX);
 				}
 				// y-axis connections
 				if (j != m_dimension.m_y - 1)
 				{
-					Link* linkY{ new Link{
+					Link* linkY{ Arena::create<Link>(
 						m_routers.at(i
 						+ j * m_dimension.m_x
 						+ k * m_dimension.m_x * m_dimension.m_y),
 
 						m_routers.at(i
 						+ (j + 1) * m_dimension.m_x
-						+ k * m_dimension.m_x * m_dimension.m_y)} };
+						+ k * m_dimension.m_x * m_dimension.m_y)) };
 					m_links.push_back(linkY);
 				}
 				// z-axis connections
 				if (k != m_dimension.m_z - 1)
 				{
-					Link* linkZ{ new Link{
+					Link* linkZ{ Arena::create<Link>(
 						m_routers.at(i
 						+ j * m_dimension.m_x
 						+ k * m_dimension.m_x * m_dimension.m_y),
 
 						m_routers.at(i
 						+ j * m_dimension.m_x
-						+ (k + 1) * m_dimension.m_x * m_dimension.m_y)} };
+						+ (k + 1) * m_dimension.m_x * m_dimension.m_y)) };
 					m_links.push_back(linkZ);
 				}
 			}
@@ -159,26 +275,26 @@ void RegularNetwork::connectTORUS()
 				{
 					if (i == m_dimension.m_x - 1)
 					{
-						Link* linkX{ new Link{
+						Link* linkX{ Arena::create<Link>(
 							m_routers.at(i
 							+ j * m_dimension.m_x
 							+ k * m_dimension.m_x * m_dimension.m_y),
 
 							m_routers.at(0
 							+ j * m_dimension.m_x
-							+ k * m_dimension.m_x * m_dimension.m_y)} };
+							+ k * m_dimension.m_x * m_dimension.m_y)) };
 						m_links.push_back(linkX);
 					}
 					else
 					{
-						Link* linkX{ new Link{
+						Link* linkX{ Arena::create<Link>(
 							m_routers.at(i
 							+ j * m_dimension.m_x
 							+ k * m_dimension.m_x * m_dimension.m_y),
 
 							m_routers.at(i + 1
 							+ j * m_dimension.m_x
-							+ k * m_dimension.m_x * m_dimension.m_y)} };
+							+ k * m_dimension.m_x * m_dimension.m_y)) };
 						m_links.push_back(linkX);
 					}
 				}
@@ -187,26 +303,26 @@ void RegularNetwork::connectTORUS()
 				{
 					if (j == m_dimension.m_y - 1)
 					{
-						Link* linkY{ new Link{
+						Link* linkY{ Arena::create<Link>(
 							m_routers.at(i
 							+ j * m_dimension.m_x
 							+ k * m_dimension.m_x * m_dimension.m_y),
 
 							m_routers.at(i
 							+ 0 * m_dimension.m_x
-							+ k * m_dimension.m_x * m_dimension.m_y)} };
+							+ k * m_dimension.m_x * m_dimension.m_y)) };
 						m_links.push_back(linkY);
 					}
 					else
 					{
-						Link* linkY{ new Link{
+						Link* linkY{ Arena::create<Link>(
 							m_routers.at(i
 							+ j * m_dimension.m_x
 							+ k * m_dimension.m_x * m_dimension.m_y),
 
 							m_routers.at(i
 							+ (j + 1) * m_dimension.m_x
-							+ k * m_dimension.m_x * m_dimension.m_y)} };
+							+ k * m_dimension.m_x * m_dimension.m_y)) };
 						m_links.push_back(linkY);
 					}
 				}
@@ -215,26 +331,26 @@ void RegularNetwork::connectTORUS()
 				{
 					if (k == m_dimension.m_z - 1)
 					{
-						Link* linkZ{ new Link{
+						Link* linkZ{ Arena::create<Link>(
 							m_routers.at(i
 							+ j * m_dimension.m_x
 							+ k * m_dimension.m_x * m_dimension.m_y),
 
 							m_routers.at(i
 							+ j * m_dimension.m_x
-							+ 0 * m_dimension.m_x * m_dimension.m_y)} };
+							+ 0 * m_dimension.m_x * m_dimension.m_y)) };
 						m_links.push_back(linkZ);
 					}
 					else
 					{
-						Link* linkZ{ new Link{
+						Link* linkZ{ Arena::create<Link>(
 							m_routers.at(i
 							+ j * m_dimension.m_x
 							+ k * m_dimension.m_x * m_dimension.m_y),
 
 							m_routers.at(i
 							+ j * m_dimension.m_x
-							+ (k + 1) * m_dimension.m_x * m_dimension.m_y)} };
+							+ (k + 1) * m_dimension.m_x * m_dimension.m_y)) };
 						m_links.push_back(linkZ);
 					}
 				}
@@ -247,7 +363,7 @@ void RegularNetwork::deleteLinks()
 {
 	for (auto& link : m_links)
 	{
-		delete link;
+		Arena::destroy(link);
 		link = nullptr;
 	}
 }
@@ -256,7 +372,7 @@ void RegularNetwork::deleteTerminalInterfaces()
 {
 	for (auto& terminalInterface : m_terminalInterfaces)
 	{
-		delete terminalInterface;
+		Arena::destroy(terminalInterface);
 		terminalInterface = nullptr;
 	}
 }
@@ -286,7 +402,7 @@ void RegularNetwork::routeDOR()
 			Coordinate dest{ destination->m_terminalInterfaceIDTorus };
 			if (src != dest)
 			{
-				std::deque<int> route{};
+				std::vector<int> route{};
 				Coordinate next{ src };
 				if (g_shape == "MESH")
 				{
@@ -397,85 +513,6 @@ void RegularNetwork::routeDOR()
 	}
 }
 
-// Randomized Oblivious Multi-phase Minimal (ROMM) routing
-// Uses multiple phases with random intermediate destinations
-void RegularNetwork::routeROMM()
-{
-#if REPRODUCE_RANDOM
-	std::mt19937 gen(MAGIC_NUMBER);
-#else
-	std::random_device rd;
-	std::mt19937 gen(rd());
-#endif
-
-	for (auto& source : m_terminalInterfaces)
-	{
-		source->m_sourceRoutingTable.clear();
-		Coordinate src{ source->m_terminalInterfaceIDTorus };
-
-		for (auto& destination : m_terminalInterfaces)
-		{
-			Coordinate dest{ destination->m_terminalInterfaceIDTorus };
-			if (src != dest)
-			{
-				std::deque<int> route{};
-
-				// Phase 1: Route to random intermediate router
-				Coordinate intermediate;
-				do {
-					intermediate.m_x = std::uniform_int_distribution<>(0, m_dimension.m_x - 1)(gen);
-					intermediate.m_y = std::uniform_int_distribution<>(0, m_dimension.m_y - 1)(gen);
-					intermediate.m_z = std::uniform_int_distribution<>(0, m_dimension.m_z - 1)(gen);
-				} while (intermediate == src || intermediate == dest);
-
-				// Route from src to intermediate (using DOR)
-				Coordinate next = src;
-				while (intermediate.m_x != next.m_x) {
-					if (intermediate.m_x > next.m_x)
-						route.push_back(convertCoordinateToID(next.incrementX(m_dimension.m_x)));
-					else
-						route.push_back(convertCoordinateToID(next.decrementX(m_dimension.m_x)));
-				}
-				while (intermediate.m_y != next.m_y) {
-					if (intermediate.m_y > next.m_y)
-						route.push_back(convertCoordinateToID(next.incrementY(m_dimension.m_y)));
-					else
-						route.push_back(convertCoordinateToID(next.decrementY(m_dimension.m_y)));
-				}
-				while (intermediate.m_z != next.m_z) {
-					if (intermediate.m_z > next.m_z)
-						route.push_back(convertCoordinateToID(next.incrementZ(m_dimension.m_z)));
-					else
-						route.push_back(convertCoordinateToID(next.decrementZ(m_dimension.m_z)));
-				}
-
-				// Phase 2: Route from intermediate to destination (using DOR)
-				while (dest.m_x != next.m_x) {
-					if (dest.m_x > next.m_x)
-						route.push_back(convertCoordinateToID(next.incrementX(m_dimension.m_x)));
-					else
-						route.push_back(convertCoordinateToID(next.decrementX(m_dimension.m_x)));
-				}
-				while (dest.m_y != next.m_y) {
-					if (dest.m_y > next.m_y)
-						route.push_back(convertCoordinateToID(next.incrementY(m_dimension.m_y)));
-					else
-						route.push_back(convertCoordinateToID(next.decrementY(m_dimension.m_y)));
-				}
-				while (dest.m_z != next.m_z) {
-					if (dest.m_z > next.m_z)
-						route.push_back(convertCoordinateToID(next.incrementZ(m_dimension.m_z)));
-					else
-						route.push_back(convertCoordinateToID(next.decrementZ(m_dimension.m_z)));
-				}
-
-				route.push_back(destination->m_terminalInterfaceID);
-				source->m_sourceRoutingTable.push_back(route);
-			}
-		}
-	}
-}
-
 // Minimal Adaptive (MAD) routing
 // Uses minimal paths with adaptive selection based on congestion
 void RegularNetwork::routeMAD()
@@ -490,7 +527,7 @@ void RegularNetwork::routeMAD()
 			Coordinate dest{ destination->m_terminalInterfaceIDTorus };
 			if (src != dest)
 			{
-				std::deque<int> route{};
+				std::vector<int> route{};
 				Coordinate next{ src };
 
 				// Adaptive routing: choose direction based on congestion
@@ -532,85 +569,6 @@ void RegularNetwork::routeMAD()
 	}
 }
 
-// Valiant's Randomized Algorithm (VAL)
-// Uses random intermediate destination for load balancing
-void RegularNetwork::routeVAL()
-{
-#if REPRODUCE_RANDOM
-	std::mt19937 gen(MAGIC_NUMBER);
-#else
-	std::random_device rd;
-	std::mt19937 gen(rd());
-#endif
-
-	for (auto& source : m_terminalInterfaces)
-	{
-		source->m_sourceRoutingTable.clear();
-		Coordinate src{ source->m_terminalInterfaceIDTorus };
-
-		for (auto& destination : m_terminalInterfaces)
-		{
-			Coordinate dest{ destination->m_terminalInterfaceIDTorus };
-			if (src != dest)
-			{
-				std::deque<int> route{};
-
-				// Select random intermediate router
-				Coordinate intermediate;
-				do {
-					intermediate.m_x = std::uniform_int_distribution<>(0, m_dimension.m_x - 1)(gen);
-					intermediate.m_y = std::uniform_int_distribution<>(0, m_dimension.m_y - 1)(gen);
-					intermediate.m_z = std::uniform_int_distribution<>(0, m_dimension.m_z - 1)(gen);
-				} while (intermediate == src || intermediate == dest);
-
-				// Route from src to intermediate (using DOR)
-				Coordinate next = src;
-				while (intermediate.m_x != next.m_x) {
-					if (intermediate.m_x > next.m_x)
-						route.push_back(convertCoordinateToID(next.incrementX(m_dimension.m_x)));
-					else
-						route.push_back(convertCoordinateToID(next.decrementX(m_dimension.m_x)));
-				}
-				while (intermediate.m_y != next.m_y) {
-					if (intermediate.m_y > next.m_y)
-						route.push_back(convertCoordinateToID(next.incrementY(m_dimension.m_y)));
-					else
-						route.push_back(convertCoordinateToID(next.decrementY(m_dimension.m_y)));
-				}
-				while (intermediate.m_z != next.m_z) {
-					if (intermediate.m_z > next.m_z)
-						route.push_back(convertCoordinateToID(next.incrementZ(m_dimension.m_z)));
-					else
-						route.push_back(convertCoordinateToID(next.decrementZ(m_dimension.m_z)));
-				}
-
-				// Route from intermediate to destination (using DOR)
-				while (dest.m_x != next.m_x) {
-					if (dest.m_x > next.m_x)
-						route.push_back(convertCoordinateToID(next.incrementX(m_dimension.m_x)));
-					else
-						route.push_back(convertCoordinateToID(next.decrementX(m_dimension.m_x)));
-				}
-				while (dest.m_y != next.m_y) {
-					if (dest.m_y > next.m_y)
-						route.push_back(convertCoordinateToID(next.incrementY(m_dimension.m_y)));
-					else
-						route.push_back(convertCoordinateToID(next.decrementY(m_dimension.m_y)));
-				}
-				while (dest.m_z != next.m_z) {
-					if (dest.m_z > next.m_z)
-						route.push_back(convertCoordinateToID(next.incrementZ(m_dimension.m_z)));
-					else
-						route.push_back(convertCoordinateToID(next.decrementZ(m_dimension.m_z)));
-				}
-
-				route.push_back(destination->m_terminalInterfaceID);
-				source->m_sourceRoutingTable.push_back(route);
-			}
-		}
-	}
-}
-
 // Odd-Even Adaptive routing
 // Uses odd-even turn model to avoid deadlocks
 void RegularNetwork::routeOddEven()
@@ -625,7 +583,7 @@ void RegularNetwork::routeOddEven()
 			Coordinate dest{ destination->m_terminalInterfaceIDTorus };
 			if (src != dest)
 			{
-				std::deque<int> route{};
+				std::vector<int> route{};
 				Coordinate next{ src };
 
 				// Odd-Even routing algorithm
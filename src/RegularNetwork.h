@@ -1,17 +1,42 @@
 #pragma once
 #include "Link.h"
 
+struct MemoryFootprint;
+class Arena;
+
 class RegularNetwork
 {
 public:
-	RegularNetwork();
+	RegularNetwork(); // routers, ports and links go into the arena of the network, and terminals once connected
 	~RegularNetwork(); // release routers, links, and terminals
 
 	void runOneCycle();
 	int getRouterNumber();
-	void connectTerminal(const int routerID,
-		TerminalInterface* terminalInterface);
+	// a terminal interface for the router, placed in the arena next to
+	// its link; owned by the network
+	TerminalInterface* connectTerminal(const int routerID);
 	void loadNetworkData();
+	// use routes generated by another network of the same topology and
+	// routing algorithm instead of generating them again
+	void loadNetworkData(const RoutingTables& routingTables);
+	// read routes from a mapped route table instead of keeping a copy
+	// per terminal interface; not owned, must outlive the network
+	void loadNetworkData(const RouteTable* routeTable);
+	RoutingTables getRoutingTables();
+	// bytes held by the routers and terminal interfaces, per subsystem
+	void measureMemory(MemoryFootprint& footprint) const;
+	void resetPortCounters();
+	// the counters of every router port as JSON, one row per port: the
+	// router, the router or terminal interface the port connects to, the
+	// flits sent and credit stalls toward it, and the mean number of flits
+	// buffered from it
+	bool writePortCounters(const std::string& filePath, const int cycles) const;
+	void resetSourceQueueStatistics();
+	// the source queue statistics of every terminal interface as JSON, one
+	// row per terminal interface: its ID, the packets it deferred and
+	// dropped while its source queue was full, and the cycles its source
+	// queue spent per depth bucket
+	bool writeSourceQueueStatistics(const std::string& filePath, const int cycles) const;
 
 private:
 	void generateRoutes();
@@ -25,9 +50,7 @@ private:
 	Coordinate convertIDToCoordinate(const int id);
 	int convertCoordinateToID(const Coordinate& coordinate);
 	void routeDOR();
-	void routeROMM(); // Randomized Oblivious Multi-phase Minimal
 	void routeMAD();  // Minimal Adaptive
-	void routeVAL();  // Valiant's Randomized Algorithm
 	void routeOddEven(); // Odd-Even Adaptive
 
 public:
@@ -37,4 +60,5 @@ private:
 	Coordinate m_dimension{g_x, g_y, g_z};
 	std::vector<Router*> m_routers{};
 	std::vector<Link*> m_links{};
+	Arena* m_arena{};
 };
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "ResultCache.h"
+#include <charconv>
+#include <filesystem>
+#include <thread>
+
+// 64-bit FNV-1a
+static unsigned long long hashText(const std::string& text)
+{
+	unsigned long long hash{ 0xCBF29CE484222325ULL };
+	for (unsigned char character : text)
+	{
+		hash ^= character;
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+ResultCache::ResultCache(const std::string& directory)
+	:
+	m_directory{ directory }
+{
+	std::filesystem::create_directories(m_directory);
+}
+
+std::string ResultCache::getKeyText(
+	const SimulationConfiguration& configuration)
+{
+	return "model_version = " + std::to_string(SOXIM_MODEL_VERSION) + "\n"
+		"seed = " + std::to_string(MAGIC_NUMBER) + "\n"
+		+ configuration.getCanonicalString();
+}
+
+std::string ResultCache::getKey(const SimulationConfiguration& configuration)
+{
+	char digits[17]{};
+	auto [end, error] { std::to_chars(std::begin(digits), std::end(digits),
+		hashText(getKeyText(configuration)), 16) };
+	return std::string(16 - (end - digits), '0') + std::string(digits, end);
+}
+
+std::string ResultCache::getFilePath(
+	const SimulationConfiguration& configuration)
+{
+	return (std::filesystem::path{ m_directory }
+		/ (getKey(configuration) + ".result")).string();
+}
+
+bool ResultCache::isReproducible()
+{
+	// the traffic, injection, routing and selection generators are all
+	// seeded from MAGIC_NUMBER, per terminal interface and router
+	return REPRODUCE_RANDOM;
+}
+
+bool ResultCache::load(const SimulationConfiguration& configuration,
+	Performance& performance)
+{
+	if (!isReproducible())
+		return false;
+	std::ifstream readResult(getFilePath(configuration), std::ios::in);
+	if (!readResult.is_open())
+		return false;
+
+	// the key text heads the file; compare it to rule out hash collisions
+	const std::string keyText{ getKeyText(configuration) };
+	std::string head(keyText.size(), '\0');
+	readResult.read(head.data(), static_cast<std::streamsize>(head.size()));
+	if (head != keyText)
+		return false;
+
+	std::string line{};
+	while (std::getline(readResult, line))
+	{
+		const size_t separator{ line.find(" = ") };
+		if (separator == std::string::npos)
+			continue;
+		const std::string name{ line.substr(0, separator) };
+		float* field{ name == "throughput" ? &performance.m_throughput
+			: name == "demand" ? &performance.m_demand
+			: name == "latency" ? &performance.m_latency
+			: name == "queueing_latency" ? &performance.m_queueingLatency
+			: name == "network_latency" ? &performance.m_networkLatency
+			: name == "serialisation_latency" ? &performance.m_serialisationLatency
+			: nullptr };
+		if (field)
+			*field = std::stof(line.substr(separator + 3));
+	}
+	return true;
+}
+
+void ResultCache::store(const SimulationConfiguration& configuration,
+	const Performance& performance)
+{
+	if (!isReproducible())
+		return;
+	const std::string filePath{ getFilePath(configuration) };
+	std::ostringstream temporaryPath{};
+	temporaryPath << filePath << ".tmp" << std::this_thread::get_id();
+	{
+		std::ofstream writeResult(temporaryPath.str(), std::ios::out);
+		if (!writeResult.is_open())
+		{
+			std::cerr << "Warning: Could not write result cache: "
+				<< filePath << "\n";
+			return;
+		}
+		writeResult << getKeyText(configuration)
+			<< "[result]\n"
+			<< "throughput = " << formatCanonicalFloat(performance.m_throughput) << "\n"
+			<< "demand = " << formatCanonicalFloat(performance.m_demand) << "\n"
+			<< "latency = " << formatCanonicalFloat(performance.m_latency) << "\n"
+			<< "queueing_latency = " << formatCanonicalFloat(performance.m_queueingLatency) << "\n"
+			<< "network_latency = " << formatCanonicalFloat(performance.m_networkLatency) << "\n"
+			<< "serialisation_latency = "
+			<< formatCanonicalFloat(performance.m_serialisationLatency) << "\n";
+	}
+	std::error_code error{};
+	std::filesystem::rename(temporaryPath.str(), filePath, error);
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "Simulation.h"
+
+// content-addressed store of simulation results; a result is filed under
+// the hash of the canonical configuration, the seed and the model version,
+// so any change to one of them misses the cache
+class ResultCache
+{
+public:
+	ResultCache(const std::string& directory);
+
+	std::string getKey(const SimulationConfiguration& configuration);
+	bool load(const SimulationConfiguration& configuration,
+		Performance& performance);
+	// safe to call from several threads; the file appears atomically
+	void store(const SimulationConfiguration& configuration,
+		const Performance& performance);
+	std::string getFilePath(const SimulationConfiguration& configuration);
+	// whether every random number of a run follows from the seed; a build
+	// without REPRODUCE_RANDOM neither loads nor stores results
+	static bool isReproducible();
+
+private:
+	std::string getKeyText(const SimulationConfiguration& configuration);
+
+private:
+	std::string m_directory{};
+};
@@ -0,0 +1,187 @@
+#include "RouteTable.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr char c_routeTableMagic[]{ "SOXRTB01" };
+
+static size_t alignHeader(const size_t size)
+{
+	return (size + 7) / 8 * 8;
+}
+
+// every route lies within the hops of its source, and the sources within
+// the hop array, so getRoute never reads past the mapping
+static bool isConsistent(const unsigned long long* sourceStarts,
+	const unsigned int* routeEnds, const size_t terminalNumber,
+	const size_t hopNumber)
+{
+	if (sourceStarts[terminalNumber] > hopNumber)
+		return false;
+	for (size_t source{}; source < terminalNumber; ++source)
+	{
+		if (sourceStarts[source] > sourceStarts[source + 1])
+			return false;
+		unsigned long long routeEnd{};
+		for (size_t destination{}; destination < terminalNumber; ++destination)
+		{
+			if (routeEnds[source * terminalNumber + destination] < routeEnd)
+				return false;
+			routeEnd = routeEnds[source * terminalNumber + destination];
+		}
+		if (sourceStarts[source] + routeEnd > sourceStarts[source + 1])
+			return false;
+	}
+	return true;
+}
+
+RouteTable::RouteTable(const std::string& filePath, const std::string& keyText)
+{
+	m_fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+	struct stat fileStatus {};
+	if (m_fileDescriptor < 0 || ::fstat(m_fileDescriptor, &fileStatus) != 0
+		|| static_cast<size_t>(fileStatus.st_size) < 16)
+		return; // not cached yet
+
+	m_mappingSize = static_cast<size_t>(fileStatus.st_size);
+	void* mapping{ ::mmap(nullptr, m_mappingSize, PROT_READ, MAP_SHARED,
+		m_fileDescriptor, 0) };
+	if (mapping == MAP_FAILED)
+	{
+		std::cerr << "Warning: Could not map route table: " << filePath << "\n";
+		return;
+	}
+	m_mapping = static_cast<const char*>(mapping);
+
+	unsigned int terminalNumber{}, keyLength{};
+	std::memcpy(&terminalNumber, m_mapping + 8, sizeof(terminalNumber));
+	std::memcpy(&keyLength, m_mapping + 12, sizeof(keyLength));
+	if (std::memcmp(m_mapping, c_routeTableMagic, 8) != 0
+		|| keyLength != keyText.size() || 16 + keyLength > m_mappingSize
+		|| std::memcmp(m_mapping + 16, keyText.data(), keyLength) != 0)
+		return; // another network, or another file format
+
+	// check the sizes before trusting any offset; a damaged file is
+	// regenerated like a missing one
+	const size_t n{ terminalNumber };
+	if (n > m_mappingSize / 4 / std::max<size_t>(n, 1))
+		return;
+	const size_t hopsOffset{ alignHeader(16 + keyLength) + (n + 1) * 8 + n * n * 4 };
+	if (hopsOffset > m_mappingSize)
+		return;
+	const unsigned long long* sourceStarts{ reinterpret_cast<const unsigned long long*>(
+		m_mapping + alignHeader(16 + keyLength)) };
+	const unsigned int* routeEnds{ reinterpret_cast<const unsigned int*>(sourceStarts + n + 1) };
+	if (!isConsistent(sourceStarts, routeEnds, n, (m_mappingSize - hopsOffset) / 4))
+		return;
+
+	m_terminalNumber = static_cast<int>(terminalNumber);
+	m_sourceStarts = sourceStarts;
+	m_routeEnds = routeEnds;
+	m_hops = reinterpret_cast<const int*>(m_mapping + hopsOffset);
+}
+
+RouteTable::~RouteTable()
+{
+	if (m_mapping)
+		::munmap(const_cast<char*>(m_mapping), m_mappingSize);
+	if (m_fileDescriptor >= 0)
+		::close(m_fileDescriptor);
+}
+
+bool RouteTable::isOpen() const
+{
+	return m_hops;
+}
+
+int RouteTable::getTerminalNumber() const
+{
+	return m_terminalNumber;
+}
+
+std::span<const int> RouteTable::getRoute(const int source,
+	const int destination) const
+{
+	if (source < 0 || source >= m_terminalNumber
+		|| destination < 0 || destination >= m_terminalNumber)
+		return {};
+	const size_t routes{ static_cast<size_t>(source) * m_terminalNumber };
+	const unsigned long long sourceStart{ m_sourceStarts[source] };
+	const unsigned long long begin{ sourceStart
+		+ (destination ? m_routeEnds[routes + destination - 1] : 0) };
+	const unsigned long long end{ sourceStart + m_routeEnds[routes + destination] };
+	return { m_hops + begin, m_hops + end };
+}
+
+bool RouteTable::write(const std::string& filePath, const std::string& keyText,
+	const RoutingTables& routingTables)
+{
+	const size_t n{ routingTables.size() };
+	std::vector<unsigned long long> sourceStarts(n + 1);
+	std::vector<unsigned int> routeEnds(n * n);
+	std::vector<int> hops{};
+	for (size_t source{}; source < n; ++source)
+	{
+		sourceStarts.at(source) = hops.size();
+		// the tables skip the source itself; place each route by the
+		// destination terminal interface ID at its back
+		std::vector<const std::vector<int>*> routes(n);
+		for (auto& route : routingTables.at(source))
+		{
+			const int destination{ route.empty() ? -1 : -route.back() - 1 };
+			if (destination >= 0
+				&& static_cast<size_t>(destination) < n)
+				routes.at(destination) = &route;
+		}
+		for (size_t destination{}; destination < n; ++destination)
+		{
+			if (routes.at(destination))
+				hops.insert(hops.end(), routes.at(destination)->begin(),
+					routes.at(destination)->end());
+			routeEnds.at(source * n + destination) =
+				static_cast<unsigned int>(hops.size() - sourceStarts.at(source));
+		}
+	}
+	sourceStarts.at(n) = hops.size();
+
+	std::ostringstream temporaryPath{};
+	temporaryPath << filePath << ".tmp" << std::this_thread::get_id();
+	{
+		std::ofstream writeTable(temporaryPath.str(),
+			std::ios::out | std::ios::binary);
+		if (!writeTable.is_open())
+		{
+			std::cerr << "Warning: Could not write route table: " << filePath << "\n";
+			return false;
+		}
+		const unsigned int terminalNumber{ static_cast<unsigned int>(n) };
+		const unsigned int keyLength{ static_cast<unsigned int>(keyText.size()) };
+		writeTable.write(c_routeTableMagic, 8);
+		writeTable.write(reinterpret_cast<const char*>(&terminalNumber), 4);
+		writeTable.write(reinterpret_cast<const char*>(&keyLength), 4);
+		writeTable.write(keyText.data(), keyLength);
+		const char pad[8]{};
+		writeTable.write(pad, alignHeader(16 + keyLength) - 16 - keyLength);
+		writeTable.write(reinterpret_cast<const char*>(sourceStarts.data()),
+			sourceStarts.size() * sizeof(unsigned long long));
+		writeTable.write(reinterpret_cast<const char*>(routeEnds.data()),
+			routeEnds.size() * sizeof(unsigned int));
+		writeTable.write(reinterpret_cast<const char*>(hops.data()),
+			hops.size() * sizeof(int));
+	}
+	std::error_code error{};
+	if (std::filesystem::file_size(temporaryPath.str(), error) != alignHeader(
+		16 + keyText.size()) + (n + 1) * 8 + n * n * 4 + hops.size() * 4)
+	{
+		std::cerr << "Warning: Could not write route table: " << filePath << "\n";
+		std::filesystem::remove(temporaryPath.str(), error);
+		return false;
+	}
+	std::filesystem::rename(temporaryPath.str(), filePath, error);
+	return !error;
+}
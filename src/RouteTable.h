@@ -0,0 +1,52 @@
+#pragma once
+#include "DataStructures.h"
+
+// source routing tables of all terminal interfaces, in terminal order
+using RoutingTables = std::vector<std::vector<std::vector<int>>>;
+
+// Route table file (.routes): the source routes of a whole network
+//
+// file   := "SOXRTB01" u32(terminalNumber) u32(keyLength) key pad
+//           u64(sourceStart)[terminalNumber + 1]
+//           u32(routeEnd)[terminalNumber * terminalNumber]
+//           i32(hop)*
+//
+// Little-endian, pad aligns to 8 bytes. The hops of source s start at
+// sourceStart[s]; routeEnd[s * terminalNumber + d] is the end of the
+// route to destination d, relative to sourceStart[s], and the route
+// begins where the one to d - 1 ends. A route lists the routers after
+// the source and ends with the destination terminal interface ID, as in
+// TerminalInterface::m_sourceRoutingTable; the route to itself is empty.
+//
+// The key text identifies the network the routes belong to; a file
+// whose key does not match is not used.
+
+// memory-maps a route table file; read-only, so one table can be shared
+// by networks on several threads
+class RouteTable
+{
+public:
+	RouteTable(const std::string& filePath, const std::string& keyText);
+	~RouteTable();
+	RouteTable(const RouteTable&) = delete;
+	RouteTable& operator=(const RouteTable&) = delete;
+
+	bool isOpen() const;
+	int getTerminalNumber() const;
+	// source and destination are node numbers from 0, node n is
+	// terminal interface -n-1; the hops stay in the mapping
+	std::span<const int> getRoute(const int source, const int destination) const;
+
+	// write the routes atomically, so readers see a whole file or none
+	static bool write(const std::string& filePath, const std::string& keyText,
+		const RoutingTables& routingTables);
+
+private:
+	int m_fileDescriptor{ -1 };
+	const char* m_mapping{};
+	size_t m_mappingSize{};
+	int m_terminalNumber{};
+	const unsigned long long* m_sourceStarts{};
+	const unsigned int* m_routeEnds{};
+	const int* m_hops{};
+};
@@ -1,33 +1,70 @@
 #include "Router.h"
+#include "Profiler.h"
+#include "MemoryFootprint.h"
+#include "FlitTracer.h"
+#include "Arena.h"
+#include <bit>
+#include <cassert>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 Router::Router(const int routerID)
 	:
-	m_routerID{ routerID } {
+	m_routerID{ routerID },
+	m_routingFunction{ routerID }
+{
+#if REPRODUCE_RANDOM
+	m_selectionGenerator.seed(MAGIC_NUMBER + routerID);
+#else
+	m_selectionGenerator.seed(std::random_device{}());
+#endif
 }
 
 Router::~Router()
 {
 	for (auto& port : m_ports)
 	{
-		delete port;
+		Arena::destroy(port);
 		port = nullptr;
 	}
 }
 
 void Router::runOneCycle()
 {
-	receiveFlit();
-	receiveCredit();
-	computeRoute();
-	allocateVirtualChannel();
-	traverseSwitch();
-	allocateSwitch();
+	{
+		PROFILE_SCOPE(ProfilePhase::RECEIVE_FLIT);
+		receiveFlit();
+	}
+	{
+		PROFILE_SCOPE(ProfilePhase::RECEIVE_CREDIT);
+		receiveCredit();
+	}
+	{
+		PROFILE_SCOPE(ProfilePhase::COMPUTE_ROUTE);
+		computeRoute();
+	}
+	{
+		PROFILE_SCOPE(ProfilePhase::ALLOCATE_VIRTUAL_CHANNEL);
+		allocateVirtualChannel();
+	}
+	{
+		PROFILE_SCOPE(ProfilePhase::TRAVERSE_SWITCH);
+		traverseSwitch();
+	}
+	{
+		PROFILE_SCOPE(ProfilePhase::ALLOCATE_SWITCH);
+		allocateSwitch();
+	}
+	enableVirtualChannels();
 	debug();
 }
 
 Port* Router::createPort(const int portID)
 {
-	Port* port{ new Port{portID} };
+	Port* port{ Arena::create<Port>(portID) };
 	for (int i{}; i < g_virtualChannelNumber; ++i)
 		port->m_controlFields.at(i).m_routedOutputPort = m_routerID;
 	m_ports.push_back(port);
@@ -63,6 +100,130 @@ void Router::resetVirtualChannelEnable()
 		for (auto& controlField : port->m_controlFields)
 			controlField.m_enable = true;
 	}
+	packVirtualChannelStates();
+}
+
+void Router::packVirtualChannelStates()
+{
+	const size_t size{ (m_ports.size() * g_virtualChannelNumber + 63) / 64 * 64 };
+	if (m_packedStates.size() != size)
+	{
+		m_packedStates.assign(size, 0xff);
+		m_candidates.assign(size / 64, 0);
+	}
+	for (size_t i{}; i < m_ports.size(); ++i)
+	{
+		for (int j{}; j < g_virtualChannelNumber; ++j)
+			packVirtualChannel(static_cast<int>(i), j);
+	}
+}
+
+void Router::disableVirtualChannel(const int portIndex, const int virtualChannel)
+{
+	m_ports[portIndex]->m_controlFields[virtualChannel].m_enable = false;
+	packVirtualChannel(portIndex, virtualChannel);
+	m_disabledVirtualChannels.push_back(portIndex * g_virtualChannelNumber + virtualChannel);
+}
+
+void Router::enableVirtualChannels()
+{
+	for (const int packedIndex : m_disabledVirtualChannels)
+	{
+		const int portIndex{ packedIndex / g_virtualChannelNumber };
+		const int virtualChannel{ packedIndex % g_virtualChannelNumber };
+		m_ports[portIndex]->m_controlFields[virtualChannel].m_enable = true;
+		packVirtualChannel(portIndex, virtualChannel);
+	}
+	m_disabledVirtualChannels.clear();
+}
+
+void Router::setVirtualChannelState(const int portIndex, const int virtualChannel,
+	const VirtualChannelState state)
+{
+	m_ports[portIndex]->m_controlFields[virtualChannel].m_virtualChannelState = state;
+	packVirtualChannel(portIndex, virtualChannel);
+}
+
+void Router::packVirtualChannel(const int portIndex, const int virtualChannel)
+{
+	const ControlField& controlField{ m_ports[portIndex]->m_controlFields[virtualChannel] };
+	m_packedStates[portIndex * g_virtualChannelNumber + virtualChannel] =
+		static_cast<unsigned char>(controlField.m_virtualChannelState)
+		| (controlField.m_enable ? 0x00 : 0x80);
+}
+
+// bit i is set if byte i of the 64-byte block equals the value
+static unsigned long long compareBlock(const unsigned char* block, const unsigned char value)
+{
+#if defined(__AVX2__)
+	const __m256i key{ _mm256_set1_epi8(static_cast<char>(value)) };
+	const unsigned int low{ static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+		_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block)), key))) };
+	const unsigned int high{ static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+		_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32)), key))) };
+	return low | static_cast<unsigned long long>(high) << 32;
+#elif defined(__SSE2__)
+	const __m128i key{ _mm_set1_epi8(static_cast<char>(value)) };
+	unsigned long long mask{};
+	for (int i{}; i < 4; ++i)
+		mask |= static_cast<unsigned long long>(static_cast<unsigned int>(_mm_movemask_epi8(
+			_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16)),
+				key)))) << (i * 16);
+	return mask;
+#else
+	unsigned long long mask{};
+	for (int i{}; i < 64; ++i)
+		mask |= static_cast<unsigned long long>(block[i] == value) << i;
+	return mask;
+#endif
+}
+
+bool Router::findCandidates(const VirtualChannelState state)
+{
+#ifndef NDEBUG
+	// a state or enable written past setVirtualChannelState and
+	// disableVirtualChannel leaves its packed byte stale
+	for (size_t i{}; i < m_ports.size(); ++i)
+	{
+		for (int j{}; j < g_virtualChannelNumber; ++j)
+		{
+			const unsigned char packed{ m_packedStates[i * g_virtualChannelNumber + j] };
+			packVirtualChannel(static_cast<int>(i), j);
+			assert(packed == m_packedStates[i * g_virtualChannelNumber + j]);
+		}
+	}
+#endif
+	unsigned long long found{};
+	for (size_t i{}; i < m_candidates.size(); ++i)
+	{
+		m_candidates[i] = compareBlock(&m_packedStates[i * 64],
+			static_cast<unsigned char>(state));
+		found |= m_candidates[i];
+	}
+	return found;
+}
+
+bool Router::isCandidate(const int portIndex, const int virtualChannel) const
+{
+	const int index{ portIndex * g_virtualChannelNumber + virtualChannel };
+	return m_candidates[index / 64] >> (index % 64) & 1;
+}
+
+void Router::measureMemory(MemoryFootprint& footprint) const
+{
+	footprint[MemorySubsystem::VIRTUAL_CHANNELS] += getHeapBytes(m_packedStates)
+		+ getHeapBytes(m_candidates);
+	for (auto& port : m_ports)
+	{
+		footprint[MemorySubsystem::VIRTUAL_CHANNELS] += sizeof(Port);
+		footprint.addPort(*port);
+	}
+}
+
+void Router::resetCounters()
+{
+	for (auto& port : m_ports)
+		port->m_counters = {};
 }
 
 void Router::initiatePriorities()
@@ -77,26 +238,33 @@ void Router::initiatePriorities()
 			m_priorityTableSA.push_back({ static_cast<int>(i), j });
 		}
 	}
+	packVirtualChannelStates();
 }
 
 void Router::receiveFlit()
 {
-	for (auto& port : m_ports)
+	for (size_t portIndex{}; portIndex < m_ports.size(); ++portIndex)
 	{
+		Port* port{ m_ports[portIndex] };
 		if (port->m_inputRegister.m_flitEnable)
 		{
 			Flit flit{ port->m_inputRegister.popfrontFlit() };
+			FlitTracer::trace(flit, FlitTraceEvent::ARRIVE, m_routerID,
+				port->m_portID, flit.m_flitVirtualChannel);
 			port->m_virtualChannels.
 				at(flit.m_flitVirtualChannel).push_back(flit);
-			if (port->m_controlFields.at(flit.m_flitVirtualChannel)
-				.m_virtualChannelState == VirtualChannelState::I)
-				port->m_controlFields.at(flit.m_flitVirtualChannel)
-				.m_virtualChannelState = VirtualChannelState::R;
-			if (port->m_controlFields.at(flit.m_flitVirtualChannel)
-				.m_virtualChannelState == VirtualChannelState::F)
-				port->m_controlFields.at(flit.m_flitVirtualChannel)
-				.m_virtualChannelState = VirtualChannelState::A;
+			const VirtualChannelState state{ port->m_controlFields
+				.at(flit.m_flitVirtualChannel).m_virtualChannelState };
+			if (state == VirtualChannelState::I)
+				setVirtualChannelState(static_cast<int>(portIndex),
+					flit.m_flitVirtualChannel, VirtualChannelState::R);
+			else if (state == VirtualChannelState::F)
+				setVirtualChannelState(static_cast<int>(portIndex),
+					flit.m_flitVirtualChannel, VirtualChannelState::A);
 		}
+		if (g_linkCounters)
+			for (auto& virtualChannel : port->m_virtualChannels)
+				port->m_counters.m_occupancy += virtualChannel.size();
 	}
 }
 
@@ -122,83 +290,135 @@ void Router::receiveCredit()
 
 void Router::computeRoute()
 {
-	for (auto& port : m_ports)
+	if (!findCandidates(VirtualChannelState::R))
+		return;
+	// in port and VC order, as the packed states are
+	for (size_t word{}; word < m_candidates.size(); ++word)
 	{
-		for (int i{}; i < g_virtualChannelNumber; ++i)
+		for (unsigned long long bits{ m_candidates[word] }; bits; bits &= bits - 1)
 		{
-			if (port->m_controlFields.at(i).m_virtualChannelState
-				== VirtualChannelState::R &&
-				port->m_controlFields.at(i).m_enable
-				== true)
+			const int index{ static_cast<int>(word * 64) + std::countr_zero(bits) };
+			const int portIndex{ index / g_virtualChannelNumber };
+			const int i{ index % g_virtualChannelNumber };
+			Port* port{ m_ports[portIndex] };
+			if (m_routingFunction.isAdaptive())
 			{
 				port->m_controlFields.at(i).m_routedOutputPort =
-					port->m_virtualChannels.at(i).front()
-					.m_route.front();
-				// do not pop front the last element in the route, 
-				// it is the destination
-				if (port->m_virtualChannels.at(i).front()
-					.m_route.front() >= 0)
-					port->m_virtualChannels.at(i).front()
-					.m_route.pop_front();
-				port->m_controlFields.at(i).m_virtualChannelState =
-					VirtualChannelState::V;
-				port->m_controlFields.at(i).m_enable = false;
+					selectOutputPort(port->m_virtualChannels.at(i).front());
+				if (m_routingFunction.hasEscapeChannels())
+					port->m_controlFields.at(i).m_escapeOutputPort =
+					m_routingFunction.computeEscapePort(
+						port->m_virtualChannels.at(i).front());
 			}
+			else if (m_routingFunction.isDistributed())
+				port->m_controlFields.at(i).m_routedOutputPort =
+				m_routingFunction.computeOutputPort(
+					port->m_virtualChannels.at(i).front());
+			else
+			{
+				Flit& head{ port->m_virtualChannels.at(i).front() };
+				port->m_controlFields.at(i).m_routedOutputPort = *head.m_route;
+				// do not step past the last hop in the route, it is the
+				// destination
+				if (*head.m_route >= 0)
+					++head.m_route;
+			}
+			FlitTracer::trace(port->m_virtualChannels.at(i).front(),
+				FlitTraceEvent::ROUTE, m_routerID,
+				port->m_controlFields.at(i).m_routedOutputPort, i);
+			setVirtualChannelState(portIndex, i, VirtualChannelState::V);
+			disableVirtualChannel(portIndex, i);
 		}
 	}
 }
 
+int Router::selectOutputPort(const Flit& head)
+{
+	m_routingFunction.computeOutputPorts(head, m_outputPorts);
+	if (m_outputPorts.size() == 1)
+		return m_outputPorts.front();
+	if (m_routingFunction.getSelectionFunction() == SelectionFunction::RANDOM)
+		return m_outputPorts.at(std::uniform_int_distribution<size_t>(
+			0, m_outputPorts.size() - 1)(m_selectionGenerator));
+
+	int selectedPort{ m_outputPorts.front() };
+	int bestScore{}, bestFreeVirtualChannels{};
+	bool first{ true };
+	for (auto& outputPort : m_outputPorts)
+	{
+		int credits{}, freeVirtualChannels{}, queuedFlits{};
+		for (auto& port : m_ports)
+		{
+			if (port->m_portID == outputPort)
+			{
+				for (int i{}; i < g_virtualChannelNumber; ++i)
+				{
+					if (!m_routingFunction.admitsVirtualChannel(head, i))
+						continue;
+					credits += port->m_controlFields.at(i).m_credit;
+					if (port->m_controlFields.at(i).m_downstreamVirtualChannelState
+						== VirtualChannelState::I)
+						++freeVirtualChannels;
+				}
+			}
+			// flits here already heading for the same output port
+			if (m_routingFunction.getSelectionFunction()
+				== SelectionFunction::LOCAL_NEIGHBOUR)
+			{
+				for (int i{}; i < g_virtualChannelNumber; ++i)
+				{
+					if (port->m_controlFields.at(i).m_routedOutputPort == outputPort
+						&& (port->m_controlFields.at(i).m_virtualChannelState
+							== VirtualChannelState::V
+							|| port->m_controlFields.at(i).m_virtualChannelState
+							== VirtualChannelState::A))
+						queuedFlits += static_cast<int>(
+							port->m_virtualChannels.at(i).size());
+				}
+			}
+		}
+		// equal scores go to more free VCs, then to the earlier port
+		const int score{ credits - queuedFlits };
+		if (first || score > bestScore
+			|| (score == bestScore && freeVirtualChannels > bestFreeVirtualChannels))
+		{
+			selectedPort = outputPort;
+			bestScore = score;
+			bestFreeVirtualChannels = freeVirtualChannels;
+			first = false;
+		}
+	}
+	return selectedPort;
+}
+
 void Router::allocateVirtualChannel()
 {
+	if (!findCandidates(VirtualChannelState::V))
+		return;
 	// round-robin: record arbitration winners
 	std::vector<PriorityTableEntry> winners{};
 
 	// check by priority table VA
 	for (auto& entry : m_priorityTableVA)
 	{
-		if (m_ports.at(entry.m_portIndex)
-			->m_controlFields.at(entry.m_virtualChannelIndex)
-			.m_virtualChannelState == VirtualChannelState::V &&
-			m_ports.at(entry.m_portIndex)
-			->m_controlFields.at(entry.m_virtualChannelIndex)
-			.m_enable == true)
+		if (isCandidate(entry.m_portIndex, entry.m_virtualChannelIndex))
 		{
-			for (auto& port : m_ports)
+			ControlField& input{ m_ports.at(entry.m_portIndex)
+				->m_controlFields.at(entry.m_virtualChannelIndex) };
+			// Duato: the escape VCs of the DOR port if no adaptive VC is free
+			if (allocateDownstreamVirtualChannel(entry, input.m_routedOutputPort, false)
+				|| (m_routingFunction.hasEscapeChannels()
+					&& allocateDownstreamVirtualChannel(entry, input.m_escapeOutputPort, true)))
 			{
-				// find the output port that is routed
-				if (m_ports.at(entry.m_portIndex)
-					->m_controlFields.at(entry.m_virtualChannelIndex)
-					.m_routedOutputPort == port->m_portID)
-				{
-					for (int i{}; i < g_virtualChannelNumber; ++i)
-					{
-						// find the Idle downstream virtual channel
-						if (port->m_controlFields.at(i)
-							.m_downstreamVirtualChannelState
-							== VirtualChannelState::I)
-						{
-							// change input
-							m_ports.at(entry.m_portIndex)->m_controlFields
-								.at(entry.m_virtualChannelIndex)
-								.m_allocatedVirtualChannel = i;
-							m_ports.at(entry.m_portIndex)->m_controlFields
-								.at(entry.m_virtualChannelIndex)
-								.m_virtualChannelState
-								= VirtualChannelState::A;
-							// change output
-							port->m_controlFields.at(i)
-								.m_downstreamVirtualChannelState
-								= VirtualChannelState::A;
-							// round-robin: push entry into winners
-							winners.push_back(entry);
-							m_ports.at(entry.m_portIndex)->m_controlFields
-								.at(entry.m_virtualChannelIndex)
-								.m_enable = false;
-							break;
-						}
-					}
-					break;
-				}
+				FlitTracer::trace(m_ports.at(entry.m_portIndex)
+					->m_virtualChannels.at(entry.m_virtualChannelIndex).front(),
+					FlitTraceEvent::VA_GRANT, m_routerID, input.m_routedOutputPort,
+					input.m_allocatedVirtualChannel);
+				setVirtualChannelState(entry.m_portIndex, entry.m_virtualChannelIndex,
+					VirtualChannelState::A);
+				// round-robin: push entry into winners
+				winners.push_back(entry);
+				disableVirtualChannel(entry.m_portIndex, entry.m_virtualChannelIndex);
 			}
 		}
 	}
@@ -211,6 +431,46 @@ void Router::allocateVirtualChannel()
 	}
 }
 
+bool Router::allocateDownstreamVirtualChannel(const PriorityTableEntry& entry,
+	const int outputPortID, const bool escape)
+{
+	Port* inputPort{ m_ports.at(entry.m_portIndex) };
+	const Flit& head{ inputPort->m_virtualChannels.at(entry.m_virtualChannelIndex).front() };
+	for (auto& port : m_ports)
+	{
+		// find the output port that is routed
+		if (port->m_portID != outputPortID)
+			continue;
+		const int datelineClass{ escape
+			? m_routingFunction.computeEscapeClass(inputPort->m_portID,
+				entry.m_virtualChannelIndex, outputPortID)
+			: m_routingFunction.computeDatelineClass(head, inputPort->m_portID,
+				entry.m_virtualChannelIndex, outputPortID) };
+		for (int i{}; i < g_virtualChannelNumber; ++i)
+		{
+			// find the Idle downstream virtual channel
+			// the packet may use
+			if (port->m_controlFields.at(i).m_downstreamVirtualChannelState
+				== VirtualChannelState::I &&
+				(escape ? m_routingFunction.admitsEscapeVirtualChannel(i, datelineClass)
+					: m_routingFunction.admitsVirtualChannel(head, i, datelineClass)))
+			{
+				// change input
+				ControlField& input{ inputPort->m_controlFields
+					.at(entry.m_virtualChannelIndex) };
+				input.m_routedOutputPort = outputPortID;
+				input.m_allocatedVirtualChannel = i;
+				// change output
+				port->m_controlFields.at(i).m_downstreamVirtualChannelState
+					= VirtualChannelState::A;
+				return true;
+			}
+		}
+		return false;
+	}
+	return false;
+}
+
 bool Router::checkConflict(const int inputPortIndex,
 	const int outputPortIndex)
 {
@@ -225,18 +485,15 @@ bool Router::checkConflict(const int inputPortIndex,
 
 void Router::allocateSwitch()
 {
+	if (!findCandidates(VirtualChannelState::A))
+		return;
 	// round-robin: record arbitration winners
 	std::vector<PriorityTableEntry> winners{};
 
 	// check by priority table SA
 	for (auto& entry : m_priorityTableSA)
 	{
-		if (m_ports.at(entry.m_portIndex)
-			->m_controlFields.at(entry.m_virtualChannelIndex)
-			.m_virtualChannelState == VirtualChannelState::A &&
-			m_ports.at(entry.m_portIndex)
-			->m_controlFields.at(entry.m_virtualChannelIndex)
-			.m_enable == true)
+		if (isCandidate(entry.m_portIndex, entry.m_virtualChannelIndex))
 		{
 			// i is output port index
 	for (size_t i{}; i < m_ports.size(); ++i)
@@ -259,6 +516,11 @@ void Router::allocateSwitch()
 					// if no conflict, 
 					// add this connection into crossbar
 					if (checkConflict(entry.m_portIndex, i))
+					{
+						FlitTracer::trace(m_ports.at(entry.m_portIndex)
+							->m_virtualChannels.at(entry.m_virtualChannelIndex).front(),
+							FlitTraceEvent::SA_GRANT, m_routerID, m_ports.at(i)->m_portID,
+							entry.m_virtualChannelIndex);
 						m_crossbar.push_back({
 									entry.m_portIndex,
 									entry.m_virtualChannelIndex,
@@ -267,13 +529,18 @@ void Router::allocateSwitch()
 							->m_controlFields
 							.at(entry.m_virtualChannelIndex)
 							.m_allocatedVirtualChannel });
+					}
 					// round-robin: push entry into winners
 					winners.push_back(entry);
-					m_ports.at(entry.m_portIndex)
-						->m_controlFields.at(entry.m_virtualChannelIndex)
-						.m_enable = false;
+					disableVirtualChannel(entry.m_portIndex, entry.m_virtualChannelIndex);
 					break;
 				}
+				// the routed output port has no credits left downstream
+				if (m_ports.at(entry.m_portIndex)
+					->m_controlFields.at(entry.m_virtualChannelIndex)
+					.m_routedOutputPort
+					== m_ports.at(i)->m_portID)
+					m_ports.at(i)->m_counters.m_creditStalls++;
 			}
 		}
 	}
@@ -300,6 +567,10 @@ void Router::traverseSwitch()
 		// push flit into output port output register
 		m_ports.at(connection.m_outputPortIndex)->m_outputRegister
 			.pushbackFlit(flit);
+		m_ports.at(connection.m_outputPortIndex)->m_counters.m_flits++;
+		FlitTracer::trace(flit, FlitTraceEvent::DEPART, m_routerID,
+			m_ports.at(connection.m_outputPortIndex)->m_portID,
+			connection.m_outputVirtualChannelIndex);
 		// decrement output port virtual channel credit
 		// do not do this if output port is terminal port
 		if (m_ports.at(connection.m_outputPortIndex)->m_portID >= 0)
@@ -323,9 +594,8 @@ void Router::traverseSwitch()
 		if (m_ports.at(connection.m_inputPortIndex)
 			->m_virtualChannels.at(connection.m_inputVirtualChannelIndex)
 			.empty())
-			m_ports.at(connection.m_inputPortIndex)
-			->m_controlFields.at(connection.m_inputVirtualChannelIndex)
-			.m_virtualChannelState = VirtualChannelState::F;
+			setVirtualChannelState(connection.m_inputPortIndex,
+				connection.m_inputVirtualChannelIndex, VirtualChannelState::F);
 		// create a credit with input port virtual channel
 		// credit should have a bit telling if it is tail flit
 		// if it is, downstream virtual channel state will be reset to I
@@ -338,9 +608,8 @@ void Router::traverseSwitch()
 		// reset input port virtual channel input fields
 		if (flit.m_flitType == FlitType::T)
 		{
-			m_ports.at(connection.m_inputPortIndex)
-				->m_controlFields.at(connection.m_inputVirtualChannelIndex)
-				.m_virtualChannelState = VirtualChannelState::I;
+			setVirtualChannelState(connection.m_inputPortIndex,
+				connection.m_inputVirtualChannelIndex, VirtualChannelState::I);
 			m_ports.at(connection.m_inputPortIndex)
 				->m_controlFields.at(connection.m_inputVirtualChannelIndex)
 				.m_routedOutputPort = m_routerID;
@@ -1,6 +1,9 @@
 #pragma once
 #include "DataStructures.h"
 #include "Port.h"
+#include "RoutingFunction.h"
+
+struct MemoryFootprint;
 
 class Router
 {
@@ -11,8 +14,13 @@ public:
 
 	void runOneCycle();
 	Port* createPort(const int portID);
+	// for a router run on its own; in a network the links latch the
+	// register enables, and runOneCycle enables again at its end the VCs
+	// it disabled, so a VC disabled by the caller stays disabled
 	void updateEnable();
 	void initiatePriorities();
+	void resetCounters(); // of all ports
+	void measureMemory(MemoryFootprint& footprint) const;
 
 private:
 	void updatePortInputRegisterEnable(); // update port input registers enable
@@ -21,13 +29,33 @@ private:
 	void receiveCredit();
 
 	void computeRoute();
+	// adaptive routing: the admissible output port the selection function
+	// prefers, from the credits and free virtual channels downstream
+	int selectOutputPort(const Flit& head);
 	void allocateVirtualChannel();
+	// grant an idle downstream VC of an output port to an input VC
+	bool allocateDownstreamVirtualChannel(const PriorityTableEntry& entry,
+		const int outputPortID, const bool escape);
 	void allocateSwitch();
 	void traverseSwitch();
 
 	bool checkConflict(const int inputPort,
 		const int outputPort);
 
+	// a byte per input VC: its state, with the top bit set while disabled;
+	// all of them are packed at setup, then each one where it changes, so
+	// states are set and VCs disabled through these only
+	void packVirtualChannelStates();
+	void packVirtualChannel(const int portIndex, const int virtualChannel);
+	void setVirtualChannelState(const int portIndex, const int virtualChannel,
+		const VirtualChannelState state);
+	// a VC that has gone through a stage skips the later ones this cycle
+	void disableVirtualChannel(const int portIndex, const int virtualChannel);
+	void enableVirtualChannels(); // the ones disabled this cycle
+	// mark the enabled input VCs in the state; false if there are none
+	bool findCandidates(const VirtualChannelState state);
+	bool isCandidate(const int portIndex, const int virtualChannel) const;
+
 	void debug();
 
 public:
@@ -38,7 +66,16 @@ private:
 	std::vector<Connection> m_crossbar{};
 	std::vector<PriorityTableEntry> m_priorityTableVA{}; // priority for VA
 	std::vector<PriorityTableEntry> m_priorityTableSA{}; // priority for SA
+	// packed input VC states, port by port, padded with 0xff to 64 bytes
+	std::vector<unsigned char> m_packedStates{};
+	std::vector<unsigned long long> m_candidates{}; // a bit per packed VC
+	std::vector<int> m_disabledVirtualChannels{}; // packed indices, this cycle
+	RoutingFunction m_routingFunction{}; // routes head flits in distributed routing
+	std::vector<int> m_outputPorts{}; // admissible output ports of adaptive routing
+	std::mt19937 m_selectionGenerator{}; // random selection function
 
 	// Friend classes for unit testing
 	friend class RouterTest;
+	// Friend classes for benchmarking
+	friend class RouterBenchmark;
 };
\ No newline at end of file
@@ -0,0 +1,398 @@
+#include "RoutingFunction.h"
+#include <cmath>
+
+static RoutingAlgorithm parseRoutingAlgorithm(const std::string_view algorithm)
+{
+	if (algorithm == "DOR")
+		return RoutingAlgorithm::DOR;
+	if (algorithm == "O1TURN")
+		return RoutingAlgorithm::O1TURN;
+	if (algorithm == "MAD")
+		return RoutingAlgorithm::MAD;
+	if (algorithm == "ODD_EVEN")
+		return RoutingAlgorithm::ODD_EVEN;
+	if (algorithm == "VAL")
+		return RoutingAlgorithm::VAL;
+	if (algorithm == "ROMM")
+		return RoutingAlgorithm::ROMM;
+	return RoutingAlgorithm::NONE;
+}
+
+static SelectionFunction parseSelectionFunction(const std::string_view selection)
+{
+	if (selection == "max_credit")
+		return SelectionFunction::MAX_CREDIT;
+	if (selection == "random")
+		return SelectionFunction::RANDOM;
+	if (selection == "local_neighbour")
+		return SelectionFunction::LOCAL_NEIGHBOUR;
+	return SelectionFunction::NONE;
+}
+
+// MAD and ODD_EVEN adapt to congestion once a selection function is set
+bool RoutingFunction::isAdaptiveRouting()
+{
+	return (g_routingAlgorithm == "MAD" || g_routingAlgorithm == "ODD_EVEN")
+		&& parseSelectionFunction(g_selectionFunction) != SelectionFunction::NONE;
+}
+
+RoutingFunction::RoutingFunction(const int routerID)
+	:
+	m_dimension{ g_x, g_y, g_z },
+	m_torus{ g_shape == "TORUS" }
+{
+	const RoutingAlgorithm algorithm{ parseRoutingAlgorithm(g_routingAlgorithm) };
+	if (algorithm == RoutingAlgorithm::O1TURN || algorithm == RoutingAlgorithm::VAL
+		|| algorithm == RoutingAlgorithm::ROMM)
+		m_phaseNumber = 2;
+	// only these take the wrap-around links, source routed or not; without
+	// enough virtual channels for both, the phases win
+	if (m_torus && m_dimension.getProduct() > 0
+		&& algorithm != RoutingAlgorithm::MAD && algorithm != RoutingAlgorithm::ODD_EVEN
+		&& algorithm != RoutingAlgorithm::NONE
+		&& g_virtualChannelNumber >= 2 * m_phaseNumber)
+		m_datelineClassNumber = 2;
+	m_partitionNumber = m_phaseNumber * m_datelineClassNumber;
+	if (g_virtualChannelNumber < m_partitionNumber)
+		m_partitionNumber = 1;
+
+	if (m_datelineClassNumber == 2 || isDistributedRouting())
+		m_coordinate = convertIDToCoordinate(routerID);
+	if (!isDistributedRouting())
+		return;
+	m_algorithm = algorithm;
+	if (isAdaptiveRouting())
+		m_selectionFunction = parseSelectionFunction(g_selectionFunction);
+	// a single escape VC on a torus would take the wrap-around links
+	// without dateline classes; SimulationConfiguration::validate rejects it
+	if (isAdaptive() && m_algorithm == RoutingAlgorithm::MAD
+		&& g_escapeVirtualChannelNumber >= (m_torus ? 2 : 1)
+		&& g_escapeVirtualChannelNumber < g_virtualChannelNumber)
+	{
+		m_escapeNumber = g_escapeVirtualChannelNumber;
+		if (m_torus)
+			m_escapeClassNumber = 2;
+	}
+}
+
+bool RoutingFunction::isDistributed() const
+{
+	return m_algorithm != RoutingAlgorithm::NONE;
+}
+
+bool RoutingFunction::isDistributedRouting()
+{
+	// O1TURN, VAL and ROMM choose per packet and adaptive routing per hop,
+	// so they have no table form
+	return parseRoutingAlgorithm(g_routingAlgorithm) != RoutingAlgorithm::NONE
+		&& (g_routingMode == "distributed" || g_routingAlgorithm == "O1TURN"
+			|| g_routingAlgorithm == "VAL" || g_routingAlgorithm == "ROMM"
+			|| isAdaptiveRouting());
+}
+
+bool RoutingFunction::isAdaptive() const
+{
+	return m_selectionFunction != SelectionFunction::NONE;
+}
+
+SelectionFunction RoutingFunction::getSelectionFunction() const
+{
+	return m_selectionFunction;
+}
+
+void RoutingFunction::preparePacket(Flit& head, std::mt19937& generator) const
+{
+	head.m_routingPhase = 0;
+	head.m_intermediate = -1;
+	if (m_algorithm == RoutingAlgorithm::O1TURN)
+		head.m_routingPhase = std::bernoulli_distribution{ 0.5 }(generator);
+	else if (m_algorithm == RoutingAlgorithm::VAL)
+	{
+		// any router but the source and the destination, if there is one
+		const int routerNumber{ m_dimension.m_x * m_dimension.m_y * m_dimension.m_z };
+		const int source{ convertCoordinateToID(m_coordinate) };
+		const int destination{ -head.m_destination - 1 };
+		if (routerNumber <= 2)
+			return;
+		std::uniform_int_distribution<> distRouter(0, routerNumber - 1);
+		do {
+			head.m_intermediate = distRouter(generator);
+		} while (head.m_intermediate == source || head.m_intermediate == destination);
+	}
+	else if (m_algorithm == RoutingAlgorithm::ROMM)
+	{
+		// inside the box spanned by the source and the destination, so
+		// both phases together stay minimal
+		const Coordinate destination{
+			convertIDToCoordinate(-head.m_destination - 1) };
+		head.m_intermediate = convertCoordinateToID({
+			chooseBetween(m_coordinate.m_x, destination.m_x, m_dimension.m_x, generator),
+			chooseBetween(m_coordinate.m_y, destination.m_y, m_dimension.m_y, generator),
+			chooseBetween(m_coordinate.m_z, destination.m_z, m_dimension.m_z, generator) });
+	}
+}
+
+int RoutingFunction::computeOutputPort(Flit& head) const
+{
+	// the two-phase algorithms head for the intermediate router first
+	if (head.m_routingPhase == 0
+		&& head.m_intermediate == convertCoordinateToID(m_coordinate))
+		head.m_routingPhase = 1;
+	const Coordinate target{ convertIDToCoordinate(
+		head.m_routingPhase == 0 && head.m_intermediate >= 0
+		? head.m_intermediate : -head.m_destination - 1) };
+	if (target == m_coordinate)
+		return head.m_destination;
+
+	Coordinate next{ m_coordinate };
+	switch (m_algorithm)
+	{
+	case RoutingAlgorithm::DOR:
+	case RoutingAlgorithm::VAL:
+	case RoutingAlgorithm::ROMM:
+		stepDimensionOrder(next, target, false);
+		break;
+	case RoutingAlgorithm::O1TURN:
+		stepDimensionOrder(next, target, head.m_routingPhase == 1);
+		break;
+	case RoutingAlgorithm::MAD:
+		stepMAD(next, target);
+		break;
+	case RoutingAlgorithm::ODD_EVEN:
+		stepOddEven(next, target);
+		break;
+	case RoutingAlgorithm::NONE:
+		return head.m_destination;
+	}
+	return convertCoordinateToID(next);
+}
+
+void RoutingFunction::computeOutputPorts(const Flit& head,
+	std::vector<int>& outputPorts) const
+{
+	outputPorts.clear();
+	const Coordinate target{ convertIDToCoordinate(-head.m_destination - 1) };
+	if (target == m_coordinate)
+	{
+		outputPorts.push_back(head.m_destination);
+		return;
+	}
+
+	if (m_algorithm == RoutingAlgorithm::MAD)
+	{
+		// fully adaptive: every axis that brings the packet closer; the
+		// escape network keeps the wrap-around links of a torus safe
+		const bool shortestWay{ m_torus && hasEscapeChannels() };
+		addOutputPort(outputPorts, &Coordinate::m_x, target.m_x, shortestWay);
+		addOutputPort(outputPorts, &Coordinate::m_y, target.m_y, shortestWay);
+		addOutputPort(outputPorts, &Coordinate::m_z, target.m_z, shortestWay);
+	}
+	else if (m_dimension.m_z == 1)
+	{
+		// odd-even turn model (Chiu): no east-to-north/south turns in even
+		// columns and no north/south-to-west turns in odd columns
+		const int sourceX{ convertIDToCoordinate(-head.m_source - 1).m_x };
+		const int dx{ target.m_x - m_coordinate.m_x };
+		if (dx == 0)
+			addOutputPort(outputPorts, &Coordinate::m_y, target.m_y, false);
+		else if (dx > 0)
+		{
+			if (target.m_x % 2 == 1 || dx != 1 || target.m_y == m_coordinate.m_y)
+				addOutputPort(outputPorts, &Coordinate::m_x, target.m_x, false);
+			if (m_coordinate.m_x % 2 == 1 || m_coordinate.m_x == sourceX)
+				addOutputPort(outputPorts, &Coordinate::m_y, target.m_y, false);
+		}
+		else
+		{
+			addOutputPort(outputPorts, &Coordinate::m_x, target.m_x, false);
+			if (m_coordinate.m_x % 2 == 0)
+				addOutputPort(outputPorts, &Coordinate::m_y, target.m_y, false);
+		}
+	}
+	if (outputPorts.empty())
+	{
+		// odd-even in 3D keeps its deterministic route
+		Coordinate next{ m_coordinate };
+		stepOddEven(next, target);
+		outputPorts.push_back(convertCoordinateToID(next));
+	}
+}
+
+bool RoutingFunction::admitsVirtualChannel(const Flit& head,
+	const int virtualChannel, const int datelineClass) const
+{
+	// O1TURN: XY packets in the lower half, YX packets in the upper half;
+	// VAL and ROMM: the first phase in the lower, the second in the upper
+	if (m_escapeNumber > 0)
+		return virtualChannel >= m_escapeNumber;
+	if (m_partitionNumber == 1)
+		return true;
+	const int partition{ getPartition(virtualChannel) };
+	if (m_phaseNumber == 2
+		&& partition / m_datelineClassNumber != (head.m_routingPhase == 1))
+		return false;
+	return datelineClass < 0 || partition % m_datelineClassNumber == datelineClass;
+}
+
+// the axis a hop between neighbouring routers travels along
+static int Coordinate::* getAxis(const Coordinate& from, const Coordinate& to)
+{
+	if (from.m_x != to.m_x)
+		return &Coordinate::m_x;
+	if (from.m_y != to.m_y)
+		return &Coordinate::m_y;
+	return &Coordinate::m_z;
+}
+
+int RoutingFunction::computeDatelineClass(const Flit& head, const int inputPortID,
+	const int inputVirtualChannel, const int outputPortID) const
+{
+	if (m_datelineClassNumber == 1 || outputPortID < 0)
+		return -1;
+	const int partition{ getPartition(inputVirtualChannel) };
+	const int phase{ m_phaseNumber == 2 ? head.m_routingPhase : 0 };
+	return continueClass(inputPortID, outputPortID,
+		partition / m_datelineClassNumber == phase
+		? partition % m_datelineClassNumber : -1);
+}
+
+bool RoutingFunction::hasEscapeChannels() const
+{
+	return m_escapeNumber > 0;
+}
+
+int RoutingFunction::computeEscapePort(const Flit& head) const
+{
+	const Coordinate target{ convertIDToCoordinate(-head.m_destination - 1) };
+	if (target == m_coordinate)
+		return head.m_destination;
+	Coordinate next{ m_coordinate };
+	stepDimensionOrder(next, target, false);
+	return convertCoordinateToID(next);
+}
+
+bool RoutingFunction::admitsEscapeVirtualChannel(const int virtualChannel,
+	const int escapeClass) const
+{
+	return virtualChannel < m_escapeNumber && (escapeClass < 0
+		|| virtualChannel * m_escapeClassNumber / m_escapeNumber == escapeClass);
+}
+
+int RoutingFunction::computeEscapeClass(const int inputPortID,
+	const int inputVirtualChannel, const int outputPortID) const
+{
+	if (m_escapeClassNumber == 1 || outputPortID < 0)
+		return -1;
+	// a packet coming from an adaptive VC enters the escape network anew
+	return continueClass(inputPortID, outputPortID,
+		inputVirtualChannel < m_escapeNumber
+		? inputVirtualChannel * m_escapeClassNumber / m_escapeNumber : -1);
+}
+
+int RoutingFunction::continueClass(const int inputPortID,
+	const int outputPortID, const int inputClass) const
+{
+	const Coordinate next{ convertIDToCoordinate(outputPortID) };
+	int Coordinate::* axis{ getAxis(m_coordinate, next) };
+	const int crossing{ std::abs(next.*axis - m_coordinate.*axis) > 1 };
+	if (inputPortID < 0 || inputClass < 0
+		|| getAxis(convertIDToCoordinate(inputPortID), m_coordinate) != axis)
+		return crossing;
+	return crossing | inputClass;
+}
+
+Coordinate RoutingFunction::convertIDToCoordinate(const int id) const
+{
+	return { (id % (m_dimension.m_x * m_dimension.m_y)) % m_dimension.m_x,
+			(id % (m_dimension.m_x * m_dimension.m_y)) / m_dimension.m_x,
+			id / (m_dimension.m_x * m_dimension.m_y) };
+}
+
+int RoutingFunction::getPartition(const int virtualChannel) const
+{
+	return virtualChannel * m_partitionNumber / g_virtualChannelNumber;
+}
+
+int RoutingFunction::convertCoordinateToID(const Coordinate& coordinate) const
+{
+	return coordinate.m_x
+		+ coordinate.m_y * m_dimension.m_x
+		+ coordinate.m_z * m_dimension.m_x * m_dimension.m_y;
+}
+
+void RoutingFunction::stepAxis(Coordinate& next, int Coordinate::* axis,
+	const int target, const bool shortestWay) const
+{
+	const int limit{ m_dimension.*axis };
+	const int distance{ target - next.*axis };
+	bool increment{ distance > 0 };
+	// same tie-break as the DOR route tables: half way round goes forward
+	if (shortestWay)
+		increment = distance > 0 ? distance <= limit / 2 : distance < -limit / 2;
+	next.*axis = increment ? (next.*axis + 1) % limit
+		: (next.*axis - 1 + limit) % limit;
+}
+
+void RoutingFunction::stepDimensionOrder(Coordinate& next,
+	const Coordinate& target, const bool yFirst) const
+{
+	int Coordinate::* first{ yFirst ? &Coordinate::m_y : &Coordinate::m_x };
+	int Coordinate::* second{ yFirst ? &Coordinate::m_x : &Coordinate::m_y };
+	if (next.*first != target.*first)
+		stepAxis(next, first, target.*first, m_torus);
+	else if (next.*second != target.*second)
+		stepAxis(next, second, target.*second, m_torus);
+	else
+		stepAxis(next, &Coordinate::m_z, target.m_z, m_torus);
+}
+
+void RoutingFunction::stepMAD(Coordinate& next, const Coordinate& target) const
+{
+	// the dimension with the largest distance first
+	const int dx{ std::abs(target.m_x - next.m_x) };
+	const int dy{ std::abs(target.m_y - next.m_y) };
+	const int dz{ std::abs(target.m_z - next.m_z) };
+	if (dx >= dy && dx >= dz)
+		stepAxis(next, &Coordinate::m_x, target.m_x, false);
+	else if (dy >= dz)
+		stepAxis(next, &Coordinate::m_y, target.m_y, false);
+	else
+		stepAxis(next, &Coordinate::m_z, target.m_z, false);
+}
+
+void RoutingFunction::stepOddEven(Coordinate& next, const Coordinate& target) const
+{
+	// 2D: even columns move in x first, odd columns in y first;
+	// 3D falls back to dimension order, as the route tables do
+	const bool xFirst{ m_dimension.m_z != 1 || next.m_x % 2 == 0 };
+	if (xFirst && next.m_x != target.m_x)
+		stepAxis(next, &Coordinate::m_x, target.m_x, false);
+	else if (next.m_y != target.m_y)
+		stepAxis(next, &Coordinate::m_y, target.m_y, false);
+	else if (next.m_x != target.m_x)
+		stepAxis(next, &Coordinate::m_x, target.m_x, false);
+	else
+		stepAxis(next, &Coordinate::m_z, target.m_z, false);
+}
+
+void RoutingFunction::addOutputPort(std::vector<int>& outputPorts,
+	int Coordinate::* axis, const int target, const bool shortestWay) const
+{
+	if (m_coordinate.*axis == target)
+		return;
+	Coordinate next{ m_coordinate };
+	stepAxis(next, axis, target, shortestWay);
+	outputPorts.push_back(convertCoordinateToID(next));
+}
+
+int RoutingFunction::chooseBetween(const int source, const int destination,
+	const int limit, std::mt19937& generator) const
+{
+	int distance{ destination - source };
+	if (m_torus && distance > limit / 2)
+		distance -= limit;
+	else if (m_torus && distance < -limit / 2)
+		distance += limit;
+	const int offset{ std::uniform_int_distribution<>(0, std::abs(distance))(generator) };
+	return (source + (distance < 0 ? -offset : offset) + limit) % limit;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "DataStructures.h"
+
+enum class RoutingAlgorithm
+{
+	DOR,      // dimension-order routing
+	O1TURN,   // XY or YX order, chosen per packet
+	MAD,      // minimal-adaptive, largest distance first
+	ODD_EVEN, // odd-even turn model
+	VAL,      // Valiant's, via a random router chosen per packet
+	ROMM,     // two-phase, via a random router inside the minimal quadrant
+	NONE      // not routed by a routing function
+};
+
+// how a router picks one of the admissible output ports of adaptive routing
+enum class SelectionFunction
+{
+	NONE,           // deterministic, the first admissible port
+	MAX_CREDIT,     // the most free downstream buffer slots
+	RANDOM,         // uniformly among the admissible ports
+	LOCAL_NEIGHBOUR // free downstream slots less the flits queued for the port here
+};
+
+// per-hop routing: a router derives the output port of a head flit from
+// its own coordinates and the destination, so no route tables are kept;
+// the head flit carries the destination, its routing phase and, for the
+// two-phase algorithms, the intermediate router
+class RoutingFunction
+{
+public:
+	RoutingFunction() = default;
+	RoutingFunction(const int routerID);
+
+	// routes are computed by the routers, not taken from source routing tables
+	bool isDistributed() const;
+	// choose the per-packet state of a new head flit at its source
+	void preparePacket(Flit& head, std::mt19937& generator) const;
+	// next router ID, or the destination terminal interface ID once the
+	// packet is at its destination router
+	int computeOutputPort(Flit& head) const;
+	// MAD and ODD_EVEN with a selection function: every minimal output port
+	// the turn rules allow, for the router to choose from by congestion
+	bool isAdaptive() const;
+	SelectionFunction getSelectionFunction() const;
+	void computeOutputPorts(const Flit& head, std::vector<int>& outputPorts) const;
+	// packets of different phases use disjoint virtual channels, so their
+	// dependencies cannot form a cycle; on a torus each phase is split again
+	// into dateline classes, -1 admits both
+	bool admitsVirtualChannel(const Flit& head,
+		const int virtualChannel, const int datelineClass = -1) const;
+	// dateline class of the downstream virtual channel for a hop: 1 once the
+	// packet crossed the wrap-around link of the dimension it travels in,
+	// 0 in a new dimension or phase, -1 without dateline classes
+	int computeDatelineClass(const Flit& head, const int inputPortID,
+		const int inputVirtualChannel, const int outputPortID) const;
+
+	// Duato's protocol for adaptive MAD: the lowest VCs of every port form a
+	// DOR-routed escape network, the others route adaptively; a packet takes
+	// an escape VC only when no adaptive one is free
+	bool hasEscapeChannels() const;
+	int computeEscapePort(const Flit& head) const;
+	bool admitsEscapeVirtualChannel(const int virtualChannel,
+		const int escapeClass) const;
+	// the dateline class among the escape VCs, as computeDatelineClass
+	int computeEscapeClass(const int inputPortID,
+		const int inputVirtualChannel, const int outputPortID) const;
+
+	static bool isDistributedRouting(); // from the globals of this thread
+	static bool isAdaptiveRouting(); // from the globals of this thread
+
+private:
+	Coordinate convertIDToCoordinate(const int id) const;
+	int getPartition(const int virtualChannel) const;
+	int convertCoordinateToID(const Coordinate& coordinate) const;
+	// one hop along an axis toward the target; with shortestWay a torus
+	// may go round the wrap-around link
+	void stepAxis(Coordinate& next, int Coordinate::* axis,
+		const int target, const bool shortestWay) const;
+	void stepDimensionOrder(Coordinate& next, const Coordinate& target,
+		const bool yFirst) const;
+	void stepMAD(Coordinate& next, const Coordinate& target) const;
+	void stepOddEven(Coordinate& next, const Coordinate& target) const;
+	void addOutputPort(std::vector<int>& outputPorts, int Coordinate::* axis,
+		const int target, const bool shortestWay) const;
+	// the class of a hop continuing from an input class, -1 for none
+	int continueClass(const int inputPortID, const int outputPortID,
+		const int inputClass) const;
+	// a random position on the way stepAxis takes from source to destination
+	int chooseBetween(const int source, const int destination,
+		const int limit, std::mt19937& generator) const;
+
+private:
+	RoutingAlgorithm m_algorithm{ RoutingAlgorithm::NONE };
+	SelectionFunction m_selectionFunction{ SelectionFunction::NONE };
+	int m_phaseNumber{ 1 }; // O1TURN, VAL and ROMM: two
+	int m_datelineClassNumber{ 1 }; // torus routes with wrap-around links: two
+	int m_partitionNumber{ 1 }; // virtual channel partitions, phases x classes
+	int m_escapeNumber{}; // escape VCs, the lowest of every port
+	int m_escapeClassNumber{ 1 }; // dateline classes of the escape VCs
+	Coordinate m_coordinate{};
+	Coordinate m_dimension{};
+	bool m_torus{};
+};
@@ -0,0 +1,481 @@
+#include "Simulation.h"
+#include <charconv>
+#include <filesystem>
+#include "ResultCache.h"
+#include "Profiler.h"
+#include "MemoryFootprint.h"
+#include "FlitTracer.h"
+#include "Telemetry.h"
+
+SimulationConfiguration SimulationConfiguration::capture()
+{
+	SimulationConfiguration configuration{};
+	configuration.m_x = g_x;
+	configuration.m_y = g_y;
+	configuration.m_z = g_z;
+	configuration.m_shape = g_shape;
+	configuration.m_routingAlgorithm = g_routingAlgorithm;
+	configuration.m_routingMode = g_routingMode;
+	configuration.m_selectionFunction = g_selectionFunction;
+	configuration.m_escapeVirtualChannelNumber = g_escapeVirtualChannelNumber;
+	configuration.m_routeCacheDirectory = g_routeCacheDirectory;
+	configuration.m_virtualChannelNumber = g_virtualChannelNumber;
+	configuration.m_bufferSize = g_bufferSize;
+	configuration.m_sourceQueueCapacity = g_sourceQueueCapacity;
+	configuration.m_sourceQueuePolicy = g_sourceQueuePolicy;
+	configuration.m_flitSize = g_flitSize;
+	configuration.m_packetSize = g_packetSize;
+	configuration.m_packetSizeOption = g_packetSizeOption;
+	configuration.m_injectionRate = g_injectionRate;
+	configuration.m_injectionProcess = g_injectionProcess;
+	configuration.m_replayTraceFile = g_replayTraceFile;
+	configuration.m_alpha = g_alpha;
+	configuration.m_beta = g_beta;
+	configuration.m_trafficPattern = g_trafficPattern;
+	configuration.m_totalCycles = g_totalCycles;
+	configuration.m_warmupCycles = g_warmupCycles;
+	configuration.m_measurementCycles = g_measurementCycles;
+	configuration.m_ejectionSink = g_ejectionSink;
+	configuration.m_traceBufferSize = g_traceBufferSize;
+	configuration.m_traceBufferNumber = g_traceBufferNumber;
+	configuration.m_traceBackpressure = g_traceBackpressure;
+	configuration.m_traceFormat = g_traceFormat;
+	configuration.m_numpyExport = g_numpyExport;
+	configuration.m_memoryReport = g_memoryReport;
+	configuration.m_linkCounters = g_linkCounters;
+	configuration.m_sourceQueueHistograms = g_sourceQueueHistograms;
+	configuration.m_flitTraceSample = g_flitTraceSample;
+	configuration.m_flitTraceSource = g_flitTraceSource;
+	configuration.m_flitTraceDestination = g_flitTraceDestination;
+	configuration.m_flitTraceRingSize = g_flitTraceRingSize;
+	configuration.m_telemetryInterval = g_telemetryInterval;
+	configuration.m_statisticsWindow = g_statisticsWindow;
+	configuration.m_hugePages = g_hugePages;
+	return configuration;
+}
+
+void SimulationConfiguration::apply() const
+{
+	g_x = m_x;
+	g_y = m_y;
+	g_z = m_z;
+	g_shape = m_shape;
+	g_routingAlgorithm = m_routingAlgorithm;
+	g_routingMode = m_routingMode;
+	g_selectionFunction = m_selectionFunction;
+	g_escapeVirtualChannelNumber = getEscapeVirtualChannelNumber();
+	g_routeCacheDirectory = m_routeCacheDirectory;
+	g_virtualChannelNumber = m_virtualChannelNumber;
+	g_bufferSize = m_bufferSize;
+	g_sourceQueueCapacity = m_sourceQueueCapacity;
+	g_sourceQueuePolicy = m_sourceQueuePolicy;
+	g_flitSize = m_flitSize;
+	g_packetSize = m_packetSize;
+	g_packetSizeOption = m_packetSizeOption;
+	g_injectionRate = m_injectionRate;
+	g_injectionProcess = m_injectionProcess;
+	g_replayTraceFile = m_replayTraceFile;
+	g_alpha = m_alpha;
+	g_beta = m_beta;
+	g_trafficPattern = m_trafficPattern;
+	g_totalCycles = m_totalCycles;
+	g_warmupCycles = m_warmupCycles;
+	g_measurementCycles = m_measurementCycles;
+	g_ejectionSink = m_ejectionSink;
+	g_traceBufferSize = m_traceBufferSize;
+	g_traceBufferNumber = m_traceBufferNumber;
+	g_traceBackpressure = m_traceBackpressure;
+	g_traceFormat = m_traceFormat;
+	g_numpyExport = m_numpyExport;
+	g_memoryReport = m_memoryReport;
+	g_linkCounters = m_linkCounters;
+	g_sourceQueueHistograms = m_sourceQueueHistograms;
+	g_flitTraceSample = m_flitTraceSample;
+	g_flitTraceSource = m_flitTraceSource;
+	g_flitTraceDestination = m_flitTraceDestination;
+	g_flitTraceRingSize = m_flitTraceRingSize;
+	g_telemetryInterval = m_telemetryInterval;
+	g_statisticsWindow = m_statisticsWindow;
+	g_hugePages = m_hugePages;
+	g_drainCycles = g_totalCycles - g_warmupCycles - g_measurementCycles;
+	g_packetNumber = g_totalCycles * g_injectionRate;
+}
+
+std::string SimulationConfiguration::getCanonicalString() const
+{
+	std::ostringstream text{};
+	text << "dimension = [ " << m_x << ", " << m_y << ", " << m_z << " ]\n"
+		<< "shape = \"" << m_shape << "\"\n"
+		<< "routing_algorithm = \"" << m_routingAlgorithm << "\"\n"
+		<< "routing_mode = \"" << m_routingMode << "\"\n"
+		<< "selection_function = \"" << m_selectionFunction << "\"\n"
+		<< "escape_virtual_channels = " << getEscapeVirtualChannelNumber() << "\n"
+		<< "virtual_channel_number = " << m_virtualChannelNumber << "\n"
+		<< "buffer_size = " << m_bufferSize << "\n"
+		<< "flit_size = " << m_flitSize << "\n"
+		<< "packet_size = " << m_packetSize << "\n"
+		<< "packet_size_option = \"" << m_packetSizeOption << "\"\n"
+		<< "injection_rate = " << formatCanonicalFloat(m_injectionRate) << "\n"
+		<< "injection_process = \"" << m_injectionProcess << "\"\n"
+		<< "alpha = " << formatCanonicalFloat(m_alpha) << "\n"
+		<< "beta = " << formatCanonicalFloat(m_beta) << "\n"
+		<< "traffic_pattern = \"" << m_trafficPattern << "\"\n"
+		<< "total_cycles = " << m_totalCycles << "\n"
+		<< "warmup_cycles = " << m_warmupCycles << "\n"
+		<< "measurement_cycles = " << m_measurementCycles << "\n"
+		<< "ejection_sink = \"" << m_ejectionSink << "\"\n";
+	if (m_sourceQueueCapacity > 0)
+		text << "source_queue_capacity = " << m_sourceQueueCapacity << "\n"
+		<< "source_queue_policy = \"" << m_sourceQueuePolicy << "\"\n";
+	if (m_injectionProcess == "trace")
+	{
+		// a replay trace is identified by its path, size and modification
+		std::error_code error{};
+		text << "trace_file = \"" << m_replayTraceFile << "\"\n"
+			<< "trace_file_size = "
+			<< std::filesystem::file_size(m_replayTraceFile, error) << "\n"
+			<< "trace_file_time = " << std::filesystem::last_write_time(
+				m_replayTraceFile, error).time_since_epoch().count() << "\n";
+	}
+	return text.str();
+}
+
+std::string SimulationConfiguration::getRouteKeyString() const
+{
+	std::ostringstream text{};
+	text << "model_version = " << SOXIM_MODEL_VERSION << "\n"
+		<< "seed = " << MAGIC_NUMBER << "\n"
+		<< "dimension = [ " << m_x << ", " << m_y << ", " << m_z << " ]\n"
+		<< "shape = \"" << m_shape << "\"\n"
+		<< "routing_algorithm = \"" << m_routingAlgorithm << "\"\n";
+	return text.str();
+}
+
+int SimulationConfiguration::getEscapeVirtualChannelNumber() const
+{
+	if (m_escapeVirtualChannelNumber >= 0)
+		return m_escapeVirtualChannelNumber;
+	if (m_routingAlgorithm != "MAD" || m_selectionFunction == "none")
+		return 0;
+	const int escapeVirtualChannelNumber{ m_shape == "TORUS" ? 2 : 1 };
+	return escapeVirtualChannelNumber < m_virtualChannelNumber ? escapeVirtualChannelNumber : 0;
+}
+
+bool SimulationConfiguration::validate(std::ostream& stream) const
+{
+	bool valid{ true };
+	// adaptive MAD is deadlock free only with escape virtual channels; one
+	// class on a mesh, two dateline classes on a torus
+	if (m_routingAlgorithm == "MAD" && m_selectionFunction != "none")
+	{
+		const int escapeVirtualChannelNumber{ getEscapeVirtualChannelNumber() };
+		if (escapeVirtualChannelNumber > 0 && escapeVirtualChannelNumber >= m_virtualChannelNumber)
+		{
+			stream << "Error: " << escapeVirtualChannelNumber << " escape virtual channel(s) leave none of "
+				<< m_virtualChannelNumber << " to route adaptively\n";
+			valid = false;
+		}
+		else if (escapeVirtualChannelNumber == 1 && m_shape == "TORUS")
+		{
+			stream << "Error: the escape virtual channels of a torus need two dateline classes; "
+				"set escape_virtual_channels to at least 2\n";
+			valid = false;
+		}
+		else if (escapeVirtualChannelNumber == 0)
+			stream << "Warning: adaptive MAD without escape virtual channels can deadlock\n";
+		else if (m_escapeVirtualChannelNumber < 0)
+			stream << "Warning: adaptive MAD reserves " << escapeVirtualChannelNumber
+				<< " escape virtual channel(s); set escape_virtual_channels to choose\n";
+	}
+	// the wrap-around links of a torus need two dateline classes per
+	// routing phase, see RoutingFunction
+	if (m_shape == "TORUS" && m_routingAlgorithm != "MAD" && m_routingAlgorithm != "ODD_EVEN")
+	{
+		const int phaseNumber{ m_routingAlgorithm == "O1TURN" || m_routingAlgorithm == "VAL"
+			|| m_routingAlgorithm == "ROMM" ? 2 : 1 };
+		if (m_virtualChannelNumber < 2 * phaseNumber)
+			stream << "Warning: " << m_routingAlgorithm << " on a torus needs "
+				<< 2 * phaseNumber << " virtual channels for its dateline classes; with "
+				<< m_virtualChannelNumber << " it can deadlock\n";
+	}
+	return valid;
+}
+
+std::string formatCanonicalFloat(const float value)
+{
+	char digits[32]{};
+	auto [end, error] { std::to_chars(std::begin(digits),
+		std::end(digits), value) };
+	return std::string(digits, end);
+}
+
+Simulation::Simulation(const SimulationConfiguration& configuration,
+	const std::string& outputDirectory)
+	:
+	m_configuration{ configuration },
+	m_outputDirectory{ outputDirectory } {
+}
+
+void Simulation::setRoutingTables(const RoutingTables* routingTables)
+{
+	m_routingTables = routingTables;
+}
+
+void Simulation::setResultCache(ResultCache* resultCache)
+{
+	m_resultCache = resultCache;
+}
+
+void Simulation::setRouteTable(const RouteTable* routeTable)
+{
+	m_routeTable = routeTable;
+}
+
+RoutingTables Simulation::generateRoutingTables()
+{
+	m_configuration.apply();
+	RegularNetwork* network{ createNetwork() };
+	network->loadNetworkData();
+	RoutingTables routingTables{ network->getRoutingTables() };
+	delete network;
+	network = nullptr;
+	return routingTables;
+}
+
+RouteTable* Simulation::openRouteTable()
+{
+	m_configuration.apply();
+	if (m_configuration.m_routeCacheDirectory.empty()
+		|| RoutingFunction::isDistributedRouting())
+		return nullptr; // nothing to cache
+	std::error_code error{};
+	std::filesystem::create_directories(m_configuration.m_routeCacheDirectory, error);
+	std::ostringstream fileName{};
+	fileName << m_configuration.m_shape << '_' << m_configuration.m_x << 'x'
+		<< m_configuration.m_y << 'x' << m_configuration.m_z << '_'
+		<< m_configuration.m_routingAlgorithm << '_' << MAGIC_NUMBER << ".routes";
+	const std::string filePath{ (std::filesystem::path{
+		m_configuration.m_routeCacheDirectory } / fileName.str()).string() };
+	const std::string keyText{ m_configuration.getRouteKeyString() };
+
+	RouteTable* routeTable{ new RouteTable{ filePath, keyText } };
+	if (!routeTable->isOpen())
+	{
+		delete routeTable;
+		routeTable = nullptr;
+		if (!RouteTable::write(filePath, keyText, generateRoutingTables()))
+			return nullptr;
+		routeTable = new RouteTable{ filePath, keyText };
+	}
+	if (!routeTable->isOpen())
+	{
+		delete routeTable;
+		routeTable = nullptr;
+	}
+	return routeTable;
+}
+
+Performance Simulation::run(const bool generateTraffic,
+	const bool analyzeTraffic,
+	const bool printPerformance)
+{
+	Performance performance{};
+	if (m_resultCache && generateTraffic && analyzeTraffic
+		&& m_resultCache->load(m_configuration, performance))
+	{
+		if (printPerformance)
+		{
+			std::cout << "Result loaded from cache: "
+				<< m_resultCache->getFilePath(m_configuration) << "\n";
+			std::cout << performance << std::flush;
+		}
+		return performance;
+	}
+
+	const auto startupStart{ std::chrono::steady_clock::now() };
+	RouteTable* routeTable{ m_routingTables || m_routeTable ? nullptr
+		: openRouteTable() };
+	m_configuration.apply();
+	Clock::reset();
+
+	RegularNetwork* network{ createNetwork() };
+	if (m_routingTables)
+		network->loadNetworkData(*m_routingTables);
+	else if (m_routeTable)
+		network->loadNetworkData(m_routeTable);
+	else if (routeTable)
+		network->loadNetworkData(routeTable);
+	else
+		network->loadNetworkData();
+	MemoryAccount* memoryAccount{ g_memoryReport && printPerformance
+		? new MemoryAccount{ network->getRouterNumber() } : nullptr };
+	sampleMemory(network, memoryAccount, "network construction");
+	FlitTracer* flitTracer{ g_flitTraceSample > 0 ? new FlitTracer{
+		m_outputDirectory + "FlitTrace.sft",
+		static_cast<size_t>(g_flitTraceRingSize) } : nullptr };
+	FlitTracer::setActive(flitTracer);
+	Telemetry* telemetry{ g_telemetryInterval > 0
+		? new Telemetry{ m_outputDirectory + "Telemetry.stats" } : nullptr };
+	Telemetry::setActive(telemetry);
+
+	if (generateTraffic)
+	{
+		TrafficOperator* trafficOperator{ new TrafficOperator{
+			m_outputDirectory,
+			network} };
+		trafficOperator->generateTraffic();
+		sampleMemory(network, memoryAccount, "traffic generation");
+
+#if PROFILE
+		Profiler::reset();
+#endif
+		m_startupSeconds = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - startupStart).count();
+		runCycles(network, memoryAccount, telemetry);
+#if PROFILE
+		if (printPerformance)
+			Profiler::report(std::cout, g_totalCycles);
+#endif
+		if (memoryAccount)
+			memoryAccount->report(std::cout);
+
+		if (analyzeTraffic)
+		{
+			trafficOperator->analyzeTraffic();
+			if (printPerformance)
+				trafficOperator->printPerformance();
+			if (printPerformance && g_sourceQueueCapacity > 0)
+				std::cout << "Source queues: " << m_stalledPacketNumber
+				<< " packets stalled, " << m_droppedPacketNumber << " dropped\n";
+			performance = trafficOperator->getPerformance();
+		}
+
+		delete trafficOperator;
+		trafficOperator = nullptr;
+	}
+	else
+	{
+		// Just run simulation without traffic generation
+		m_startupSeconds = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - startupStart).count();
+		runCycles(network, memoryAccount, telemetry);
+		if (memoryAccount)
+			memoryAccount->report(std::cout);
+	}
+
+	FlitTracer::setActive(nullptr);
+	delete flitTracer;
+	flitTracer = nullptr;
+	Telemetry::setActive(nullptr);
+	delete telemetry;
+	telemetry = nullptr;
+	delete memoryAccount;
+	memoryAccount = nullptr;
+	delete network;
+	network = nullptr;
+	delete routeTable;
+	routeTable = nullptr;
+
+	if (m_resultCache && generateTraffic && analyzeTraffic)
+		m_resultCache->store(m_configuration, performance);
+	return performance;
+}
+
+void Simulation::runCycles(RegularNetwork* network, MemoryAccount* memoryAccount,
+	Telemetry* telemetry)
+{
+	const auto cycleStart{ std::chrono::steady_clock::now() };
+	int telemetryCountdown{ g_telemetryInterval };
+	for (Clock clk; clk.get() < g_totalCycles; clk.tick())
+	{
+		network->runOneCycle();
+		if (telemetry && !--telemetryCountdown)
+		{
+			telemetryCountdown = g_telemetryInterval;
+			publishTelemetry(network, telemetry, static_cast<long long>(clk.get()) + 1);
+		}
+		if (clk.get() + 1 == g_warmupCycles)
+		{
+			network->resetPortCounters();
+			network->resetSourceQueueStatistics();
+			sampleMemory(network, memoryAccount, "warmup");
+		}
+		else if (clk.get() + 1 == g_warmupCycles + g_measurementCycles)
+		{
+			if (g_linkCounters && !network->writePortCounters(
+				m_outputDirectory + "LinkCounters.json", g_measurementCycles))
+				std::cerr << "Warning: Could not write link counters: "
+				<< m_outputDirectory << "LinkCounters.json\n";
+			if (g_sourceQueueHistograms && !network->writeSourceQueueStatistics(
+				m_outputDirectory + "SourceQueues.json", g_measurementCycles))
+				std::cerr << "Warning: Could not write source queue statistics: "
+				<< m_outputDirectory << "SourceQueues.json\n";
+			m_stalledPacketNumber = 0;
+			m_droppedPacketNumber = 0;
+			for (auto& terminalInterface : network->m_terminalInterfaces)
+			{
+				m_stalledPacketNumber += terminalInterface->m_stalledPacketNumber;
+				m_droppedPacketNumber += terminalInterface->m_droppedPacketNumber;
+			}
+			sampleMemory(network, memoryAccount, "measurement");
+		}
+	}
+	m_cycleSeconds = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - cycleStart).count();
+	sampleMemory(network, memoryAccount, "drain");
+	publishTelemetry(network, telemetry, g_totalCycles);
+}
+
+void Simulation::sampleMemory(RegularNetwork* network,
+	MemoryAccount* memoryAccount, const std::string& phase)
+{
+	if (!memoryAccount)
+		return;
+	MemoryFootprint footprint{};
+	network->measureMemory(footprint);
+	memoryAccount->sample(phase, footprint, &std::cout);
+}
+
+void Simulation::publishTelemetry(RegularNetwork* network,
+	Telemetry* telemetry, const long long cycle)
+{
+	if (!telemetry)
+		return;
+	long long sourceQueueFlits{}, maxSourceQueueFlits{};
+	for (auto& terminalInterface : network->m_terminalInterfaces)
+	{
+		const long long flits{ static_cast<long long>(
+			terminalInterface->m_sourceQueue.size()) };
+		sourceQueueFlits += flits;
+		maxSourceQueueFlits = std::max(maxSourceQueueFlits, flits);
+	}
+	telemetry->publish(cycle, sourceQueueFlits, maxSourceQueueFlits);
+}
+
+double Simulation::getStartupSeconds() const
+{
+	return m_startupSeconds;
+}
+
+double Simulation::getCycleSeconds() const
+{
+	return m_cycleSeconds;
+}
+
+long long Simulation::getStalledPacketNumber() const
+{
+	return m_stalledPacketNumber;
+}
+
+long long Simulation::getDroppedPacketNumber() const
+{
+	return m_droppedPacketNumber;
+}
+
+RegularNetwork* Simulation::createNetwork()
+{
+	RegularNetwork* network{ new RegularNetwork{} };
+	for (int i{}; i < network->getRouterNumber(); ++i)
+		network->connectTerminal(i);
+	return network;
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include "TrafficOperator.h"
+
+class ResultCache;
+class MemoryAccount;
+class Telemetry;
+
+// the configuration of one simulation; it owns its strings, so it can
+// outlive the TOML table it was parsed from and move to another thread
+struct SimulationConfiguration
+{
+	static SimulationConfiguration capture(); // from the globals of this thread
+	// set the globals of this thread; the string globals refer to this
+	// object, which must outlive the simulation
+	void apply() const;
+	// every setting that can change the result, one "name = value" line
+	// each in a fixed order; output-only settings are left out
+	std::string getCanonicalString() const;
+	// the settings routes depend on: topology, routing algorithm and seed
+	std::string getRouteKeyString() const;
+	// the escape VCs of adaptive MAD; if unset, one on a mesh and two on a
+	// torus, unless no VC would be left to route adaptively
+	int getEscapeVirtualChannelNumber() const;
+	// report settings that cannot run (errors) and that can deadlock
+	// (warnings) to stream; false on an error
+	bool validate(std::ostream& stream) const;
+
+	int m_x{}, m_y{}, m_z{};
+	std::string m_shape{};
+	std::string m_routingAlgorithm{};
+	std::string m_routingMode{ "source" };
+	std::string m_selectionFunction{ "none" };
+	int m_escapeVirtualChannelNumber{ -1 };
+	std::string m_routeCacheDirectory{};
+	int m_virtualChannelNumber{};
+	int m_bufferSize{};
+	int m_sourceQueueCapacity{};
+	std::string m_sourceQueuePolicy{ "stall" };
+	int m_flitSize{};
+	int m_packetSize{};
+	std::string m_packetSizeOption{};
+	float m_injectionRate{};
+	std::string m_injectionProcess{};
+	std::string m_replayTraceFile{};
+	float m_alpha{};
+	float m_beta{};
+	std::string m_trafficPattern{};
+	int m_totalCycles{};
+	int m_warmupCycles{};
+	int m_measurementCycles{};
+	std::string m_ejectionSink{};
+	int m_traceBufferSize{};
+	int m_traceBufferNumber{};
+	std::string m_traceBackpressure{};
+	std::string m_traceFormat{};
+	bool m_numpyExport{};
+	bool m_memoryReport{};
+	bool m_linkCounters{};
+	bool m_sourceQueueHistograms{};
+	int m_flitTraceSample{};
+	int m_flitTraceSource{ -1 };
+	int m_flitTraceDestination{ -1 };
+	int m_flitTraceRingSize{ 1 << 16 };
+	int m_telemetryInterval{};
+	int m_statisticsWindow{};
+	std::string m_hugePages{ "none" };
+};
+
+// shortest text that reads back as the same float
+std::string formatCanonicalFloat(const float value);
+
+// one simulation run on the calling thread; all simulation state is in
+// thread_local globals and the objects created here, so simulations on
+// different threads do not interfere
+class Simulation
+{
+public:
+	Simulation(const SimulationConfiguration& configuration,
+		const std::string& outputDirectory);
+
+	// routes of another simulation with the same topology and routing
+	// algorithm; not owned, must outlive run()
+	void setRoutingTables(const RoutingTables* routingTables);
+	// a mapped route table shared with other simulations; not owned,
+	// must outlive run()
+	void setRouteTable(const RouteTable* routeTable);
+	RoutingTables generateRoutingTables();
+	// map the cached route table of this network, generating and caching
+	// it first if needed; nullptr if routes are not cached, else owned
+	// by the caller
+	RouteTable* openRouteTable();
+	// return the cached result of an identical run, and cache new results;
+	// not owned
+	void setResultCache(ResultCache* resultCache);
+	Performance run(const bool generateTraffic = true,
+		const bool analyzeTraffic = true,
+		const bool printPerformance = true);
+	// wall time of the last run: building the network, its routes and its
+	// traffic, then the simulated cycles
+	double getStartupSeconds() const;
+	double getCycleSeconds() const;
+	// packets the source queues deferred and dropped in the measurement
+	// window of the last run, see g_sourceQueueCapacity
+	long long getStalledPacketNumber() const;
+	long long getDroppedPacketNumber() const;
+
+private:
+	RegularNetwork* createNetwork();
+	// the cycle loop, sampling the memory footprint at the end of warmup,
+	// measurement and drain if memoryAccount is set; the port counters
+	// and the source queue statistics count the measurement window and are
+	// written at its end; telemetry,
+	// if set, is published every g_telemetryInterval cycles and at the end
+	void runCycles(RegularNetwork* network, MemoryAccount* memoryAccount,
+		Telemetry* telemetry);
+	static void sampleMemory(RegularNetwork* network,
+		MemoryAccount* memoryAccount, const std::string& phase);
+	static void publishTelemetry(RegularNetwork* network,
+		Telemetry* telemetry, const long long cycle);
+
+private:
+	SimulationConfiguration m_configuration{};
+	std::string m_outputDirectory{};
+	const RoutingTables* m_routingTables{};
+	const RouteTable* m_routeTable{};
+	ResultCache* m_resultCache{};
+	double m_startupSeconds{};
+	double m_cycleSeconds{};
+	long long m_stalledPacketNumber{};
+	long long m_droppedPacketNumber{};
+};
@@ -0,0 +1,193 @@
+#include "Sweep.h"
+#include "ResultCache.h"
+#include "MemoryFootprint.h"
+#include <filesystem>
+#include <thread>
+
+Sweep::Sweep(const SimulationConfiguration& baseConfiguration,
+	const SweepGrid& grid,
+	const std::string& outputDirectory)
+{
+	auto orBase{ [](const auto& values, const auto& base) {
+		return values.empty() ? std::vector{ base } : values; } };
+
+	for (auto& routingAlgorithm : orBase(grid.m_routingAlgorithms,
+		baseConfiguration.m_routingAlgorithm))
+		for (auto virtualChannelNumber : orBase(grid.m_virtualChannelNumbers,
+			baseConfiguration.m_virtualChannelNumber))
+			for (auto bufferSize : orBase(grid.m_bufferSizes,
+				baseConfiguration.m_bufferSize))
+				for (auto injectionRate : orBase(grid.m_injectionRates,
+					baseConfiguration.m_injectionRate))
+				{
+					SweepPoint point{ baseConfiguration };
+					point.m_configuration.m_routingAlgorithm = routingAlgorithm;
+					point.m_configuration.m_virtualChannelNumber = virtualChannelNumber;
+					point.m_configuration.m_bufferSize = bufferSize;
+					point.m_configuration.m_injectionRate = injectionRate;
+					// every point writes its traffic files into its own folder
+					std::ostringstream folder{};
+					folder << routingAlgorithm << "_vc" << virtualChannelNumber
+						<< "_buffer" << bufferSize << "_rate" << injectionRate << '/';
+					point.m_outputDirectory = outputDirectory + folder.str();
+					m_points.push_back(point);
+				}
+}
+
+Sweep::~Sweep()
+{
+	for (auto& [routingAlgorithm, routeTable] : m_routeTables)
+	{
+		delete routeTable;
+		routeTable = nullptr;
+	}
+}
+
+void Sweep::setResultCache(ResultCache* resultCache)
+{
+	m_resultCache = resultCache;
+}
+
+void Sweep::setMemoryLimit(const size_t memoryLimit)
+{
+	m_memoryLimit = memoryLimit;
+}
+
+bool Sweep::validate(std::ostream& stream) const
+{
+	bool valid{ true };
+	std::set<std::string> messages{};
+	for (auto& point : m_points)
+	{
+		std::ostringstream message{};
+		valid &= point.m_configuration.validate(message);
+		if (messages.insert(message.str()).second)
+			stream << message.str();
+	}
+	return valid;
+}
+
+void Sweep::run(const int threadNumber)
+{
+	for (auto& point : m_points)
+		point.m_cached = m_resultCache
+			&& m_resultCache->load(point.m_configuration, point.m_performance);
+	if (m_memoryLimit)
+		refuseOversizedPoints(std::max(threadNumber, 1));
+
+	// routes depend on the topology and the routing algorithm only
+	for (auto& point : m_points)
+	{
+		if (point.m_cached || point.m_refused)
+			continue;
+		const std::string& routingAlgorithm{ point.m_configuration.m_routingAlgorithm };
+		if (!m_routeTables.contains(routingAlgorithm))
+		{
+			Simulation simulation{ point.m_configuration, point.m_outputDirectory };
+			m_routeTables[routingAlgorithm] = simulation.openRouteTable();
+			if (!m_routeTables.at(routingAlgorithm))
+				m_routingTables[routingAlgorithm] = simulation.generateRoutingTables();
+		}
+		std::filesystem::create_directories(point.m_outputDirectory);
+	}
+
+	m_nextPoint = 0;
+	std::vector<std::thread> workers{};
+	for (int i{}; i < std::max(threadNumber, 1); ++i)
+		workers.emplace_back(&Sweep::runWorker, this);
+	for (auto& worker : workers)
+		worker.join();
+}
+
+void Sweep::runWorker()
+{
+	for (size_t i{ m_nextPoint++ }; i < m_points.size(); i = m_nextPoint++)
+	{
+		SweepPoint& point{ m_points.at(i) };
+		if (point.m_cached || point.m_refused)
+			continue;
+		Simulation simulation{ point.m_configuration, point.m_outputDirectory };
+		const std::string& routingAlgorithm{ point.m_configuration.m_routingAlgorithm };
+		if (m_routeTables.at(routingAlgorithm))
+			simulation.setRouteTable(m_routeTables.at(routingAlgorithm));
+		else
+			simulation.setRoutingTables(&m_routingTables.at(routingAlgorithm));
+		simulation.setResultCache(m_resultCache);
+		point.m_performance = simulation.run(true, true, false);
+	}
+}
+
+void Sweep::refuseOversizedPoints(const int threadNumber)
+{
+	std::map<std::string, size_t> routingTables{};
+	size_t pending{};
+	for (auto& point : m_points)
+	{
+		if (point.m_cached)
+			continue;
+		++pending;
+		routingTables[point.m_configuration.m_routingAlgorithm] =
+			estimateMemoryFootprint(point.m_configuration)[MemorySubsystem::ROUTING_TABLES];
+	}
+	size_t sharedBytes{};
+	for (auto& [routingAlgorithm, bytes] : routingTables)
+		sharedBytes += bytes;
+	const size_t concurrent{ std::max<size_t>(std::min<size_t>(threadNumber, pending), 1) };
+	const size_t pointLimit{ m_memoryLimit > sharedBytes
+		? (m_memoryLimit - sharedBytes) / concurrent : 0 };
+
+	for (auto& point : m_points)
+	{
+		if (point.m_cached)
+			continue;
+		const size_t bytes{ estimateMemoryFootprint(point.m_configuration).getTotal() };
+		point.m_refused = bytes > pointLimit;
+		if (point.m_refused)
+			std::cerr << "Warning: Sweep point " << point.m_outputDirectory
+				<< " needs an estimated " << bytes / (1024 * 1024) << " MiB, "
+				<< pointLimit / (1024 * 1024) << " MiB fit; not simulated\n";
+	}
+}
+
+void Sweep::writeResults(std::ostream& stream)
+{
+	stream << "RoutingAlgorithm,VirtualChannelNumber,BufferSize,"
+		<< "InjectionRate,Throughput,Demand,Latency,"
+		<< "QueueingLatency,NetworkLatency,SerialisationLatency\n";
+	for (auto& point : m_points)
+	{
+		stream << point.m_configuration.m_routingAlgorithm << ','
+			<< point.m_configuration.m_virtualChannelNumber << ','
+			<< point.m_configuration.m_bufferSize << ','
+			<< point.m_configuration.m_injectionRate << ',';
+		if (point.m_refused)
+		{
+			stream << ",,,,,\n"; // no result
+			continue;
+		}
+		stream << point.m_performance.m_throughput << ','
+			<< point.m_performance.m_demand << ','
+			<< point.m_performance.m_latency << ','
+			<< point.m_performance.m_queueingLatency << ','
+			<< point.m_performance.m_networkLatency << ','
+			<< point.m_performance.m_serialisationLatency << '\n';
+	}
+}
+
+const std::vector<SweepPoint>& Sweep::getPoints()
+{
+	return m_points;
+}
+
+std::vector<std::string> splitSweepList(const std::string& list)
+{
+	std::vector<std::string> values{};
+	std::istringstream listInString{ list };
+	std::string value{};
+	while (std::getline(listInString, value, ','))
+	{
+		if (!value.empty())
+			values.push_back(value);
+	}
+	return values;
+}
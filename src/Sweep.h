@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <map>
+#include <set>
+#include "Simulation.h"
+
+// values of the swept parameters; an empty list keeps the base value
+struct SweepGrid
+{
+	std::vector<float> m_injectionRates{};
+	std::vector<std::string> m_routingAlgorithms{};
+	std::vector<int> m_virtualChannelNumbers{};
+	std::vector<int> m_bufferSizes{};
+};
+
+struct SweepPoint
+{
+	SimulationConfiguration m_configuration{};
+	std::string m_outputDirectory{};
+	Performance m_performance{};
+	bool m_cached{}; // loaded from the result cache, not simulated
+	bool m_refused{}; // estimated not to fit the memory limit, not simulated
+};
+
+// runs every point of a parameter grid as its own Simulation on a pool
+// of threads; routes are generated (or mapped from the route cache)
+// once per routing algorithm and shared by all points that use it
+class Sweep
+{
+public:
+	Sweep(const SimulationConfiguration& baseConfiguration,
+		const SweepGrid& grid,
+		const std::string& outputDirectory);
+	~Sweep(); // release mapped route tables
+	Sweep(const Sweep&) = delete;
+	Sweep& operator=(const Sweep&) = delete;
+
+	void setResultCache(ResultCache* resultCache); // not owned
+	// bytes all points running at once may hold; 0 for no limit
+	void setMemoryLimit(const size_t memoryLimit);
+	// validate every point, reporting each message once; false if a
+	// point cannot run
+	bool validate(std::ostream& stream) const;
+	void run(const int threadNumber);
+	void writeResults(std::ostream& stream); // combined table as CSV
+	const std::vector<SweepPoint>& getPoints();
+
+private:
+	void runWorker();
+	// refuse every point whose estimated footprint does not fit its share
+	// of the memory limit, less the routing tables the sweep keeps per
+	// algorithm besides the copies of the running points
+	void refuseOversizedPoints(const int threadNumber);
+
+private:
+	std::vector<SweepPoint> m_points{};
+	std::map<std::string, RoutingTables> m_routingTables{}; // per algorithm
+	std::map<std::string, RouteTable*> m_routeTables{}; // per algorithm, if routes are cached
+	std::atomic<size_t> m_nextPoint{};
+	ResultCache* m_resultCache{};
+	size_t m_memoryLimit{};
+};
+
+// split a comma separated list, e.g. "0.01,0.02"
+std::vector<std::string> splitSweepList(const std::string& list);
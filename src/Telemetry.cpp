@@ -0,0 +1,132 @@
+#include "Telemetry.h"
+#include <bit>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+constexpr char c_telemetryMagic[]{ "SOXTEL01" };
+
+bool readTelemetry(const TelemetryBlock& block, TelemetrySnapshot& snapshot)
+{
+	if (std::memcmp(block.m_magic, c_telemetryMagic, sizeof(block.m_magic)) != 0)
+		return false;
+	for (int attempt{}; attempt < 1000; ++attempt)
+	{
+		const unsigned long long before{ block.m_sequence.load(std::memory_order_acquire) };
+		if (before % 2)
+			continue; // being written
+		std::memcpy(&snapshot, &block.m_snapshot, sizeof(snapshot));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (block.m_sequence.load(std::memory_order_relaxed) == before)
+			return true;
+	}
+	return false;
+}
+
+Telemetry::Telemetry(const std::string& filePath)
+{
+	m_fileDescriptor = ::open(filePath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (m_fileDescriptor < 0 || ::ftruncate(m_fileDescriptor, sizeof(TelemetryBlock)) != 0)
+	{
+		std::cerr << "Warning: Could not create telemetry: " << filePath << "\n";
+		return;
+	}
+	void* mapping{ ::mmap(nullptr, sizeof(TelemetryBlock), PROT_READ | PROT_WRITE,
+		MAP_SHARED, m_fileDescriptor, 0) };
+	if (mapping == MAP_FAILED)
+	{
+		std::cerr << "Warning: Could not map telemetry: " << filePath << "\n";
+		return;
+	}
+	m_block = new (mapping) TelemetryBlock{};
+	m_block->m_snapshot.m_processID = ::getpid();
+	m_block->m_snapshot.m_totalCycles = g_totalCycles;
+	// readers check the magic first, so it goes in last
+	std::atomic_thread_fence(std::memory_order_release);
+	std::memcpy(m_block->m_magic, c_telemetryMagic, sizeof(m_block->m_magic));
+}
+
+Telemetry::~Telemetry()
+{
+	if (s_active == this)
+		s_active = nullptr;
+	if (m_block)
+		::munmap(m_block, sizeof(TelemetryBlock));
+	if (m_fileDescriptor >= 0)
+		::close(m_fileDescriptor);
+}
+
+bool Telemetry::isOpen() const
+{
+	return m_block;
+}
+
+void Telemetry::publish(const long long cycle, const long long sourceQueueFlits,
+	const long long maxSourceQueueFlits)
+{
+	if (!m_block)
+		return;
+	TelemetrySnapshot snapshot{ m_block->m_snapshot };
+	snapshot.m_cycle = cycle;
+	snapshot.m_totalCycles = g_totalCycles;
+	snapshot.m_injectedPackets = m_injectedPackets;
+	snapshot.m_inFlightPackets = m_injectedPackets - m_deliveredPackets;
+	snapshot.m_deliveredPackets = m_deliveredPackets;
+	snapshot.m_meanLatency = m_deliveredPackets ? m_latencySum / m_deliveredPackets : 0.0;
+	snapshot.m_p99Latency = getPercentileLatency(0.99);
+	snapshot.m_sourceQueueFlits = sourceQueueFlits;
+	snapshot.m_maxSourceQueueFlits = maxSourceQueueFlits;
+
+	// seqlock: odd while the snapshot is inconsistent
+	const unsigned long long sequence{ m_block->m_sequence.load(std::memory_order_relaxed) };
+	m_block->m_sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	std::memcpy(&m_block->m_snapshot, &snapshot, sizeof(snapshot));
+	m_block->m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void Telemetry::setActive(Telemetry* telemetry)
+{
+	s_active = telemetry && telemetry->isOpen() ? telemetry : nullptr;
+}
+
+int Telemetry::getLatencyBucket(const long long latency)
+{
+	if (latency < 32)
+		return static_cast<int>(std::max(latency, 0LL));
+	const int exponent{ static_cast<int>(std::bit_width(
+		static_cast<unsigned long long>(latency))) - 1 };
+	const int fraction{ static_cast<int>((latency >> (exponent - 4)) & 15) };
+	return 32 + (exponent - 5) * 16 + fraction;
+}
+
+long long Telemetry::getLatencyBucketEnd(const int bucket)
+{
+	if (bucket < 32)
+		return bucket;
+	const int exponent{ (bucket - 32) / 16 + 5 };
+	const long long fraction{ (bucket - 32) % 16 };
+	return ((16 + fraction + 1) << (exponent - 4)) - 1;
+}
+
+void Telemetry::addLatency(const float latency)
+{
+	++m_deliveredPackets;
+	m_latencySum += latency;
+	++m_latencyHistogram[getLatencyBucket(static_cast<long long>(latency))];
+}
+
+double Telemetry::getPercentileLatency(const double fraction) const
+{
+	const long long rank{ static_cast<long long>(fraction * m_deliveredPackets) };
+	long long count{};
+	for (int i{}; i < c_latencyBucketNumber; ++i)
+	{
+		count += m_latencyHistogram[i];
+		if (count > rank)
+			return static_cast<double>(getLatencyBucketEnd(i));
+	}
+	return 0.0;
+}
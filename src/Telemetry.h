@@ -0,0 +1,91 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include "DataStructures.h"
+
+// Live telemetry (.stats)
+//
+// A running simulation publishes its progress every g_telemetryInterval
+// cycles into a small memory-mapped file, which another process can map
+// and poll while the run goes on. The block is a seqlock: the writer makes
+// the sequence odd, updates the snapshot and makes it even again, and a
+// reader retries until it copied the snapshot under the same even
+// sequence. The writer never waits for readers.
+//
+// file := "SOXTEL01" u64(sequence) TelemetrySnapshot, native byte order
+
+struct TelemetrySnapshot
+{
+	long long m_processID{}; // of the simulation, e.g. to stop a saturated run
+	long long m_cycle{};
+	long long m_totalCycles{};
+	long long m_injectedPackets{}; // entered their source queue
+	long long m_inFlightPackets{}; // injected, not delivered yet
+	long long m_deliveredPackets{};
+	double m_meanLatency{}; // of the delivered packets, as in the statistics
+	double m_p99Latency{}; // within 1/16 of the exact value
+	long long m_sourceQueueFlits{}; // over all terminal interfaces
+	long long m_maxSourceQueueFlits{}; // of the fullest terminal interface
+};
+
+struct TelemetryBlock
+{
+	char m_magic[8]{};
+	std::atomic<unsigned long long> m_sequence{}; // odd while the snapshot is written
+	TelemetrySnapshot m_snapshot{};
+};
+
+static_assert(sizeof(TelemetryBlock) == 96);
+static_assert(std::atomic<unsigned long long>::is_always_lock_free);
+
+// copy the snapshot of a block another process publishes; false if the
+// block is not telemetry or the writer kept it busy
+bool readTelemetry(const TelemetryBlock& block, TelemetrySnapshot& snapshot);
+
+// telemetry of the simulation on this thread; one is active per thread at most
+class Telemetry
+{
+public:
+	Telemetry(const std::string& filePath);
+	~Telemetry();
+	Telemetry(const Telemetry&) = delete;
+	Telemetry& operator=(const Telemetry&) = delete;
+
+	bool isOpen() const;
+	void publish(const long long cycle, const long long sourceQueueFlits,
+		const long long maxSourceQueueFlits);
+
+	// the telemetry the count calls of this thread go to
+	static void setActive(Telemetry* telemetry);
+	static void countInjection()
+	{
+		if (s_active)
+			++s_active->m_injectedPackets;
+	}
+	static void countDelivery(const float latency)
+	{
+		if (s_active)
+			s_active->addLatency(latency);
+	}
+
+	// latencies below 32 cycles have a bucket each, longer ones 16 buckets
+	// per power of two
+	static int getLatencyBucket(const long long latency);
+	static long long getLatencyBucketEnd(const int bucket); // last latency in the bucket
+
+private:
+	void addLatency(const float latency);
+	double getPercentileLatency(const double fraction) const;
+
+private:
+	static constexpr int c_latencyBucketNumber{ 32 + 58 * 16 };
+
+	int m_fileDescriptor{ -1 };
+	TelemetryBlock* m_block{};
+	long long m_injectedPackets{};
+	long long m_deliveredPackets{};
+	double m_latencySum{};
+	std::array<long long, c_latencyBucketNumber> m_latencyHistogram{};
+
+	static inline thread_local Telemetry* s_active{};
+};
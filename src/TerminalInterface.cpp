@@ -1,10 +1,35 @@
 #include "TerminalInterface.h"
+#include "Profiler.h"
+#include "MemoryFootprint.h"
+#include "FlitTracer.h"
+#include "Telemetry.h"
+#include <bit>
+
+static SourceQueuePolicy parseSourceQueuePolicy(const std::string_view policy)
+{
+	if (policy == "drop")
+		return SourceQueuePolicy::DROP;
+	return SourceQueuePolicy::STALL;
+}
 
 TerminalInterface::TerminalInterface(const int terminalInterfaceID)
 	:
-	m_terminalInterfaceID{ terminalInterfaceID }
+	m_terminalInterfaceID{ terminalInterfaceID },
+	m_routingFunction{ -terminalInterfaceID - 1 },
+	m_sourceQueuePolicy{ parseSourceQueuePolicy(g_sourceQueuePolicy) }
 {
 	m_clock.set(0);
+#if REPRODUCE_RANDOM
+	m_routingGenerator.seed(MAGIC_NUMBER - terminalInterfaceID);
+	std::seed_seq trafficSeed{ MAGIC_NUMBER, terminalInterfaceID };
+	m_trafficGenerator.seed(trafficSeed);
+	std::seed_seq injectionSeed{ MAGIC_NUMBER, terminalInterfaceID, 1 };
+	m_injectionGenerator.seed(injectionSeed);
+#else
+	m_routingGenerator.seed(std::random_device{}());
+	m_trafficGenerator.seed(std::random_device{}());
+	m_injectionGenerator.seed(std::random_device{}());
+#endif
 }
 
 Port* TerminalInterface::getPort(const int portID)
@@ -13,25 +38,76 @@ Port* TerminalInterface::getPort(const int portID)
 	return &m_port;
 }
 
-void TerminalInterface::updateEnable()
+void TerminalInterface::runOneCycle()
 {
-	if (m_port.m_inputRegister.isFlitRegisterEmpty())
-		m_port.m_inputRegister.m_flitEnable = false;
-	else
-		m_port.m_inputRegister.m_flitEnable = true;
+	{
+		PROFILE_SCOPE(ProfilePhase::INJECT);
+		injectTraffic();
+		receiveCredit();
+		sendFlit();
+		if (g_sourceQueueHistograms)
+		{
+			const int bucket{ getDepthBucket(m_sourceQueue.size()) };
+			if (bucket >= static_cast<int>(m_sourceQueueDepthHistogram.size()))
+				m_sourceQueueDepthHistogram.resize(bucket + 1);
+			++m_sourceQueueDepthHistogram[bucket];
+		}
+	}
+	PROFILE_SCOPE(ProfilePhase::EJECT);
+	receiveFlit();
+}
 
-	if (m_port.m_inputRegister.isCreditRegisterEmpty())
-		m_port.m_inputRegister.m_creditEnable = false;
-	else
-		m_port.m_inputRegister.m_creditEnable = true;
+void TerminalInterface::measureMemory(MemoryFootprint& footprint) const
+{
+	footprint.addPort(m_port);
+	size_t& routingTables{ footprint[MemorySubsystem::ROUTING_TABLES] };
+	routingTables += getHeapBytes(m_sourceRoutingTable);
+	for (auto& route : m_sourceRoutingTable)
+		routingTables += getHeapBytes(route);
+
+	size_t& trafficBuffers{ footprint[MemorySubsystem::TRAFFIC_BUFFERS] };
+	trafficBuffers += getHeapBytes(m_outputTrafficInfoBuffer)
+		+ getHeapBytes(m_outputTrafficDataBuffer)
+		+ getHeapBytes(m_inputTrafficInfoBuffer)
+		+ getHeapBytes(m_inputTrafficDataBuffer);
+	for (auto& data : m_outputTrafficDataBuffer)
+		trafficBuffers += getHeapBytes(data);
+	for (auto& data : m_inputTrafficDataBuffer)
+		trafficBuffers += getHeapBytes(data);
+
+	footprint[MemorySubsystem::REORDER_BUFFERS] += getHeapBytes(m_reorderBuffer);
+	footprint[MemorySubsystem::SOURCE_QUEUES] += getHeapBytes(m_sourceQueue)
+		+ getHeapBytes(m_sourceQueueDepthHistogram);
 }
 
-void TerminalInterface::runOneCycle()
+void TerminalInterface::resetSourceQueueStatistics()
 {
-	injectTraffic();
-	receiveCredit();
-	sendFlit();
-	receiveFlit();
+	m_stalledPacketNumber = 0;
+	m_droppedPacketNumber = 0;
+	m_sourceQueueDepthHistogram.clear();
+}
+
+int TerminalInterface::getDepthBucket(const size_t depth)
+{
+	return static_cast<int>(std::bit_width(depth));
+}
+
+size_t TerminalInterface::getDepthBucketStart(const int bucket)
+{
+	return bucket ? size_t{ 1 } << (bucket - 1) : 0;
+}
+
+TrafficInformationEntry TerminalInterface::drawPacket(const int packetID,
+	const int terminalNumber)
+{
+	int packetSize{ g_packetSize };
+	if (g_packetSizeOption == "random uniform")
+		packetSize = std::uniform_int_distribution<>{ 1, g_packetSize }(m_trafficGenerator);
+	int destination{ m_fixedDestination };
+	std::uniform_int_distribution<> randomDestination(-terminalNumber, -1);
+	while (!destination || destination == m_terminalInterfaceID)
+		destination = randomDestination(m_trafficGenerator);
+	return { packetID, m_terminalInterfaceID, destination, packetSize, "V", 0, 0 };
 }
 
 bool TerminalInterface::operator==(
@@ -43,58 +119,161 @@ bool TerminalInterface::operator==(
 
 void TerminalInterface::injectTraffic()
 {
-	static std::random_device rd;
-	static std::mt19937 gen(rd());  // Static generator for consistency
-	std::bernoulli_distribution distBernoulli(g_injectionRate);
-	std::bernoulli_distribution distMMPOnState(g_alpha / (g_alpha + g_beta));
+	if (g_injectionProcess == "trace")
+	{
+		if (!m_traceReplay)
+			return;
+		// every packet recorded up to this cycle; under stall the packets
+		// stay in the trace while the source queue is full
+		TrafficInformationEntry entry{};
+		while ((m_sourceQueuePolicy == SourceQueuePolicy::DROP || hasSourceQueueRoom())
+			&& m_traceReplay->getPacket(m_terminalInterfaceID,
+				m_clock.get(), entry))
+			offerPacket(entry);
+		return;
+	}
+	// one cycle of the injection process a cycle, more while catching up
+	while (m_injectionCycle <= m_clock.get())
+	{
+		if (!m_packetDue)
+			m_packetDue = isPacketDue(m_injectionCycle);
+		if (m_packetDue && !offerPacket(m_injectionCycle))
+			return; // stalled until there is room
+		m_packetDue = false;
+		++m_injectionCycle;
+	}
+}
 
+bool TerminalInterface::isPacketDue(const double cycle)
+{
 	if (g_injectionProcess == "periodic")
 	{
-		if (m_clock.trigger())
-		{
-			readPacket();
-			m_clock.set(1 / g_injectionRate);
-		}
+		if (!m_clock.trigger(cycle))
+			return false;
+		m_clock.set(1 / g_injectionRate);
+		return true;
 	}
-	else if (g_injectionProcess == "bernoulli")
+	std::bernoulli_distribution distBernoulli(g_injectionRate);
+	if (g_injectionProcess == "bernoulli")
+		return distBernoulli(m_injectionGenerator);
+	std::bernoulli_distribution distMMPOnState(g_alpha / (g_alpha + g_beta));
+	if (g_injectionProcess == "markov modulated process")
+		return distMMPOnState(m_injectionGenerator) && distBernoulli(m_injectionGenerator);
+	return false;
+}
+
+bool TerminalInterface::hasSourceQueueRoom() const
+{
+	return g_sourceQueueCapacity <= 0
+		|| m_sourceQueue.size() < static_cast<size_t>(g_sourceQueueCapacity);
+}
+
+bool TerminalInterface::offerPacket(const double offerTime)
+{
+	if (hasSourceQueueRoom())
 	{
-		if (distBernoulli(gen))
-			readPacket();
+		// a packet offered before this cycle waited for room
+		if (offerTime < m_clock.get())
+			m_stalledPacketNumber++;
+		readPacket(offerTime);
 	}
-	else if (g_injectionProcess == "markov modulated process")
+	else if (m_sourceQueuePolicy == SourceQueuePolicy::DROP)
 	{
-		if (distMMPOnState(gen))
-		{
-			if (distBernoulli(gen))
-				readPacket();
-		}
+		dropPacket();
+		m_droppedPacketNumber++;
 	}
+	else
+		return false;
+	return true;
 }
 
-void TerminalInterface::readPacket()
+void TerminalInterface::offerPacket(TrafficInformationEntry& entry)
 {
-	for (size_t i{}; i < m_outputTrafficInfoBuffer.size(); ++i)
+	// only a drop policy offers a packet to a full source queue
+	if (!hasSourceQueueRoom())
 	{
-		if (m_outputTrafficInfoBuffer.at(i).m_status == "V")
-		{
-			m_outputTrafficInfoBuffer.at(i).m_status = "S";
-			m_outputTrafficInfoBuffer.at(i).m_sentTime = m_clock.get();
+		m_droppedPacketNumber++;
+		return;
+	}
+	// a packet recorded before this cycle waited in the trace for room
+	if (entry.m_sentTime < m_clock.get())
+		m_stalledPacketNumber++;
+	replayPacket(entry);
+}
 
-			Packet packet{ m_outputTrafficInfoBuffer.at(i).m_packetID,
-			m_outputTrafficInfoBuffer.at(i).m_source,
-			m_outputTrafficInfoBuffer.at(i).m_destination,
-			m_outputTrafficDataBuffer.at(i) };
+void TerminalInterface::readPacket(const double offerTime)
+{
+	if (m_drawnTerminalNumber)
+	{
+		if (m_nextPacket >= static_cast<size_t>(g_packetNumber))
+			return;
+		TrafficInformationEntry entry{ drawPacket(static_cast<int>(m_nextPacket++),
+			m_drawnTerminalNumber) };
+		std::vector<float> data{};
+		for (int i{}; i < entry.m_packetSize; ++i)
+			data.push_back(i);
+		sendPacket(entry, data, offerTime);
+		return;
+	}
+	// the packets before the cursor are sent or dropped
+	if (m_nextPacket >= m_outputTrafficInfoBuffer.size())
+		return;
+	sendPacket(m_outputTrafficInfoBuffer.at(m_nextPacket),
+		m_outputTrafficDataBuffer.at(m_nextPacket), offerTime);
+	++m_nextPacket;
+}
 
-			makeFlits(packet); // make flits and send it into source queue
-			break;
-		}
+void TerminalInterface::dropPacket()
+{
+	// a dropped packet is never sent; it is "D" in TrafficInformation.csv
+	if (m_drawnTerminalNumber)
+	{
+		if (m_nextPacket < static_cast<size_t>(g_packetNumber))
+			drawPacket(static_cast<int>(m_nextPacket++), m_drawnTerminalNumber);
 	}
+	else if (m_nextPacket < m_outputTrafficInfoBuffer.size())
+		m_outputTrafficInfoBuffer.at(m_nextPacket++).m_status = "D";
+}
+
+void TerminalInterface::replayPacket(TrafficInformationEntry& entry)
+{
+	// the flits carry whole data words
+	std::vector<float> data{};
+	const int dataSize{ (entry.m_packetSize + g_flitSize - 1)
+		/ g_flitSize * g_flitSize };
+	for (int i{}; i < dataSize; ++i)
+		data.push_back(i);
+	entry.m_packetSize = dataSize;
+
+	sendPacket(entry, data, entry.m_sentTime); // the recorded cycle
+}
+
+void TerminalInterface::sendPacket(TrafficInformationEntry& entry,
+	const std::vector<float>& data, const double offerTime)
+{
+	entry.m_status = "S";
+	entry.m_sentTime = offerTime;
+
+	Packet packet{ entry.m_packetID, entry.m_source, entry.m_destination, data };
+	packet.m_sentTime = offerTime;
+
+	if (m_packetSink)
+		m_packetSink->writeSentPacket(entry);
+
+	makeFlits(packet); // make flits and send it into source queue
 }
 
 void TerminalInterface::makeFlits(const Packet& packet)
 {
+	const size_t head{ m_sourceQueue.size() };
+	// distributed routing: the head carries the destination only; in
+	// source routing it points into the route, which stays here
 	m_sourceQueue.push_back({ packet.m_source,
-		getRoute(packet.m_destination) }); // H
+		m_routingFunction.isDistributed() ? std::span<const int>{}
+		: getRoute(packet.m_destination) }); // H
+	m_sourceQueue.back().m_sentTime = packet.m_sentTime;
+	m_sourceQueue.back().m_destination = packet.m_destination;
+	m_routingFunction.preparePacket(m_sourceQueue.back(), m_routingGenerator);
 
 	for (size_t i{}; i < packet.m_data.size(); i += static_cast<size_t>(g_flitSize)) // B
 	{
@@ -105,16 +284,22 @@ void TerminalInterface::makeFlits(const Packet& packet)
 	}
 
 	m_sourceQueue.push_back({ packet.m_packetID }); // T
+	FlitTracer::tagPacket(m_sourceQueue.begin() + head, m_sourceQueue.end(),
+		packet.m_packetID);
+	Telemetry::countInjection();
 }
 
-std::deque<int> TerminalInterface::getRoute(const int destination)
+std::span<const int> TerminalInterface::getRoute(const int destination) const
 {
+	if (m_routeTable)
+		return m_routeTable->getRoute(-m_terminalInterfaceID - 1,
+			-destination - 1);
 	for (auto& entry : m_sourceRoutingTable)
 	{
 		if (entry.back() == destination)
 			return entry;
 	}
-	return {}; // Return empty deque if route not found
+	return {}; // Return empty route if not found
 }
 
 void TerminalInterface::sendFlit()
@@ -142,7 +327,9 @@ bool TerminalInterface::allocateVirtualChannel()
 	for (int i{}; i < g_virtualChannelNumber; ++i)
 	{
 		if (m_port.m_controlFields.at(i).m_downstreamVirtualChannelState
-			== VirtualChannelState::I)
+			== VirtualChannelState::I &&
+			(m_routingFunction.admitsVirtualChannel(m_sourceQueue.front(), i)
+				|| m_routingFunction.admitsEscapeVirtualChannel(i, -1)))
 		{
 			// the first input control field allocated virtual channel
 			// is used to record vc allocation result of source queue
@@ -162,6 +349,8 @@ void TerminalInterface::moveFlitOut()
 	// change flit virtual channel field
 	flit.m_flitVirtualChannel
 		= m_port.m_controlFields.front().m_allocatedVirtualChannel;
+	if (flit.m_flitType == FlitType::H)
+		flit.m_networkEntryTime = m_clock.get();
 	// push flit into output port output register
 	m_port.m_outputRegister.pushbackFlit(flit);
 	// decrement output port virtual channel credit
@@ -176,6 +365,8 @@ void TerminalInterface::moveFlitOut()
 		m_port.m_controlFields.at(
 			m_port.m_controlFields.front().m_allocatedVirtualChannel)
 		.m_downstreamVirtualChannelState = VirtualChannelState::C;
+	FlitTracer::trace(flit, FlitTraceEvent::SEND, m_terminalInterfaceID,
+		m_port.m_portID, flit.m_flitVirtualChannel);
 	// pop out flit
 	m_sourceQueue.pop_front();
 }
@@ -202,6 +393,10 @@ void TerminalInterface::receiveFlit()
 	if (m_port.m_inputRegister.m_flitEnable)
 	{
 		Flit flit{ m_port.m_inputRegister.popfrontFlit() };
+		if (flit.m_flitType == FlitType::H)
+			flit.m_headArrivalTime = m_clock.get();
+		FlitTracer::trace(flit, FlitTraceEvent::EJECT, m_terminalInterfaceID,
+			m_port.m_portID, flit.m_flitVirtualChannel);
 		m_reorderBuffer.push_back(flit);
 		if (flit.m_flitType == FlitType::T)
 			makePacket(flit);
@@ -220,7 +415,10 @@ void TerminalInterface::makePacket(const Flit& flit)
 			{
 			case FlitType::H:
 				packet.m_source = entry.m_source;
-				packet.m_destination = entry.m_route.back();
+				packet.m_destination = entry.m_destination;
+				packet.m_sentTime = entry.m_sentTime;
+				packet.m_networkEntryTime = entry.m_networkEntryTime;
+				packet.m_headArrivalTime = entry.m_headArrivalTime;
 				break;
 			case FlitType::B:
 				for (auto& data : entry.m_flitData)
@@ -238,9 +436,20 @@ void TerminalInterface::makePacket(const Flit& flit)
 
 void TerminalInterface::writePacket(const Packet& packet)
 {
-	m_inputTrafficInfoBuffer.push_back({ packet.m_packetID,
+	TrafficInformationEntry entry{ packet.m_packetID,
 	packet.m_source, packet.m_destination, static_cast<int>(packet.m_data.size()),
-	"R", 0, m_clock.get() });
+	"R", packet.m_sentTime, m_clock.get() };
+	entry.m_networkEntryTime = packet.m_networkEntryTime;
+	entry.m_headArrivalTime = packet.m_headArrivalTime;
+	Telemetry::countDelivery(entry.m_receivedTime - entry.m_sentTime - 1);
+
+	// the sink consumes the packet immediately; nothing is retained
+	if (m_packetSink)
+	{
+		m_packetSink->writeReceivedPacket(entry, packet.m_data);
+		return;
+	}
 
+	m_inputTrafficInfoBuffer.push_back(entry);
 	m_inputTrafficDataBuffer.push_back(packet.m_data);
 }
@@ -2,6 +2,19 @@
 #include "DataStructures.h"
 #include "Port.h"
 #include "Clock.h"
+#include "PacketSink.h"
+#include "TraceReplay.h"
+#include "RouteTable.h"
+#include "RoutingFunction.h"
+
+struct MemoryFootprint;
+
+// what a source does with a packet that is due while its source queue is full
+enum class SourceQueuePolicy
+{
+	STALL, // the injection process waits; the packet keeps its offer cycle
+	DROP   // the packet is never sent
+};
 
 class TerminalInterface
 {
@@ -9,8 +22,15 @@ public:
 	TerminalInterface(const int terminalInterfaceID);
 
 	Port* getPort(const int portID);
-	void updateEnable(); // update port input registers enable
 	void runOneCycle();
+	void measureMemory(MemoryFootprint& footprint) const;
+	void resetSourceQueueStatistics();
+	// source queue depths of a bucket start at 0, 1, 2, 4, 8, ...
+	static int getDepthBucket(const size_t depth);
+	static size_t getDepthBucketStart(const int bucket);
+	// the next random uniform packet of this source, whether it is
+	// generated ahead or when it is due
+	TrafficInformationEntry drawPacket(const int packetID, const int terminalNumber);
 	bool operator==(
 		const TerminalInterface& terminalInterface) const;
 
@@ -18,9 +38,21 @@ private:
 	// read packet from files, make filts,
 	// and push them into source queue
 	void injectTraffic();
-	void readPacket();
+	// whether the injection process offers a packet at the cycle
+	bool isPacketDue(const double cycle);
+	bool hasSourceQueueRoom() const;
+	// a generated packet is due; false if it has to wait for room
+	bool offerPacket(const double offerTime);
+	void offerPacket(TrafficInformationEntry& entry); // a replayed packet is due
+	// a packet is sent at the cycle it was offered, so the wait for room
+	// in the source queue counts in its latency
+	void readPacket(const double offerTime);
+	void dropPacket();
+	void replayPacket(TrafficInformationEntry& entry);
+	void sendPacket(TrafficInformationEntry& entry, const std::vector<float>& data,
+		const double offerTime);
 	void makeFlits(const Packet& packet);
-	std::deque<int> getRoute(const int destination);
+	std::span<const int> getRoute(const int destination) const;
 
 	// send flit out from source queue
 	void sendFlit();
@@ -38,14 +70,39 @@ private:
 
 public:
 	Clock m_clock{};
+	PacketSink* m_packetSink{}; // not owned; received packets are retained if there is no sink
+	TraceReplay* m_traceReplay{}; // not owned; source of packets if injection process is "trace"
 	int m_terminalInterfaceID{}; // ID starts from -1, -2, ...
 	Coordinate m_terminalInterfaceIDTorus{}; // (x, y, z) ID in Torus network, converted from Router ID
 	Port m_port{}; // port ID is the same as the Router ID that it connects to
-	std::vector<std::deque<int>> m_sourceRoutingTable{}; // the back() element is the destination terminal interface ID
+	std::vector<std::vector<int>> m_sourceRoutingTable{}; // the back() element is the destination terminal interface ID
+	const RouteTable* m_routeTable{}; // not owned; used instead of the source routing table if set
+	RoutingFunction m_routingFunction{}; // routing function of the attached router
+	std::mt19937 m_routingGenerator{}; // per-packet routing choices
+	std::mt19937 m_trafficGenerator{}; // destinations and sizes of drawn packets
+	std::mt19937 m_injectionGenerator{}; // bernoulli and MMP injection
+	// destinations of packets drawn when they are due, instead of read
+	// from the output traffic buffers; 0 if the traffic was generated ahead
+	int m_drawnTerminalNumber{};
+	int m_fixedDestination{}; // destination of every packet of a permutation; 0 if random
+	size_t m_nextPacket{}; // packet ID of the next packet read, drawn or dropped
 	std::deque<Flit> m_sourceQueue{};
+	SourceQueuePolicy m_sourceQueuePolicy{};
+	// the injection process has run up to this cycle; a stalled source
+	// falls behind and catches up once there is room, so a deferred packet
+	// keeps its offer cycle without a queue of them; replayed packets wait
+	// in the trace instead
+	double m_injectionCycle{};
+	bool m_packetDue{}; // a packet offered at m_injectionCycle waits for room
+	long long m_stalledPacketNumber{}; // packets sent late for room since the last reset
+	long long m_droppedPacketNumber{}; // packets dropped since the last reset
+	std::vector<long long> m_sourceQueueDepthHistogram{}; // cycles per depth bucket since the last reset
 	std::vector<Flit> m_reorderBuffer{};
 	std::vector<TrafficInformationEntry> m_outputTrafficInfoBuffer{};
 	std::vector<std::vector<float>> m_outputTrafficDataBuffer{};
 	std::vector<TrafficInformationEntry> m_inputTrafficInfoBuffer{};
 	std::vector<std::vector<float>> m_inputTrafficDataBuffer{};
+
+	// Friend classes for benchmarking
+	friend class TerminalInterfaceBenchmark;
 };
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "TraceReplay.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr char c_replayMagic[]{ "SOXRPL01" };
+constexpr size_t c_replayHeaderSize{ 16 };
+constexpr size_t c_releaseSize{ size_t{ 1 } << 24 }; // bytes per madvise
+constexpr size_t c_pendingPacketNumber{ 64 }; // queued packets per source
+constexpr unsigned long long c_notBehind{
+	std::numeric_limits<unsigned long long>::max() };
+
+TraceReplay::TraceReplay(const std::string& filePath, const int terminalNumber)
+	:
+	m_pendingPackets(terminalNumber),
+	m_packetIDs(terminalNumber),
+	m_lagCursors(terminalNumber, c_notBehind)
+{
+	m_fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+	struct stat fileStatus {};
+	if (m_fileDescriptor < 0 || ::fstat(m_fileDescriptor, &fileStatus) != 0
+		|| static_cast<size_t>(fileStatus.st_size) < c_replayHeaderSize)
+	{
+		std::cerr << "Error: Could not open replay trace: " << filePath << "\n";
+		return;
+	}
+
+	m_mappingSize = static_cast<size_t>(fileStatus.st_size);
+	void* mapping{ ::mmap(nullptr, m_mappingSize, PROT_READ, MAP_PRIVATE,
+		m_fileDescriptor, 0) };
+	if (mapping == MAP_FAILED)
+	{
+		std::cerr << "Error: Could not map replay trace: " << filePath << "\n";
+		return;
+	}
+	m_mapping = static_cast<const char*>(mapping);
+	// the cursor only moves forward
+	::madvise(mapping, m_mappingSize, MADV_SEQUENTIAL);
+
+	if (std::memcmp(m_mapping, c_replayMagic, 8) != 0)
+	{
+		std::cerr << "Error: Not a replay trace: " << filePath << "\n";
+		return;
+	}
+	std::memcpy(&m_recordNumber, m_mapping + 8, sizeof(m_recordNumber));
+	// a truncated file replays the records it holds
+	m_recordNumber = std::min<unsigned long long>(m_recordNumber,
+		(m_mappingSize - c_replayHeaderSize) / sizeof(ReplayRecord));
+	m_records = reinterpret_cast<const ReplayRecord*>(
+		m_mapping + c_replayHeaderSize);
+	if (m_recordNumber)
+		m_firstCycle = m_records[0].m_cycle;
+}
+
+TraceReplay::~TraceReplay()
+{
+	if (m_skippedRecordNumber)
+		std::cerr << "Warning: " << m_skippedRecordNumber
+		<< " replay records with invalid terminals skipped\n";
+	if (m_mapping)
+		::munmap(const_cast<char*>(m_mapping), m_mappingSize);
+	if (m_fileDescriptor >= 0)
+		::close(m_fileDescriptor);
+}
+
+bool TraceReplay::isOpen()
+{
+	return m_records;
+}
+
+unsigned long long TraceReplay::getRecordNumber()
+{
+	return m_recordNumber;
+}
+
+bool TraceReplay::getPacket(const int terminalInterfaceID, const double cycle,
+	TrafficInformationEntry& entry)
+{
+	advance(cycle);
+	const int source{ -terminalInterfaceID - 1 };
+	std::deque<TrafficInformationEntry>& pendingPackets{
+		m_pendingPackets.at(source) };
+	if (pendingPackets.empty() && m_lagCursors.at(source) < m_cursor)
+		catchUp(source);
+	if (pendingPackets.empty())
+		return false;
+	entry = pendingPackets.front();
+	pendingPackets.pop_front();
+	return true;
+}
+
+void TraceReplay::advance(const double cycle)
+{
+	for (; m_cursor < m_recordNumber; ++m_cursor)
+	{
+		const ReplayRecord& record{ m_records[m_cursor] };
+		if (static_cast<double>(record.m_cycle - m_firstCycle) > cycle)
+			break;
+		if (!isValid(record))
+		{
+			m_skippedRecordNumber++;
+			continue;
+		}
+		// a source behind reads its records from its own cursor
+		unsigned long long& lagCursor{ m_lagCursors.at(record.m_source) };
+		if (lagCursor < m_cursor)
+			continue;
+		if (m_pendingPackets.at(record.m_source).size() >= c_pendingPacketNumber)
+		{
+			lagCursor = m_cursor;
+			continue;
+		}
+		queuePacket(record);
+	}
+	releaseConsumedPages();
+}
+
+bool TraceReplay::isValid(const ReplayRecord& record) const
+{
+	const size_t terminalNumber{ m_pendingPackets.size() };
+	return record.m_source < terminalNumber
+		&& record.m_destination < terminalNumber
+		&& record.m_source != record.m_destination && record.m_packetSize;
+}
+
+void TraceReplay::queuePacket(const ReplayRecord& record)
+{
+	m_pendingPackets.at(record.m_source).push_back({
+		m_packetIDs.at(record.m_source)++,
+		-record.m_source - 1, -record.m_destination - 1,
+		static_cast<int>(record.m_packetSize), "V",
+		static_cast<double>(record.m_cycle - m_firstCycle), 0 });
+}
+
+void TraceReplay::catchUp(const int source)
+{
+	// invalid records were counted when the shared cursor passed them
+	unsigned long long& lagCursor{ m_lagCursors.at(source) };
+	while (lagCursor < m_cursor)
+	{
+		const ReplayRecord& record{ m_records[lagCursor++] };
+		if (record.m_source == source && isValid(record))
+		{
+			queuePacket(record);
+			break;
+		}
+	}
+	// caught up with the shared cursor
+	if (lagCursor == m_cursor)
+		lagCursor = c_notBehind;
+}
+
+void TraceReplay::releaseConsumedPages()
+{
+	size_t consumedSize{ c_replayHeaderSize
+		+ static_cast<size_t>(m_cursor) * sizeof(ReplayRecord) };
+	if (consumedSize < m_releasedSize + c_releaseSize)
+		return;
+	// the records of sources behind are still to be read
+	const unsigned long long lagCursor{ *std::min_element(
+		m_lagCursors.begin(), m_lagCursors.end()) };
+	if (lagCursor < m_cursor)
+		consumedSize = c_replayHeaderSize
+		+ static_cast<size_t>(lagCursor) * sizeof(ReplayRecord);
+	if (consumedSize < m_releasedSize + c_releaseSize)
+		return;
+	// whole pages that every cursor has passed
+	const size_t pageSize{ static_cast<size_t>(::sysconf(_SC_PAGESIZE)) };
+	const size_t releaseEnd{ consumedSize / pageSize * pageSize };
+	::madvise(const_cast<char*>(m_mapping) + m_releasedSize,
+		releaseEnd - m_releasedSize, MADV_DONTNEED);
+	m_releasedSize = releaseEnd;
+}
+
+bool convertReplayTrace(const std::string& csvFilePath,
+	const std::string& traceFilePath)
+{
+	std::ifstream readTrace(csvFilePath, std::ios::in);
+	if (!readTrace.is_open())
+	{
+		std::cerr << "Error: Could not open trace: " << csvFilePath << "\n";
+		return false;
+	}
+
+	std::vector<ReplayRecord> records{};
+	std::string line{};
+	std::getline(readTrace, line); // head line
+	while (std::getline(readTrace, line))
+	{
+		std::istringstream lineInString{ line };
+		std::string cycle{}, source{}, destination{}, packetSize{};
+		std::getline(lineInString, cycle, ',');
+		std::getline(lineInString, source, ',');
+		std::getline(lineInString, destination, ',');
+		std::getline(lineInString, packetSize, ',');
+		if (packetSize.empty())
+			continue;
+		records.push_back({ std::stoull(cycle),
+			static_cast<unsigned short>(std::stoi(source)),
+			static_cast<unsigned short>(std::stoi(destination)),
+			static_cast<unsigned int>(std::stoul(packetSize)) });
+	}
+	std::stable_sort(records.begin(), records.end(),
+		[](const ReplayRecord& a, const ReplayRecord& b) {
+			return a.m_cycle < b.m_cycle; });
+
+	std::ofstream writeTrace(traceFilePath, std::ios::out | std::ios::binary);
+	if (!writeTrace.is_open())
+	{
+		std::cerr << "Error: Could not open trace: " << traceFilePath << "\n";
+		return false;
+	}
+	const unsigned long long recordNumber{ records.size() };
+	writeTrace.write(c_replayMagic, 8);
+	writeTrace.write(reinterpret_cast<const char*>(&recordNumber),
+		sizeof(recordNumber));
+	writeTrace.write(reinterpret_cast<const char*>(records.data()),
+		static_cast<std::streamsize>(records.size() * sizeof(ReplayRecord)));
+	return true;
+}
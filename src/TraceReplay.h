@@ -0,0 +1,71 @@
+#pragma once
+#include "DataStructures.h"
+
+// Replay trace (.rpl): packets captured from a real workload
+//
+// file   := "SOXRPL01" u64(recordNumber) record*
+// record := u64(cycle) u16(source) u16(destination) u32(packetSize)
+//
+// Little-endian, records sorted by cycle. Sources and destinations are
+// node numbers from 0, node n is terminal interface -n-1. Cycles are
+// replayed relative to the first record.
+struct ReplayRecord
+{
+	unsigned long long m_cycle{};
+	unsigned short m_source{};
+	unsigned short m_destination{};
+	unsigned int m_packetSize{};
+};
+static_assert(sizeof(ReplayRecord) == 16);
+
+// memory-maps a replay trace and injects its packets at their recorded
+// cycles; a single cursor walks the trace once and hands every due
+// record to the queue of its source terminal, and the pages behind the
+// cursor are released, so only the window being replayed is resident.
+// A source that stops taking packets, because its source queue is full,
+// falls behind: its queue is capped, and its further records stay in the
+// trace until it reads them from its own cursor
+class TraceReplay
+{
+public:
+	TraceReplay(const std::string& filePath, const int terminalNumber);
+	~TraceReplay();
+	TraceReplay(const TraceReplay&) = delete;
+	TraceReplay& operator=(const TraceReplay&) = delete;
+
+	bool isOpen();
+	unsigned long long getRecordNumber();
+	// pop the next packet the source terminal has to inject by cycle, sent
+	// at its recorded cycle; false if there is none
+	bool getPacket(const int terminalInterfaceID, const double cycle,
+		TrafficInformationEntry& entry);
+
+private:
+	void advance(const double cycle);
+	bool isValid(const ReplayRecord& record) const;
+	void queuePacket(const ReplayRecord& record);
+	// queue the next record of a source that fell behind
+	void catchUp(const int source);
+	void releaseConsumedPages();
+
+private:
+	int m_fileDescriptor{ -1 };
+	const char* m_mapping{};
+	size_t m_mappingSize{};
+	const ReplayRecord* m_records{};
+	unsigned long long m_recordNumber{};
+	unsigned long long m_cursor{};
+	unsigned long long m_firstCycle{};
+	size_t m_releasedSize{}; // bytes at the front already released
+	std::vector<std::deque<TrafficInformationEntry>> m_pendingPackets{}; // per source
+	std::vector<int> m_packetIDs{}; // next packet ID per source
+	// per source, the first record left in the trace since its queue was
+	// full; the largest cursor if the source is not behind
+	std::vector<unsigned long long> m_lagCursors{};
+	long long m_skippedRecordNumber{};
+};
+
+// convert a "cycle,source,destination,packetSize" CSV (with a head line)
+// into a replay trace; records are sorted by cycle
+bool convertReplayTrace(const std::string& csvFilePath,
+	const std::string& traceFilePath);
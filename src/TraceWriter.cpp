@@ -0,0 +1,181 @@
+#include "TraceWriter.h"
+#include <charconv>
+
+TraceWriter::TraceWriter(const std::string& filePath,
+	const size_t bufferSize,
+	const int bufferNumber,
+	const BackpressurePolicy policy)
+	:
+	m_bufferSize{ bufferSize },
+	m_policy{ policy }
+{
+	m_file.open(filePath, std::ios::out | std::ios::binary);
+	if (!m_file.is_open())
+	{
+		std::cerr << "Error: Could not open trace file: " << filePath << "\n";
+		return;
+	}
+
+	m_buffer.reserve(m_bufferSize);
+	// the producer always owns one buffer, the rest start out free
+	for (int i{ 1 }; i < std::max(bufferNumber, 2); ++i)
+	{
+		m_freeBuffers.push_back({});
+		m_freeBuffers.back().reserve(m_bufferSize);
+	}
+	m_ioThread = std::thread{ &TraceWriter::runIOThread, this };
+}
+
+TraceWriter::TraceWriter(const std::string& filePath)
+	:
+	TraceWriter{ filePath,
+		static_cast<size_t>(g_traceBufferSize),
+		g_traceBufferNumber,
+		parseBackpressurePolicy(g_traceBackpressure) } {
+}
+
+TraceWriter::~TraceWriter()
+{
+	close();
+}
+
+TraceWriter& TraceWriter::operator<<(const std::string_view text)
+{
+	m_buffer.append(text);
+	return *this;
+}
+
+TraceWriter& TraceWriter::operator<<(const char character)
+{
+	m_buffer.push_back(character);
+	return *this;
+}
+
+TraceWriter& TraceWriter::operator<<(const int value)
+{
+	return *this << static_cast<long long>(value);
+}
+
+TraceWriter& TraceWriter::operator<<(const long long value)
+{
+	char digits[24]{};
+	auto [end, error] { std::to_chars(std::begin(digits),
+		std::end(digits), value) };
+	m_buffer.append(digits, end);
+	return *this;
+}
+
+TraceWriter& TraceWriter::operator<<(const float value)
+{
+	char digits[32]{};
+	auto [end, error] { std::to_chars(std::begin(digits),
+		std::end(digits), value) };
+	m_buffer.append(digits, end);
+	return *this;
+}
+
+TraceWriter& TraceWriter::operator<<(const double value)
+{
+	char digits[32]{};
+	auto [end, error] { std::to_chars(std::begin(digits),
+		std::end(digits), value) };
+	m_buffer.append(digits, end);
+	return *this;
+}
+
+void TraceWriter::write(const char* data, const size_t size)
+{
+	m_buffer.append(data, size);
+}
+
+void TraceWriter::endRecord()
+{
+	m_bufferedRecordNumber++;
+	if (m_buffer.size() >= m_bufferSize)
+		handOffBuffer(m_policy);
+}
+
+void TraceWriter::close()
+{
+	if (!m_ioThread.joinable())
+		return;
+	// the last buffer is always written out
+	if (!m_buffer.empty())
+		handOffBuffer(BackpressurePolicy::Block);
+	{
+		std::lock_guard lock{ m_mutex };
+		m_closing = true;
+	}
+	m_condition.notify_all();
+	m_ioThread.join();
+	m_file.close();
+}
+
+bool TraceWriter::isOpen()
+{
+	return m_ioThread.joinable();
+}
+
+long long TraceWriter::getDroppedRecordNumber()
+{
+	return m_droppedRecordNumber;
+}
+
+void TraceWriter::handOffBuffer(const BackpressurePolicy policy)
+{
+	if (!m_ioThread.joinable())
+	{
+		// no file to write to
+		m_buffer.clear();
+		return;
+	}
+
+	std::unique_lock lock{ m_mutex };
+	if (m_freeBuffers.empty())
+	{
+		if (policy == BackpressurePolicy::Drop)
+		{
+			m_droppedRecordNumber += m_bufferedRecordNumber;
+			m_bufferedRecordNumber = 0;
+			m_buffer.clear();
+			return;
+		}
+		m_condition.wait(lock, [this] { return !m_freeBuffers.empty(); });
+	}
+	m_fullBuffers.push_back(std::move(m_buffer));
+	m_buffer = std::move(m_freeBuffers.back());
+	m_freeBuffers.pop_back();
+	m_bufferedRecordNumber = 0;
+	lock.unlock();
+	m_condition.notify_all();
+}
+
+void TraceWriter::runIOThread()
+{
+	std::unique_lock lock{ m_mutex };
+	while (true)
+	{
+		m_condition.wait(lock, [this] {
+			return !m_fullBuffers.empty() || m_closing; });
+		if (m_fullBuffers.empty())
+			break; // closing and everything is written
+
+		std::string buffer{ std::move(m_fullBuffers.front()) };
+		m_fullBuffers.pop_front();
+		lock.unlock();
+		m_file.write(buffer.data(),
+			static_cast<std::streamsize>(buffer.size()));
+		buffer.clear();
+		lock.lock();
+		m_freeBuffers.push_back(std::move(buffer));
+		m_condition.notify_all();
+	}
+	m_file.flush();
+}
+
+BackpressurePolicy parseBackpressurePolicy(const std::string_view policy)
+{
+	if (policy == "drop")
+		return BackpressurePolicy::Drop;
+	return BackpressurePolicy::Block;
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "DataStructures.h"
+
+enum class BackpressurePolicy
+{
+	Block, // wait for the I/O thread; lossless
+	Drop // discard the filled buffer and count its records
+};
+
+// buffered trace file writer; the producing thread fills a large buffer
+// and hands it to a background I/O thread at record boundaries, so the
+// simulation loop never flushes per line. At most bufferNumber buffers
+// exist at any time, which bounds memory; when all of them are waiting
+// for the disk, the policy decides between blocking and dropping.
+// One writer serves one producing thread.
+class TraceWriter
+{
+public:
+	TraceWriter(const std::string& filePath,
+		const size_t bufferSize,
+		const int bufferNumber,
+		const BackpressurePolicy policy);
+	TraceWriter(const std::string& filePath);
+	~TraceWriter();
+	TraceWriter(const TraceWriter&) = delete;
+	TraceWriter& operator=(const TraceWriter&) = delete;
+
+	TraceWriter& operator<<(const std::string_view text);
+	TraceWriter& operator<<(const char character);
+	TraceWriter& operator<<(const int value);
+	TraceWriter& operator<<(const long long value);
+	TraceWriter& operator<<(const float value);
+	TraceWriter& operator<<(const double value);
+	void write(const char* data, const size_t size);
+	void endRecord(); // call after each complete record
+	void close(); // flush everything and join the I/O thread
+	bool isOpen();
+	long long getDroppedRecordNumber();
+
+private:
+	void handOffBuffer(const BackpressurePolicy policy);
+	void runIOThread();
+
+private:
+	std::ofstream m_file{};
+	size_t m_bufferSize{};
+	BackpressurePolicy m_policy{};
+	std::string m_buffer{}; // filled by the producing thread
+	long long m_bufferedRecordNumber{};
+	long long m_droppedRecordNumber{};
+
+	std::mutex m_mutex{};
+	std::condition_variable m_condition{};
+	std::deque<std::string> m_fullBuffers{}; // waiting for the I/O thread
+	std::vector<std::string> m_freeBuffers{};
+	bool m_closing{};
+	std::thread m_ioThread{};
+};
+
+BackpressurePolicy parseBackpressurePolicy(const std::string_view policy);
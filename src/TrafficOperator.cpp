@@ -4,11 +4,15 @@ TrafficOperator::TrafficOperator(const std::string_view trafficFolderPath,
 	RegularNetwork* network)
 	:
 	m_trafficFolderPath{ trafficFolderPath },
-	m_network{ network }
+	m_network{ network },
+	m_trafficInformationWriter{ m_trafficFolderPath + "TrafficInformation.csv",
+		static_cast<size_t>(g_traceBufferSize), g_traceBufferNumber,
+		BackpressurePolicy::Block },
+	m_trafficDataWriter{ m_trafficFolderPath + "TrafficData.csv",
+		static_cast<size_t>(g_traceBufferSize), g_traceBufferNumber,
+		BackpressurePolicy::Block }
 {
-	std::ofstream writeTrafficInformation(
-		m_trafficFolderPath + "TrafficInformation.csv", std::ios::out);
-	writeTrafficInformation
+	m_trafficInformationWriter
 		<< "PacketID" << ','
 		<< "Source" << ','
 		<< "Destination" << ','
@@ -16,147 +20,160 @@ TrafficOperator::TrafficOperator(const std::string_view trafficFolderPath,
 		<< "Status" << ','
 		<< "SentTime" << ','
 		<< "ReceivedTime" << ','
-		<< std::endl;
-	writeTrafficInformation.close();
+		<< '\n';
+	m_trafficInformationWriter.endRecord();
 
-	std::ofstream writeTrafficData(
-		m_trafficFolderPath + "TrafficData.csv", std::ios::out);
-	writeTrafficData << "Data" << ',' << std::endl;
-	writeTrafficData.close();
+	m_trafficDataWriter << "Data" << ',' << '\n';
+	m_trafficDataWriter.endRecord();
+
+	createPacketSink();
+	createTraceReplay();
+}
+
+TrafficOperator::~TrafficOperator()
+{
+	for (auto& terminalInterface : m_network->m_terminalInterfaces)
+	{
+		terminalInterface->m_packetSink = nullptr;
+		terminalInterface->m_traceReplay = nullptr;
+	}
+	delete m_packetSink;
+	m_packetSink = nullptr;
+	delete m_traceReplay;
+	m_traceReplay = nullptr;
 }
 
 void TrafficOperator::generateTraffic()
 {
+	if (m_traceReplay)
+		return; // packets come from the replay trace
 	if (g_trafficPattern == "random uniform")
 		generateRandom();
 }
 
 void TrafficOperator::generateTraffic(const int destination)
 {
+	if (m_traceReplay)
+		return;
 	if (g_trafficPattern == "permutation")
 		generatePermutation(destination);
 }
 
 void TrafficOperator::analyzeTraffic()
 {
-	updateTrafficInformation();
-	collectData();
+	// the generated traffic tables must be on disk before reading them back
+	m_trafficInformationWriter.close();
+	m_trafficDataWriter.close();
+
+	if (m_packetSink)
+	{
+		// received packets were not retained, statistics are online
+		m_packetSink->close();
+		m_trafficData = m_packetSink->m_trafficData;
+		m_windowStatistics = m_packetSink->m_windowStatistics;
+	}
+	else
+	{
+		updateTrafficInformation();
+		collectData();
+	}
 	calculatePerformance();
+	if (g_numpyExport)
+		writeNumpyResults();
 }
 
-void TrafficOperator::generateRandom()
+void TrafficOperator::createPacketSink()
 {
-#if REPRODUCE_RANDOM
-	std::mt19937 gen(MAGIC_NUMBER);  // to reproduce random numbers
-#else
-	std::random_device rd;
-	std::mt19937 gen(rd());  // to seed mersenne twister
-#endif
-	std::uniform_int_distribution<> randomDestination(-m_network->getRouterNumber(), -1);
-	// write append open TrafficInformation.csv
-	std::ofstream writeTrafficInformation(m_trafficFolderPath +
-		"TrafficInformation.csv", std::ios::app);
-	// write append open TrafficData.csv
-	std::ofstream writeTrafficData(m_trafficFolderPath +
-		"TrafficData.csv", std::ios::app);
-
-	for (int source{ -1 }; source >= -m_network->getRouterNumber(); --source)
-	{
-		for (int packetID{}; packetID < g_packetNumber; ++packetID)
-		{
-			// write TrafficData.csv
-			int packetSize{ g_packetSize };
-			if (g_packetSizeOption == "random uniform")
-				packetSize = uniformDistribution(1, g_packetSize);
-			for (int i{}; i < packetSize; ++i)
-				writeTrafficData << static_cast<float>(i) << ',';
-			writeTrafficData << std::endl;
-
-			// write m_outputTrafficDataBuffer in each terminal interface
-			std::vector<float> data{};
-			for (int i{}; i < packetSize; ++i)
-				data.push_back(i);
-			m_network->m_terminalInterfaces.at(-source - 1)->
-				m_outputTrafficDataBuffer.push_back(data);
+	// replayed packets are not in TrafficInformation.csv, so the buffered
+	// analysis could not find them
+	if (g_ejectionSink == "statistics"
+		|| (g_ejectionSink == "buffer" && g_injectionProcess == "trace"))
+		m_packetSink = new StatisticsSink{};
+	else if (g_ejectionSink == "trace" && g_traceFormat == "compact")
+		m_packetSink = new CompactTraceSink{ m_trafficFolderPath
+			+ "Traffic.sxt" };
+	else if (g_ejectionSink == "trace" && g_traceFormat == "npy")
+		m_packetSink = new NpyTraceSink{ m_trafficFolderPath
+			+ "ReceivedTraffic.npy" };
+	else if (g_ejectionSink == "trace")
+		m_packetSink = new TraceSink{ m_trafficFolderPath
+			+ "ReceivedTraffic.csv" };
+	else
+		return; // "buffer": terminals retain received packets
 
-			// write TrafficInformation.csv
-			int destination{};
-			do destination = randomDestination(gen);
-			while (destination == source);
-			writeTrafficInformation
-				<< packetID << ','
-				<< source << ','
-				<< destination << ','
-				<< packetSize << ','
-				<< "V" << ','
-				<< "-" << ','
-				<< "-" << ','
-				<< std::endl;
+	for (auto& terminalInterface : m_network->m_terminalInterfaces)
+		terminalInterface->m_packetSink = m_packetSink;
+}
 
-			// write m_outputTrafficInfoBuffer in each terminal interface
-			m_network->m_terminalInterfaces.at(-source - 1)->
-				m_outputTrafficInfoBuffer.push_back({
-					packetID, source, destination,
-					packetSize, "V", 0, 0});
-		}
-	}
+void TrafficOperator::createTraceReplay()
+{
+	if (g_injectionProcess != "trace")
+		return;
+	m_traceReplay = new TraceReplay{ std::string{ g_replayTraceFile },
+		m_network->getRouterNumber() };
+	for (auto& terminalInterface : m_network->m_terminalInterfaces)
+		terminalInterface->m_traceReplay = m_traceReplay;
+}
 
-	writeTrafficInformation.close();
-	writeTrafficData.close();
+void TrafficOperator::generateRandom()
+{
+	for (auto& terminalInterface : m_network->m_terminalInterfaces)
+		generatePackets(terminalInterface);
 }
 
 void TrafficOperator::generatePermutation(const int destination)
 {
-	// write append open TrafficInformation.csv
-	std::ofstream writeTrafficInformation(m_trafficFolderPath +
-		"TrafficInformation.csv", std::ios::app);
-	// write append open TrafficData.csv
-	std::ofstream writeTrafficData(m_trafficFolderPath +
-		"TrafficData.csv", std::ios::app);
+	for (auto& terminalInterface : m_network->m_terminalInterfaces)
+	{
+		if (terminalInterface->m_terminalInterfaceID == destination)
+			continue;
+		terminalInterface->m_fixedDestination = destination;
+		generatePackets(terminalInterface);
+	}
+}
 
-	for (int source{ -1 }; source >= -m_network->getRouterNumber(); --source)
+void TrafficOperator::generatePackets(TerminalInterface* terminalInterface)
+{
+	// every source draws its own packets, the same ones whether they are
+	// generated here or, with a sink, when they are due; nothing reads the
+	// tables back then, so the terminals do not hold the whole run
+	if (m_packetSink)
 	{
-		if (source != destination)
-		{
-			for (int packetID{}; packetID < g_packetNumber; ++packetID)
-			{
-				// write TrafficData.csv
-				int packetSize{ g_packetSize };
-				if (g_packetSizeOption == "random uniform")
-					packetSize = uniformDistribution(1, g_packetSize);
-				for (int i{}; i < packetSize; ++i)
-					writeTrafficData << static_cast<float>(i) << ',';
-				writeTrafficData << std::endl;
+		terminalInterface->m_drawnTerminalNumber = m_network->getRouterNumber();
+		return;
+	}
+	for (int packetID{}; packetID < g_packetNumber; ++packetID)
+	{
+		const TrafficInformationEntry entry{ terminalInterface->drawPacket(
+			packetID, m_network->getRouterNumber()) };
 
-				// write m_outputTrafficDataBuffer in each terminal interface
-				std::vector<float> data{};
-				for (int i{}; i < packetSize; ++i)
-					data.push_back(i);
-				m_network->m_terminalInterfaces.at(-source - 1)->
-					m_outputTrafficDataBuffer.push_back(data);
+		// write TrafficData.csv
+		for (int i{}; i < entry.m_packetSize; ++i)
+			m_trafficDataWriter << static_cast<float>(i) << ',';
+		m_trafficDataWriter << '\n';
+		m_trafficDataWriter.endRecord();
 
-				// write TrafficInformation.csv
-				writeTrafficInformation
-					<< packetID << ','
-					<< source << ','
-					<< destination << ','
-					<< packetSize << ','
-					<< "V" << ','
-					<< "-" << ','
-					<< "-" << ','
-					<< std::endl;
+		// write m_outputTrafficDataBuffer in each terminal interface
+		std::vector<float> data{};
+		for (int i{}; i < entry.m_packetSize; ++i)
+			data.push_back(i);
+		terminalInterface->m_outputTrafficDataBuffer.push_back(data);
 
-				// write m_outputTrafficInfoBuffer in each terminal interface
-				m_network->m_terminalInterfaces.at(-source - 1)->
-					m_outputTrafficInfoBuffer.push_back({
-						packetID, source, destination,
-						packetSize, "V", 0, 0 });
-			}
-		}
-	}
+		// write TrafficInformation.csv
+		m_trafficInformationWriter
+			<< entry.m_packetID << ','
+			<< entry.m_source << ','
+			<< entry.m_destination << ','
+			<< entry.m_packetSize << ','
+			<< "V" << ','
+			<< "-" << ','
+			<< "-" << ','
+			<< '\n';
+		m_trafficInformationWriter.endRecord();
 
-	writeTrafficInformation.close();
-	writeTrafficData.close();
+		// write m_outputTrafficInfoBuffer in each terminal interface
+		terminalInterface->m_outputTrafficInfoBuffer.push_back(entry);
+	}
 }
 
 //void TrafficOperator::generateCustomize()
@@ -190,14 +207,6 @@ void TrafficOperator::generatePermutation(const int destination)
 //	writeTrafficData.close();
 //}
 
-int TrafficOperator::uniformDistribution(const int min, const int max)
-{
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_int_distribution<> dist(min, max);
-	return dist(gen);
-}
-
 void TrafficOperator::updateTrafficInformation()
 {
 	// read open TrafficInformation.csv
@@ -213,7 +222,7 @@ void TrafficOperator::updateTrafficInformation()
 	// read the head line
 	std::getline(readPacketInformation, infoLine);
 	// write the head line into tmp file
-	writePacketInformation << infoLine << std::endl;
+	writePacketInformation << infoLine << '\n';
 	// read file line by line
 	while (std::getline(readPacketInformation, infoLine))
 	{
@@ -230,6 +239,15 @@ void TrafficOperator::updateTrafficInformation()
 			for (size_t i{}; i < m_network->m_terminalInterfaces.
 				at(-stoi(source) - 1)->m_outputTrafficInfoBuffer.size(); ++i)
 		{
+			if (m_network->m_terminalInterfaces.at(-stoi(source) - 1)
+				->m_outputTrafficInfoBuffer.at(i).m_packetID == stoi(packetID) &&
+				// dropped by a full source queue; it has no sent time
+				m_network->m_terminalInterfaces.at(-stoi(source) - 1)
+				->m_outputTrafficInfoBuffer.at(i).m_status == "D")
+			{
+				status = "D";
+				break;
+			}
 			if (m_network->m_terminalInterfaces.at(-stoi(source) - 1)
 				->m_outputTrafficInfoBuffer.at(i).m_packetID == stoi(packetID) &&
 				m_network->m_terminalInterfaces.at(-stoi(source) - 1)
@@ -247,6 +265,9 @@ void TrafficOperator::updateTrafficInformation()
 		{
 			if (m_network->m_terminalInterfaces.at(-stoi(destination) - 1)
 				->m_inputTrafficInfoBuffer.at(i).m_packetID == stoi(packetID) &&
+				// packet IDs are per source
+				m_network->m_terminalInterfaces.at(-stoi(destination) - 1)
+				->m_inputTrafficInfoBuffer.at(i).m_source == stoi(source) &&
 				m_network->m_terminalInterfaces.at(-stoi(destination) - 1)
 				->m_inputTrafficInfoBuffer.at(i).m_status == "R")
 			{
@@ -265,7 +286,7 @@ void TrafficOperator::updateTrafficInformation()
 			<< status << ','
 			<< sentTime << ','
 			<< receivedTime << ','
-			<< std::endl;
+			<< '\n';
 	}
 	readPacketInformation.close();
 	writePacketInformation.close();
@@ -284,6 +305,14 @@ void TrafficOperator::collectData()
 	std::istringstream infoLineInString{};
 	std::string packetID{}, source{}, destination{}, packetSize{},
 		status{}, sentTime{}, receivedTime{};
+	// TrafficInformation.csv as a .npy file; unknown times are NaN
+	NpyWriter* npyWriter{};
+	if (g_numpyExport)
+		npyWriter = new NpyWriter{ m_trafficFolderPath
+			+ "TrafficInformation.npy", getTrafficInformationFields() };
+	auto parseTime{ [](const std::string& time) {
+		return time == "-" ? std::numeric_limits<double>::quiet_NaN()
+			: std::stod(time); } };
 	// read the head line
 	std::getline(readPacketInformation, infoLine);
 	while (std::getline(readPacketInformation, infoLine))
@@ -297,42 +326,118 @@ void TrafficOperator::collectData()
 		std::getline(infoLineInString, status, ',');
 		std::getline(infoLineInString, sentTime, ',');
 		std::getline(infoLineInString, receivedTime, ',');
-		if (status != "V")
+		if (npyWriter)
+			npyWriter->write(makeTrafficInformationRecord({ std::stoi(packetID),
+				std::stoi(source), std::stoi(destination), std::stoi(packetSize),
+				status, parseTime(sentTime), parseTime(receivedTime) }));
+		if (status == "S" || status == "R")
 		{
+			m_windowStatistics.addSentPacket(std::stod(sentTime),
+				std::stoi(packetSize));
+			if (status == "R")
+				m_windowStatistics.addReceivedPacket(std::stod(sentTime),
+					std::stod(receivedTime), std::stoi(packetSize));
 			if (status == "R")
 			{
-				if (std::stoi(receivedTime) >= g_warmupCycles
-					&& std::stoi(receivedTime) <
+				if (std::stod(receivedTime) >= g_warmupCycles
+					&& std::stod(receivedTime) <
 					(g_warmupCycles + g_measurementCycles))
 				{
 					m_trafficData.m_receivedPacketNumber++;
-					m_trafficData.m_receivedFlitNumber += std::stof(packetSize);
+					m_trafficData.m_receivedFlitNumber += std::stoi(packetSize);
 				}
 			}
-			if (std::stoi(sentTime) >= g_warmupCycles
-				&& std::stoi(sentTime) < (g_warmupCycles + g_measurementCycles))
+			if (std::stod(sentTime) >= g_warmupCycles
+				&& std::stod(sentTime) < (g_warmupCycles + g_measurementCycles))
 			{
 				m_trafficData.m_sentPacketNumber++;
-				m_trafficData.m_sentFlitNumber += std::stof(packetSize);
+				m_trafficData.m_sentFlitNumber += std::stoi(packetSize);
 				if (status == "R")
 					m_trafficData.m_accumulatedLatency +=
-					(std::stof(receivedTime) - std::stof(sentTime) - 1);
+					(std::stod(receivedTime) - std::stod(sentTime) - 1);
 			}
 		}
 	}
 	readPacketInformation.close();
+	delete npyWriter;
+	npyWriter = nullptr;
+
+	// the latency breakdown is not in TrafficInformation.csv; the received
+	// packets are still retained by their destinations
+	for (auto& terminalInterface : m_network->m_terminalInterfaces)
+	{
+		for (auto& entry : terminalInterface->m_inputTrafficInfoBuffer)
+		{
+			if (entry.m_sentTime >= g_warmupCycles
+				&& entry.m_sentTime < (g_warmupCycles + g_measurementCycles))
+				m_trafficData.addLatencyBreakdown(entry);
+		}
+	}
 }
 
 void TrafficOperator::calculatePerformance()
 {
-	float throughput{ m_trafficData.m_receivedFlitNumber
-		/ (g_measurementCycles * m_network->getRouterNumber()) },
-		demand{ m_trafficData.m_sentFlitNumber
-		/ (g_measurementCycles * m_network->getRouterNumber()) },
-		latency{ m_trafficData.m_accumulatedLatency
-		/ m_trafficData.m_sentPacketNumber };
-	std::cout << "************** Network performance **************\n" 
-		<< "Throughput: " << throughput << " flit/cycle/node\n"
-		<< "Demand: " << demand << " flit/cycle/node\n"
-		<< "Average latency: " << latency << " cycles" << std::endl;
-}
\ No newline at end of file
+	const double measuredCycles{ static_cast<double>(g_measurementCycles)
+		* m_network->getRouterNumber() };
+	m_performance.m_throughput = static_cast<float>(
+		m_trafficData.m_receivedFlitNumber / measuredCycles);
+	m_performance.m_demand = static_cast<float>(
+		m_trafficData.m_sentFlitNumber / measuredCycles);
+	m_performance.m_latency = m_trafficData.m_accumulatedLatency
+		/ m_trafficData.m_sentPacketNumber;
+	m_performance.m_queueingLatency = m_trafficData.m_accumulatedQueueingLatency
+		/ m_trafficData.m_sentPacketNumber;
+	m_performance.m_networkLatency = m_trafficData.m_accumulatedNetworkLatency
+		/ m_trafficData.m_sentPacketNumber;
+	m_performance.m_serialisationLatency = m_trafficData.m_accumulatedSerialisationLatency
+		/ m_trafficData.m_sentPacketNumber;
+}
+
+void TrafficOperator::printPerformance()
+{
+	std::cout << m_performance << std::flush;
+}
+
+Performance TrafficOperator::getPerformance()
+{
+	return m_performance;
+}
+
+void TrafficOperator::writeNumpyResults()
+{
+	const float routerNumber{ static_cast<float>(m_network->getRouterNumber()) };
+	NpzWriter results{ m_trafficFolderPath + "Results.npz" };
+	results.add("throughput", makeNpyScalar(m_performance.m_throughput));
+	results.add("demand", makeNpyScalar(m_performance.m_demand));
+	results.add("latency", makeNpyScalar(m_performance.m_latency));
+	results.add("queueing_latency", makeNpyScalar(m_performance.m_queueingLatency));
+	results.add("network_latency", makeNpyScalar(m_performance.m_networkLatency));
+	results.add("serialisation_latency",
+		makeNpyScalar(m_performance.m_serialisationLatency));
+
+	std::vector<double> start{}, sentPackets{}, receivedPackets{},
+		throughput{}, demand{}, latency{};
+	for (size_t i{}; i < m_windowStatistics.m_windows.size(); ++i)
+	{
+		const TrafficData& window{ m_windowStatistics.m_windows.at(i) };
+		const float windowStart{ static_cast<float>(i * g_statisticsWindow) };
+		// the last window may be cut short by the end of the run
+		const float windowCycles{ std::clamp(g_totalCycles - windowStart,
+			1.0f, static_cast<float>(g_statisticsWindow)) };
+		start.push_back(windowStart);
+		sentPackets.push_back(window.m_sentPacketNumber);
+		receivedPackets.push_back(window.m_receivedPacketNumber);
+		throughput.push_back(window.m_receivedFlitNumber
+			/ (windowCycles * routerNumber));
+		demand.push_back(window.m_sentFlitNumber / (windowCycles * routerNumber));
+		latency.push_back(window.m_sentPacketNumber
+			? window.m_accumulatedLatency / window.m_sentPacketNumber : 0.0f);
+	}
+	results.add("window_start", makeNpyArray(start));
+	results.add("window_sent_packets", makeNpyArray(sentPackets));
+	results.add("window_received_packets", makeNpyArray(receivedPackets));
+	results.add("window_throughput", makeNpyArray(throughput));
+	results.add("window_demand", makeNpyArray(demand));
+	results.add("window_latency", makeNpyArray(latency));
+	results.close();
+}
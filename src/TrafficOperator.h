@@ -1,27 +1,44 @@
 #pragma once
 #include <sys/stat.h>
+#include <algorithm>
+#include <limits>
 #include "RegularNetwork.h"
+#include "PacketSink.h"
 
 class TrafficOperator
 {
 public:
 	TrafficOperator(const std::string_view trafficFolderPath,
 		RegularNetwork* m_network);
+	~TrafficOperator();
 	void generateTraffic();
 	void generateTraffic(const int destination);
 	void analyzeTraffic();
+	void printPerformance();
+	Performance getPerformance();
 
 private:
+	void createPacketSink();
+	void createTraceReplay();
 	void generateRandom();
 	void generatePermutation(const int destination);
+	// into the traffic tables, or with a sink drawn by the terminal when due
+	void generatePackets(TerminalInterface* terminalInterface);
 	//void generateCustomize();
-	int uniformDistribution(const int min, const int max); // for packet size
 	void updateTrafficInformation();
 	void collectData();
 	void calculatePerformance();
+	void writeNumpyResults();
 
 private:
 	std::string m_trafficFolderPath{};
 	RegularNetwork* m_network{};
+	// generated traffic tables; lossless, they are read back for analysis
+	TraceWriter m_trafficInformationWriter;
+	TraceWriter m_trafficDataWriter;
 	TrafficData m_trafficData{};
+	Performance m_performance{};
+	WindowStatistics m_windowStatistics{};
+	StatisticsSink* m_packetSink{}; // nullptr if received packets are buffered
+	TraceReplay* m_traceReplay{}; // nullptr unless the injection process is "trace"
 };
\ No newline at end of file
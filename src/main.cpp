@@ -1,9 +1,16 @@
-#include "TrafficOperator.h"
+#include "Simulation.h"
+#include "Sweep.h"
+#include "ResultCache.h"
+#include "CompactTrace.h"
+#include "FlitTracer.h"
 #include "toml.hpp"
 #include <filesystem>
 #include <cstring>
 #include <fstream>
 #include <chrono>
+#include <limits>
+#include <span>
+#include <algorithm>
 
 using namespace std::string_view_literals;
 
@@ -21,24 +28,54 @@ void printUsage(const char* programName)
 			  << "Simulation Options:\n"
 			  << "  -o, --output DIR      Specify output directory for traffic files (default: ./traffic/)\n"
 			  << "  -t, --topology TYPE   Override topology type (MESH, TORUS)\n"
-			  << "  -a, --algorithm ALGO  Override routing algorithm (DOR, ROMM, MAD, VAL, ODD_EVEN)\n"
+			  << "  -a, --algorithm ALGO  Override routing algorithm (DOR, O1TURN, ROMM, MAD, VAL, ODD_EVEN)\n"
 			  << "  -r, --rate RATE       Override injection rate (0.0-1.0)\n"
 			  << "  -s, --size SIZE       Override packet size (flits)\n"
 			  << "  -p, --pattern PATTERN Override traffic pattern (random uniform, permutation)\n"
 			  << "  -c, --cycles CYCLES   Override total cycles\n"
 			  << "  -w, --warmup CYCLES   Override warmup cycles\n"
-			  << "  -m, --measure CYCLES  Override measurement cycles\n\n"
+			  << "  -m, --measure CYCLES  Override measurement cycles\n"
+			  << "  --replay FILE         Inject the packets of a replay trace (.rpl)\n"
+			  << "  --route-cache DIR     Map routes cached in DIR instead of generating them\n"
+			  << "  --source-queue FLITS  Bound each source queue; 0 is unbounded\n"
+			  << "  --queue-policy POLICY While a source queue is full: stall, drop\n"
+			  << "  --huge-pages MODE     Back the network arena with none, thp, hugetlb\n\n"
 			  << "Output Options:\n"
 			  << "  --no-traffic          Skip traffic generation\n"
 			  << "  --no-analysis         Skip traffic analysis\n"
+			  << "  --sink SINK           Override ejection sink (buffer, statistics, trace)\n"
+			  << "  --numpy               Also write results as NumPy .npy/.npz files\n"
+			  << "  --memory              Report bytes held per subsystem at phase boundaries\n"
+			  << "  --link-counters       Write flits, credit stalls and occupancy per port\n"
+			  << "  --queue-histograms    Write stalls, drops and depth histograms per source queue\n"
+			  << "  --flit-trace N        Trace the hops of every N-th packet of a source\n"
+			  << "  --telemetry K         Publish progress to Telemetry.stats every K cycles\n"
+			  << "  --cache DIR           Reuse results of identical runs cached in DIR\n"
+			  << "  --no-cache            Always simulate, even if a cache is configured\n"
 			  << "  --save-config FILE    Save current config to file\n"
-			  << "  --dry-run             Parse config and show settings, don't run simulation\n\n"
+			  << "  --dry-run             Parse config and show settings, don't run simulation\n"
+			  << "  --decode-trace FILE   Print a compact trace (.sxt) as CSV and exit\n"
+			  << "  --decode-flit-trace FILE  Print a flit trace (.sft) as CSV and exit\n"
+			  << "  --from CYCLE          With a decode option, first cycle to print\n"
+			  << "  --to CYCLE            With a decode option, cycle to stop before\n"
+			  << "  --convert-trace CSV RPL  Convert a cycle,source,destination,size CSV\n"
+			  << "                        into a replay trace and exit\n\n"
+			  << "Sweep Mode: " << programName << " sweep [OPTIONS] [CONFIG_FILE]\n"
+			  << "  Runs every combination of the listed values in parallel and writes\n"
+			  << "  one result table (Sweep.csv in the output directory)\n"
+			  << "  --rates LIST          Injection rates, e.g. 0.01,0.02,0.05\n"
+			  << "  --algorithms LIST     Routing algorithms, e.g. DOR,ROMM\n"
+			  << "  --vcs LIST            Virtual channel numbers\n"
+			  << "  --buffers LIST        Buffer sizes\n"
+			  << "  --threads N           Worker threads (default: hardware threads)\n"
+			  << "  --memory-limit MIB    Skip points estimated not to fit in MIB MiB\n\n"
 			  << "Examples:\n"
 			  << "  " << programName << "                           # Run with default config\n"
 			  << "  " << programName << " my_config.toml            # Run with custom config\n"
 			  << "  " << programName << " -o /tmp/results config.toml  # Specify output directory\n"
 			  << "  " << programName << " -t TORUS -a MAD -r 0.05     # Override topology and algorithm\n"
-			  << "  " << programName << " --dry-run config.toml       # Show config without running\n";
+			  << "  " << programName << " --dry-run config.toml       # Show config without running\n"
+			  << "  " << programName << " sweep --rates 0.01,0.05 --algorithms DOR,VAL config.toml\n";
 }
 
 struct Arguments
@@ -48,26 +85,57 @@ struct Arguments
 	std::string topologyOverride{""};
 	std::string algorithmOverride{""};
 	std::string patternOverride{""};
+	std::string sinkOverride{""};
+	std::string replayOverride{""};
+	std::string cacheOverride{""};
+	std::string routeCacheOverride{""};
+	std::string queuePolicyOverride{""};
+	std::string hugePagesOverride{""};
 	float rateOverride{-1.0f};
 	int sizeOverride{-1};
 	int totalCyclesOverride{-1};
 	int warmupCyclesOverride{-1};
 	int measureCyclesOverride{-1};
+	int sourceQueueOverride{-1};
 	std::string saveConfigPath{""};
+	std::string decodeTracePath{""};
+	std::string decodeFlitTracePath{""};
+	long long decodeFromCycle{0};
+	long long decodeToCycle{-1};
+	std::string convertTraceInputPath{""};
+	std::string convertTraceOutputPath{""};
 	bool showHelp{false};
 	bool showVersion{false};
 	bool quiet{false};
 	bool debug{false};
 	bool noTraffic{false};
 	bool noAnalysis{false};
+	bool numpyExport{false};
+	bool memoryReport{false};
+	bool linkCounters{false};
+	bool queueHistograms{false};
+	int flitTraceSample{-1};
+	int telemetryInterval{-1};
+	bool noCache{false};
 	bool dryRun{false};
+	bool sweep{false};
+	SweepGrid sweepGrid{};
+	int sweepThreadNumber{0};
+	long long sweepMemoryLimit{0}; // MiB
 };
 
 Arguments parseArguments(int argc, char* argv[])
 {
 	Arguments args;
 
-	for (int i{1}; i < argc; ++i)
+	int i{1};
+	if (argc > 1 && std::strcmp(argv[1], "sweep") == 0)
+	{
+		args.sweep = true;
+		++i;
+	}
+
+	for (; i < argc; ++i)
 	{
 		if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0)
 		{
@@ -246,6 +314,50 @@ Arguments parseArguments(int argc, char* argv[])
 				return args;
 			}
 		}
+		else if (std::strcmp(argv[i], "--source-queue") == 0)
+		{
+			if (i + 1 < argc)
+			{
+				try
+				{
+					args.sourceQueueOverride = std::stoi(argv[++i]);
+				}
+				catch (const std::exception&)
+				{
+					std::cerr << "Error: Invalid source queue capacity: " << argv[i] << "\n";
+					args.showHelp = true;
+					return args;
+				}
+			}
+			else
+			{
+				std::cerr << "Error: Missing argument for " << argv[i] << "\n";
+				args.showHelp = true;
+				return args;
+			}
+		}
+		else if (std::strcmp(argv[i], "--queue-policy") == 0)
+		{
+			if (i + 1 < argc)
+				args.queuePolicyOverride = argv[++i];
+			else
+			{
+				std::cerr << "Error: Missing argument for " << argv[i] << "\n";
+				args.showHelp = true;
+				return args;
+			}
+		}
+		else if (std::strcmp(argv[i], "--huge-pages") == 0)
+		{
+			if (i + 1 < argc)
+				args.hugePagesOverride = argv[++i];
+			else
+			{
+				std::cerr << "Error: Missing argument for " << argv[i] << "\n";
+				args.showHelp = true;
+				return args;
+			}
+		}
 		else if (std::strcmp(argv[i], "--no-traffic") == 0)
 		{
 			args.noTraffic = true;
@@ -254,6 +366,85 @@ Arguments parseArguments(int argc, char* argv[])
 		{
 			args.noAnalysis = true;
 		}
+		else if (std::strcmp(argv[i], "--numpy") == 0)
+		{
+			args.numpyExport = true;
+		}
+		else if (std::strcmp(argv[i], "--memory") == 0)
+		{
+			args.memoryReport = true;
+		}
+		else if (std::strcmp(argv[i], "--link-counters") == 0)
+		{
+			args.linkCounters = true;
+		}
+		else if (std::strcmp(argv[i], "--queue-histograms") == 0)
+		{
+			args.queueHistograms = true;
+		}
+		else if (std::strcmp(argv[i], "--flit-trace") == 0
+			|| std::strcmp(argv[i], "--telemetry") == 0)
+		{
+			if (i + 1 < argc)
+			{
+				const bool isFlitTrace{ std::strcmp(argv[i], "--flit-trace") == 0 };
+				try
+				{
+					(isFlitTrace ? args.flitTraceSample : args.telemetryInterval)
+						= std::stoi(argv[++i]);
+				}
+				catch (const std::exception&)
+				{
+					std::cerr << "Error: Invalid " << (isFlitTrace ? "sample" : "interval")
+						<< " value: " << argv[i] << "\n";
+					args.showHelp = true;
+					return args;
+				}
+			}
+			else
+			{
+				std::cerr << "Error: Missing argument for " << argv[i] << "\n";
+				args.showHelp = true;
+				return args;
+			}
+		}
+		else if (std::strcmp(argv[i], "--no-cache") == 0)
+		{
+			args.noCache = true;
+		}
+		else if (std::strcmp(argv[i], "--route-cache") == 0)
+		{
+			if (i + 1 < argc)
+				args.routeCacheOverride = argv[++i];
+			else
+			{
+				std::cerr << "Error: Missing argument for " << argv[i] << "\n";
+				args.showHelp = true;
+				return args;
+			}
+		}
+		else if (std::strcmp(argv[i], "--cache") == 0)
+		{
+			if (i + 1 < argc)
+				args.cacheOverride = argv[++i];
+			else
+			{
+				std::cerr << "Error: Missing argument for " << argv[i] << "\n";
+				args.showHelp = true;
+				return args;
+			}
+		}
+		else if (std::strcmp(argv[i], "--sink") == 0)
+		{
+			if (i + 1 < argc)
+				args.sinkOverride = argv[++i];
+			else
+			{
+				std::cerr << "Error: Missing argument for " << argv[i] << "\n";
+				args.showHelp = true;
+				return args;
+			}
+		}
 		else if (std::strcmp(argv[i], "--save-config") == 0)
 		{
 			if (i + 1 < argc)
@@ -269,6 +460,106 @@ Arguments parseArguments(int argc, char* argv[])
 		{
 			args.dryRun = true;
 		}
+		else if (std::strcmp(argv[i], "--decode-trace") == 0
+			|| std::strcmp(argv[i], "--decode-flit-trace") == 0)
+		{
+			if (i + 1 < argc)
+				(std::strcmp(argv[i], "--decode-trace") == 0 ? args.decodeTracePath
+					: args.decodeFlitTracePath) = argv[++i];
+			else
+			{
+				std::cerr << "Error: Missing argument for " << argv[i] << "\n";
+				args.showHelp = true;
+				return args;
+			}
+		}
+		else if (std::strcmp(argv[i], "--replay") == 0)
+		{
+			if (i + 1 < argc)
+				args.replayOverride = argv[++i];
+			else
+			{
+				std::cerr << "Error: Missing argument for " << argv[i] << "\n";
+				args.showHelp = true;
+				return args;
+			}
+		}
+		else if (std::strcmp(argv[i], "--convert-trace") == 0)
+		{
+			if (i + 2 < argc)
+			{
+				args.convertTraceInputPath = argv[++i];
+				args.convertTraceOutputPath = argv[++i];
+			}
+			else
+			{
+				std::cerr << "Error: Missing arguments for " << argv[i] << "\n";
+				args.showHelp = true;
+				return args;
+			}
+		}
+		else if (args.sweep && (std::strcmp(argv[i], "--rates") == 0
+			|| std::strcmp(argv[i], "--algorithms") == 0
+			|| std::strcmp(argv[i], "--vcs") == 0
+			|| std::strcmp(argv[i], "--buffers") == 0
+			|| std::strcmp(argv[i], "--threads") == 0
+			|| std::strcmp(argv[i], "--memory-limit") == 0))
+		{
+			if (i + 1 >= argc)
+			{
+				std::cerr << "Error: Missing argument for " << argv[i] << "\n";
+				args.showHelp = true;
+				return args;
+			}
+			const std::string option{ argv[i] };
+			try
+			{
+				for (auto& value : splitSweepList(argv[++i]))
+				{
+					if (option == "--rates")
+						args.sweepGrid.m_injectionRates.push_back(std::stof(value));
+					else if (option == "--algorithms")
+						args.sweepGrid.m_routingAlgorithms.push_back(value);
+					else if (option == "--vcs")
+						args.sweepGrid.m_virtualChannelNumbers.push_back(std::stoi(value));
+					else if (option == "--buffers")
+						args.sweepGrid.m_bufferSizes.push_back(std::stoi(value));
+					else if (option == "--memory-limit")
+						args.sweepMemoryLimit = std::stoll(value);
+					else
+						args.sweepThreadNumber = std::stoi(value);
+				}
+			}
+			catch (const std::exception&)
+			{
+				std::cerr << "Error: Invalid value for " << option << ": " << argv[i] << "\n";
+				args.showHelp = true;
+				return args;
+			}
+		}
+		else if (std::strcmp(argv[i], "--from") == 0 || std::strcmp(argv[i], "--to") == 0)
+		{
+			if (i + 1 < argc)
+			{
+				bool isFrom{ std::strcmp(argv[i], "--from") == 0 };
+				try
+				{
+					(isFrom ? args.decodeFromCycle : args.decodeToCycle) = std::stoll(argv[++i]);
+				}
+				catch (const std::exception&)
+				{
+					std::cerr << "Error: Invalid cycle value: " << argv[i] << "\n";
+					args.showHelp = true;
+					return args;
+				}
+			}
+			else
+			{
+				std::cerr << "Error: Missing argument for " << argv[i] << "\n";
+				args.showHelp = true;
+				return args;
+			}
+		}
 		else if (argv[i][0] == '-')
 		{
 			std::cerr << "Error: Unknown option: " << argv[i] << "\n";
@@ -292,19 +583,43 @@ static void parseConfiguration(const toml::table& table, const Arguments& args)
 	g_z = table["topology"]["dimension"][2].value_or<int>(0);
 	g_shape = table["topology"]["shape"].value_or(""sv);
 	g_routingAlgorithm = table["routing"]["algorithm"].value_or(""sv);
+	g_routingMode = table["routing"]["mode"].value_or("source"sv);
+	g_selectionFunction = table["routing"]["selection"].value_or("none"sv);
+	g_escapeVirtualChannelNumber = table["routing"]["escape_virtual_channels"].value_or<int>(-1);
+	g_routeCacheDirectory = table["routing"]["cache_directory"].value_or(""sv);
 	g_virtualChannelNumber = table["microarchitecture"]["virtual_channel_number"].value_or<int>(0);
 	g_bufferSize = table["microarchitecture"]["buffer_size"].value_or<int>(0);
+	g_sourceQueueCapacity = table["microarchitecture"]["source_queue_capacity"].value_or<int>(0);
+	g_sourceQueuePolicy = table["microarchitecture"]["source_queue_policy"].value_or("stall"sv);
 	g_flitSize = table["traffic"]["flit_size"].value_or<int>(0);
 	g_packetSize = table["traffic"]["packet_size"].value_or<int>(0);
 	g_packetSizeOption = table["traffic"]["packet_size_option"].value_or(""sv);
 	g_injectionRate = table["traffic"]["injection_rate"].value_or<float>(0);
 	g_injectionProcess = table["traffic"]["injection_process"].value_or(""sv);
+	g_replayTraceFile = table["traffic"]["trace_file"].value_or(""sv);
 	g_alpha = table["traffic"]["alpha"].value_or<float>(0);
 	g_beta = table["traffic"]["beta"].value_or<float>(0);
 	g_trafficPattern = table["traffic"]["traffic_pattern"].value_or(""sv);
 	g_totalCycles = table["cycles"]["total"].value_or<int>(0);
 	g_warmupCycles = table["cycles"]["warmup"].value_or<int>(0);
 	g_measurementCycles = table["cycles"]["measurement"].value_or<int>(0);
+	g_ejectionSink = table["output"]["ejection_sink"].value_or("buffer"sv);
+	g_traceBufferSize = table["output"]["trace_buffer_size"].value_or<int>(1 << 22);
+	g_traceBufferNumber = table["output"]["trace_buffer_number"].value_or<int>(2);
+	g_traceBackpressure = table["output"]["trace_backpressure"].value_or("block"sv);
+	g_traceFormat = table["output"]["trace_format"].value_or("csv"sv);
+	g_numpyExport = table["output"]["numpy_export"].value_or(false);
+	g_memoryReport = table["output"]["memory_report"].value_or(false);
+	g_linkCounters = table["output"]["link_counters"].value_or(false);
+	g_sourceQueueHistograms = table["output"]["source_queue_histograms"].value_or(false);
+	g_flitTraceSample = table["output"]["flit_trace_sample"].value_or<int>(0);
+	g_flitTraceSource = table["output"]["flit_trace_source"].value_or<int>(-1);
+	g_flitTraceDestination = table["output"]["flit_trace_destination"].value_or<int>(-1);
+	g_flitTraceRingSize = table["output"]["flit_trace_ring_size"].value_or<int>(1 << 16);
+	g_telemetryInterval = table["output"]["telemetry_interval"].value_or<int>(0);
+	g_resultCacheDirectory = table["output"]["cache_directory"].value_or(""sv);
+	g_statisticsWindow = table["output"]["statistics_window"].value_or<int>(1000);
+	g_hugePages = table["output"]["huge_pages"].value_or("none"sv);
 	g_drainCycles = g_totalCycles - g_warmupCycles - g_measurementCycles;
 	g_packetNumber = g_totalCycles * g_injectionRate;
 
@@ -325,12 +640,70 @@ static void parseConfiguration(const toml::table& table, const Arguments& args)
 		g_warmupCycles = args.warmupCyclesOverride;
 	if (args.measureCyclesOverride > 0)
 		g_measurementCycles = args.measureCyclesOverride;
+	if (!args.sinkOverride.empty())
+		g_ejectionSink = args.sinkOverride;
+	if (args.sourceQueueOverride >= 0)
+		g_sourceQueueCapacity = args.sourceQueueOverride;
+	if (!args.queuePolicyOverride.empty())
+		g_sourceQueuePolicy = args.queuePolicyOverride;
+	if (!args.hugePagesOverride.empty())
+		g_hugePages = args.hugePagesOverride;
+	if (args.numpyExport)
+		g_numpyExport = true;
+	if (args.memoryReport)
+		g_memoryReport = true;
+	if (args.linkCounters)
+		g_linkCounters = true;
+	if (args.queueHistograms)
+		g_sourceQueueHistograms = true;
+	if (args.flitTraceSample >= 0)
+		g_flitTraceSample = args.flitTraceSample;
+	if (args.telemetryInterval >= 0)
+		g_telemetryInterval = args.telemetryInterval;
+	if (!args.routeCacheOverride.empty())
+		g_routeCacheDirectory = args.routeCacheOverride;
+	if (!args.cacheOverride.empty())
+		g_resultCacheDirectory = args.cacheOverride;
+	if (args.noCache)
+		g_resultCacheDirectory = "";
+	if (!args.replayOverride.empty())
+	{
+		g_injectionProcess = "trace";
+		g_replayTraceFile = args.replayOverride;
+	}
 
 	// Recalculate derived values
 	g_drainCycles = g_totalCycles - g_warmupCycles - g_measurementCycles;
 	g_packetNumber = g_totalCycles * g_injectionRate;
 }
 
+// a typo in a string option would otherwise fall back to a default silently
+static bool isOneOf(const std::string_view value, std::span<const std::string_view> valid,
+	const char* option)
+{
+	if (std::find(valid.begin(), valid.end(), value) != valid.end())
+		return true;
+	std::cerr << "Error: Invalid " << option << ": " << value << "\n";
+	return false;
+}
+
+static bool validateConfiguration(const Arguments& args)
+{
+	static constexpr std::string_view c_routingAlgorithms[]{
+		"DOR", "MAD", "ODD_EVEN", "O1TURN", "VAL", "ROMM" };
+	static constexpr std::string_view c_routingModes[]{ "source", "distributed" };
+	static constexpr std::string_view c_selectionFunctions[]{
+		"none", "max_credit", "random", "local_neighbour" };
+	static constexpr std::string_view c_sourceQueuePolicies[]{ "stall", "drop" };
+	bool valid{ isOneOf(g_routingAlgorithm, c_routingAlgorithms, "routing algorithm") };
+	for (auto& routingAlgorithm : args.sweepGrid.m_routingAlgorithms)
+		valid &= isOneOf(routingAlgorithm, c_routingAlgorithms, "routing algorithm");
+	valid &= isOneOf(g_routingMode, c_routingModes, "routing mode");
+	valid &= isOneOf(g_selectionFunction, c_selectionFunctions, "selection function");
+	valid &= isOneOf(g_sourceQueuePolicy, c_sourceQueuePolicies, "source queue policy");
+	return valid;
+}
+
 static void saveConfiguration(const Arguments& args)
 {
 	if (args.saveConfigPath.empty())
@@ -351,12 +724,41 @@ static void saveConfiguration(const Arguments& args)
 	file << "warmup = " << g_warmupCycles << "\n";
 	file << "measurement = " << g_measurementCycles << "\n\n";
 
+	file << "[output]\n";
+	file << "ejection_sink = \"" << g_ejectionSink << "\"\n";
+	file << "trace_buffer_size = " << g_traceBufferSize << "\n";
+	file << "trace_buffer_number = " << g_traceBufferNumber << "\n";
+	file << "trace_backpressure = \"" << g_traceBackpressure << "\"\n";
+	file << "trace_format = \"" << g_traceFormat << "\"\n";
+	file << "numpy_export = " << (g_numpyExport ? "true" : "false") << "\n";
+	file << "memory_report = " << (g_memoryReport ? "true" : "false") << "\n";
+	file << "link_counters = " << (g_linkCounters ? "true" : "false") << "\n";
+	file << "source_queue_histograms = " << (g_sourceQueueHistograms ? "true" : "false") << "\n";
+	file << "flit_trace_sample = " << g_flitTraceSample << "\n";
+	file << "flit_trace_source = " << g_flitTraceSource << "\n";
+	file << "flit_trace_destination = " << g_flitTraceDestination << "\n";
+	file << "flit_trace_ring_size = " << g_flitTraceRingSize << "\n";
+	file << "telemetry_interval = " << g_telemetryInterval << "\n";
+	if (!g_resultCacheDirectory.empty())
+		file << "cache_directory = \"" << g_resultCacheDirectory << "\"\n";
+	file << "statistics_window = " << g_statisticsWindow << "\n";
+	file << "huge_pages = \"" << g_hugePages << "\"\n\n";
+
 	file << "[microarchitecture]\n";
 	file << "buffer_size = " << g_bufferSize << "\n";
-	file << "virtual_channel_number = " << g_virtualChannelNumber << "\n\n";
+	file << "virtual_channel_number = " << g_virtualChannelNumber << "\n";
+	file << "source_queue_capacity = " << g_sourceQueueCapacity << "\n";
+	file << "source_queue_policy = \"" << g_sourceQueuePolicy << "\"\n\n";
 
 	file << "[routing]\n";
-	file << "algorithm = \"" << g_routingAlgorithm << "\"\n\n";
+	file << "algorithm = \"" << g_routingAlgorithm << "\"\n";
+	file << "mode = \"" << g_routingMode << "\"\n";
+	file << "selection = \"" << g_selectionFunction << "\"\n";
+	if (g_escapeVirtualChannelNumber >= 0)
+		file << "escape_virtual_channels = " << g_escapeVirtualChannelNumber << "\n";
+	if (!g_routeCacheDirectory.empty())
+		file << "cache_directory = \"" << g_routeCacheDirectory << "\"\n";
+	file << "\n";
 
 	file << "[topology]\n";
 	file << "dimension = [ " << g_x << ", " << g_y << ", " << g_z << " ]\n";
@@ -367,6 +769,8 @@ static void saveConfiguration(const Arguments& args)
 	file << "beta = " << g_beta << "\n";
 	file << "flit_size = " << g_flitSize << "\n";
 	file << "injection_process = \"" << g_injectionProcess << "\"\n";
+	if (g_injectionProcess == "trace")
+		file << "trace_file = \"" << g_replayTraceFile << "\"\n";
 	file << "injection_rate = " << g_injectionRate << "\n";
 	file << "packet_size = " << g_packetSize << "\n";
 	file << "packet_size_option = \"" << g_packetSizeOption << "\"\n";
@@ -376,6 +780,63 @@ static void saveConfiguration(const Arguments& args)
 	std::cout << "Configuration saved to: " << args.saveConfigPath << "\n";
 }
 
+static int decodeTrace(const Arguments& args)
+{
+	CompactTraceReader reader{ args.decodeTracePath };
+	if (!reader.isOpen())
+	{
+		std::cerr << "Error: Could not read compact trace: " << args.decodeTracePath << "\n";
+		return 1;
+	}
+
+	std::vector<TrafficInformationEntry> entries{ args.decodeToCycle < 0
+		? reader.read(args.decodeFromCycle, std::numeric_limits<long long>::max())
+		: reader.read(args.decodeFromCycle, args.decodeToCycle) };
+	std::cout << "PacketID,Source,Destination,PacketSize,Status,SentTime,ReceivedTime,\n";
+	for (auto& entry : entries)
+	{
+		std::cout << entry.m_packetID << ','
+			<< entry.m_source << ','
+			<< entry.m_destination << ','
+			<< entry.m_packetSize << ','
+			<< entry.m_status << ','
+			<< entry.m_sentTime << ','
+			<< entry.m_receivedTime << ",\n";
+	}
+	return 0;
+}
+
+static int decodeFlitTrace(const Arguments& args)
+{
+	std::vector<FlitTraceRecord> records{ readFlitTrace(args.decodeFlitTracePath) };
+	if (records.empty())
+	{
+		std::cerr << "Error: Could not read flit trace: " << args.decodeFlitTracePath << "\n";
+		return 1;
+	}
+
+	std::cout << "Cycle,TraceID,Source,PacketID,Event,Node,Port,VirtualChannel,Flit,\n";
+	for (auto& record : records)
+	{
+		if (record.m_cycle < args.decodeFromCycle
+			|| (args.decodeToCycle >= 0 && record.m_cycle >= args.decodeToCycle))
+			continue;
+		std::cout << record.m_cycle << ','
+			<< record.m_traceID << ','
+			<< record.m_source << ','
+			<< record.m_packetID << ','
+			<< getFlitTraceEventName(record.m_event) << ','
+			<< record.m_node << ','
+			<< record.m_port << ','
+			<< record.m_virtualChannel << ','
+			<< record.m_flitType;
+		if (record.m_flitNumber >= 0)
+			std::cout << record.m_flitNumber;
+		std::cout << ",\n";
+	}
+	return 0;
+}
+
 int main(int argc, char* argv[])
 {
 	Arguments args{parseArguments(argc, argv)};
@@ -388,10 +849,20 @@ int main(int argc, char* argv[])
 
 	if (args.showVersion)
 	{
-		std::cout << "soxim - Network-on-Chip Simulator v1.0\n";
+		std::cout << "soxim - Network-on-Chip Simulator v" SOXIM_VERSION "\n";
 		return 0;
 	}
 
+	if (!args.decodeTracePath.empty())
+		return decodeTrace(args);
+
+	if (!args.decodeFlitTracePath.empty())
+		return decodeFlitTrace(args);
+
+	if (!args.convertTraceInputPath.empty())
+		return convertReplayTrace(args.convertTraceInputPath,
+			args.convertTraceOutputPath) ? 0 : 1;
+
 #if BENCHMARK
 	Benchmark benchmark{};
 #endif
@@ -416,6 +887,12 @@ int main(int argc, char* argv[])
 	}
 
 	parseConfiguration(table, args);
+	if (!validateConfiguration(args))
+		return 1;
+	// a sweep checks each of its points instead
+	const SimulationConfiguration configuration{ SimulationConfiguration::capture() };
+	if (!args.sweep && !configuration.validate(std::cerr))
+		return 1;
 
 	// Dry run mode - just show config and exit
 	if (args.dryRun)
@@ -429,11 +906,32 @@ int main(int argc, char* argv[])
 		std::cout << "dimension = [ " << g_x << ", " << g_y << ", " << g_z << " ]\n";
 		std::cout << "shape = \"" << g_shape << "\"\n\n";
 		std::cout << "[routing]\n";
-		std::cout << "algorithm = \"" << g_routingAlgorithm << "\"\n\n";
+		std::cout << "algorithm = \"" << g_routingAlgorithm << "\"\n";
+		std::cout << "mode = \"" << g_routingMode << "\"\n";
+		std::cout << "selection = \"" << g_selectionFunction << "\"\n";
+		std::cout << "escape_virtual_channels = "
+			<< configuration.getEscapeVirtualChannelNumber() << "\n\n";
+		std::cout << "[microarchitecture]\n";
+		std::cout << "virtual_channel_number = " << g_virtualChannelNumber << "\n";
+		std::cout << "buffer_size = " << g_bufferSize << "\n";
+		std::cout << "source_queue_capacity = " << g_sourceQueueCapacity << "\n";
+		std::cout << "source_queue_policy = \"" << g_sourceQueuePolicy << "\"\n\n";
 		std::cout << "[traffic]\n";
 		std::cout << "injection_rate = " << g_injectionRate << "\n";
 		std::cout << "packet_size = " << g_packetSize << "\n";
-		std::cout << "traffic_pattern = \"" << g_trafficPattern << "\"\n";
+		std::cout << "injection_process = \"" << g_injectionProcess << "\"\n";
+		if (g_injectionProcess == "trace")
+			std::cout << "trace_file = \"" << g_replayTraceFile << "\"\n";
+		std::cout << "traffic_pattern = \"" << g_trafficPattern << "\"\n\n";
+		std::cout << "[output]\n";
+		std::cout << "ejection_sink = \"" << g_ejectionSink << "\"\n";
+		std::cout << "numpy_export = " << (g_numpyExport ? "true" : "false") << "\n";
+		std::cout << "memory_report = " << (g_memoryReport ? "true" : "false") << "\n";
+		std::cout << "link_counters = " << (g_linkCounters ? "true" : "false") << "\n";
+		std::cout << "source_queue_histograms = " << (g_sourceQueueHistograms ? "true" : "false") << "\n";
+		std::cout << "flit_trace_sample = " << g_flitTraceSample << "\n";
+		std::cout << "telemetry_interval = " << g_telemetryInterval << "\n";
+		std::cout << "huge_pages = \"" << g_hugePages << "\"\n";
 		std::cout << "******************************************************\n";
 		return 0;
 	}
@@ -441,42 +939,38 @@ int main(int argc, char* argv[])
 	// Save configuration if requested
 	saveConfiguration(args);
 
-	RegularNetwork* network{ new RegularNetwork{} };
-
-	for (int i{}; i < network->getRouterNumber(); ++i)
-	{
-		TerminalInterface* terminal{ new TerminalInterface{-i - 1} };
-		network->connectTerminal(i, terminal);
-	}
-	network->loadNetworkData();
+	ResultCache* resultCache{ g_resultCacheDirectory.empty() ? nullptr
+		: new ResultCache{ std::string{ g_resultCacheDirectory } } };
 
-	if (!args.noTraffic)
+	if (args.sweep)
 	{
-		TrafficOperator* trafficOperator{ new TrafficOperator{
-			args.outputDir,
-			network} };
-		trafficOperator->generateTraffic();
-
-		for (Clock clk; clk.get() < g_totalCycles; clk.tick())
-			network->runOneCycle();
-
-		if (!args.noAnalysis)
+		Sweep sweep{ configuration, args.sweepGrid, args.outputDir };
+		if (!sweep.validate(std::cerr))
 		{
-			trafficOperator->analyzeTraffic();
+			delete resultCache;
+			resultCache = nullptr;
+			return 1;
 		}
-
-		delete trafficOperator;
-		trafficOperator = nullptr;
-	}
-	else
-	{
-		// Just run simulation without traffic generation
-		for (Clock clk; clk.get() < g_totalCycles; clk.tick())
-			network->runOneCycle();
+		sweep.setResultCache(resultCache);
+		sweep.setMemoryLimit(static_cast<size_t>(std::max(args.sweepMemoryLimit, 0LL)) << 20);
+		const int threadNumber{ args.sweepThreadNumber > 0 ? args.sweepThreadNumber
+			: static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)) };
+		sweep.run(threadNumber);
+
+		std::ofstream resultFile(std::filesystem::path{ args.outputDir } / "Sweep.csv");
+		sweep.writeResults(resultFile);
+		std::cout << "************** Sweep results **************\n";
+		sweep.writeResults(std::cout);
+		delete resultCache;
+		resultCache = nullptr;
+		return 0;
 	}
 
-	delete network;
-	network = nullptr;
+	Simulation simulation{ configuration, args.outputDir };
+	simulation.setResultCache(resultCache);
+	simulation.run(!args.noTraffic, !args.noAnalysis);
+	delete resultCache;
+	resultCache = nullptr;
 
 	return 0;
 }
@@ -0,0 +1,29 @@
+#include "Link.h"
+#undef BENCHMARK // the release flag of soxim, a macro of Google Benchmark
+#include <benchmark/benchmark.h>
+
+// a link carrying a flit and a credit each way every cycle
+static void BM_LinkRunOneCycle(benchmark::State& state)
+{
+    g_flitSize = 1;
+    g_virtualChannelNumber = 4;
+    Router left(0), right(1);
+    Link link(&left, &right);
+    Port* leftPort = left.m_ports.front();
+    Port* rightPort = right.m_ports.front();
+    static const int route[]{ 1, -2 };
+    const Flit flit(-1, route);
+    for (auto _ : state) {
+        leftPort->m_outputRegister.pushbackFlit(flit);
+        leftPort->m_outputRegister.pushbackCredit({ 0, false });
+        rightPort->m_outputRegister.pushbackFlit(flit);
+        rightPort->m_outputRegister.pushbackCredit({ 0, false });
+        link.updateEnable();
+        link.runOneCycle();
+        benchmark::DoNotOptimize(leftPort->m_inputRegister.popfrontFlit());
+        benchmark::DoNotOptimize(leftPort->m_inputRegister.popfrontCredit());
+        benchmark::DoNotOptimize(rightPort->m_inputRegister.popfrontFlit());
+        benchmark::DoNotOptimize(rightPort->m_inputRegister.popfrontCredit());
+    }
+}
+BENCHMARK(BM_LinkRunOneCycle);
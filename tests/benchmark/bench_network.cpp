@@ -0,0 +1,68 @@
+#include <filesystem>
+#include "Simulation.h"
+#include "TrafficOperator.h"
+#undef BENCHMARK // the release flag of soxim, a macro of Google Benchmark
+#include <benchmark/benchmark.h>
+
+constexpr int c_warmupCycles = 500;
+constexpr int c_measuredCycles = 2000;
+
+// a whole mesh under uniform random traffic, the inner loop of
+// Simulation::run; the arguments are the mesh side and the injection rate
+// in thousandths of a flit per cycle per node
+static void BM_NetworkRunOneCycle(benchmark::State& state)
+{
+    const int side = static_cast<int>(state.range(0));
+    SimulationConfiguration configuration;
+    configuration.m_x = side;
+    configuration.m_y = side;
+    configuration.m_z = 1;
+    configuration.m_shape = "MESH";
+    configuration.m_routingAlgorithm = "DOR";
+    configuration.m_virtualChannelNumber = 2;
+    configuration.m_bufferSize = 8;
+    configuration.m_flitSize = 1;
+    configuration.m_packetSize = 4;
+    configuration.m_packetSizeOption = "fixed";
+    configuration.m_injectionRate = state.range(1) / 1000.0f;
+    configuration.m_injectionProcess = "periodic";
+    configuration.m_trafficPattern = "random uniform";
+    configuration.m_totalCycles = c_warmupCycles + c_measuredCycles + 1;
+    configuration.m_warmupCycles = c_warmupCycles;
+    configuration.m_measurementCycles = c_measuredCycles;
+    configuration.m_ejectionSink = "statistics";
+    configuration.m_traceBufferSize = 1 << 16;
+    configuration.m_traceBufferNumber = 2;
+    configuration.m_traceBackpressure = "block";
+    configuration.m_traceFormat = "csv";
+    configuration.m_statisticsWindow = 1000;
+    configuration.apply();
+    Clock::reset();
+
+    std::string directory = "/tmp/soxim_bench/" + std::to_string(side) + "/";
+    std::filesystem::create_directories(directory);
+    RegularNetwork* network = new RegularNetwork;
+    for (int i = 0; i < network->getRouterNumber(); ++i)
+        network->connectTerminal(i);
+    network->loadNetworkData();
+    TrafficOperator* trafficOperator = new TrafficOperator(directory, network);
+    trafficOperator->generateTraffic();
+
+    Clock clock;
+    for (; clock.get() < c_warmupCycles; clock.tick())
+        network->runOneCycle();
+    for (auto _ : state) {
+        network->runOneCycle();
+        clock.tick();
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["routers"] = network->getRouterNumber();
+
+    delete trafficOperator;
+    delete network;
+    std::filesystem::remove_all(directory);
+}
+BENCHMARK(BM_NetworkRunOneCycle)
+    ->ArgsProduct({ { 4, 8, 16 }, { 10, 50 } })
+    ->Iterations(c_measuredCycles)
+    ->Unit(benchmark::kMicrosecond);
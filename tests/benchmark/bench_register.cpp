@@ -0,0 +1,27 @@
+#include "Register.h"
+#undef BENCHMARK // the release flag of soxim, a macro of Google Benchmark
+#include <benchmark/benchmark.h>
+
+// one flit through a register, as every link and router stage does
+static void BM_RegisterFlit(benchmark::State& state)
+{
+    g_flitSize = 1;
+    Register flitRegister;
+    static const int route[]{ 1, 2, -3 };
+    const Flit flit(-1, route);
+    for (auto _ : state) {
+        flitRegister.pushbackFlit(flit);
+        benchmark::DoNotOptimize(flitRegister.popfrontFlit());
+    }
+}
+BENCHMARK(BM_RegisterFlit);
+
+static void BM_RegisterCredit(benchmark::State& state)
+{
+    Register creditRegister;
+    for (auto _ : state) {
+        creditRegister.pushbackCredit({ 1, false });
+        benchmark::DoNotOptimize(creditRegister.popfrontCredit());
+    }
+}
+BENCHMARK(BM_RegisterCredit);
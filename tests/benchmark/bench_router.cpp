@@ -0,0 +1,111 @@
+#include <chrono>
+#include "Router.h"
+#undef BENCHMARK // the release flag of soxim, a macro of Google Benchmark
+#include <benchmark/benchmark.h>
+
+// reaches the pipeline stages of a router one at a time
+class RouterBenchmark
+{
+public:
+    static void computeRoute(Router& router) { router.computeRoute(); }
+    static void allocateVirtualChannel(Router& router) { router.allocateVirtualChannel(); }
+    static void allocateSwitch(Router& router) { router.allocateSwitch(); }
+    static void traverseSwitch(Router& router) { router.traverseSwitch(); }
+    static std::vector<Connection>& getCrossbar(Router& router) { return router.m_crossbar; }
+    // the stages pack the VC states they change; a restored router is
+    // packed again
+    static void packVirtualChannelStates(Router& router) { router.packVirtualChannelStates(); }
+};
+
+enum class Stage { RC, VA, SA, ST };
+
+// router 5 of a 4x4 mesh with distributed DOR: 4 neighbours and its
+// terminal, occupied input VCs per port each holding a whole packet
+static Router* createRouter(const int occupiedVirtualChannels)
+{
+    g_x = 4;
+    g_y = 4;
+    g_z = 1;
+    g_shape = "MESH";
+    g_routingAlgorithm = "DOR";
+    g_routingMode = "distributed";
+    g_virtualChannelNumber = 4;
+    g_bufferSize = 8;
+    g_flitSize = 1;
+    g_packetSize = 4;
+
+    Router* router = new Router(5);
+    for (int portID : { 1, 4, 6, 9, -6 })
+        router->createPort(portID);
+    router->initiatePriorities();
+    int packetID = 0;
+    for (auto& port : router->m_ports) {
+        for (int i = 0; i < occupiedVirtualChannels; ++i, ++packetID) {
+            Flit head(-1, {});
+            head.m_destination = -((packetID * 7 + 3) % 16) - 1;
+            std::deque<Flit>& virtualChannel = port->m_virtualChannels[i];
+            virtualChannel.push_back(head);
+            for (int j = 0; j < g_packetSize; ++j)
+                virtualChannel.push_back(Flit({ 0.0f }, j));
+            virtualChannel.push_back(Flit(packetID));
+            for (auto& flit : virtualChannel)
+                flit.m_flitVirtualChannel = i;
+            port->m_controlFields[i].m_virtualChannelState = VirtualChannelState::R;
+        }
+    }
+    return router;
+}
+
+// time one stage per iteration; the router is put back into the state
+// before the stage, outside the measured time
+static void runStage(benchmark::State& state, const Stage stage)
+{
+    Router* router = createRouter(static_cast<int>(state.range(0)));
+    // bring the router up to the stage
+    RouterBenchmark::packVirtualChannelStates(*router);
+    if (stage != Stage::RC) {
+        RouterBenchmark::computeRoute(*router);
+        router->updateEnable();
+    }
+    if (stage == Stage::SA || stage == Stage::ST) {
+        RouterBenchmark::allocateVirtualChannel(*router);
+        router->updateEnable();
+    }
+    if (stage == Stage::ST) {
+        RouterBenchmark::allocateSwitch(*router);
+    }
+
+    std::vector<Port> ports;
+    for (auto& port : router->m_ports)
+        ports.push_back(*port);
+    const std::vector<Connection> crossbar = RouterBenchmark::getCrossbar(*router);
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < ports.size(); ++i)
+            *router->m_ports[i] = ports[i];
+        RouterBenchmark::getCrossbar(*router) = crossbar;
+        if (stage == Stage::SA)
+            RouterBenchmark::getCrossbar(*router).clear();
+        RouterBenchmark::packVirtualChannelStates(*router);
+
+        auto start = std::chrono::steady_clock::now();
+        switch (stage) {
+        case Stage::RC: RouterBenchmark::computeRoute(*router); break;
+        case Stage::VA: RouterBenchmark::allocateVirtualChannel(*router); break;
+        case Stage::SA: RouterBenchmark::allocateSwitch(*router); break;
+        case Stage::ST: RouterBenchmark::traverseSwitch(*router); break;
+        }
+        auto end = std::chrono::steady_clock::now();
+        state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+    delete router;
+}
+
+static void BM_RouterComputeRoute(benchmark::State& state) { runStage(state, Stage::RC); }
+static void BM_RouterAllocateVirtualChannel(benchmark::State& state) { runStage(state, Stage::VA); }
+static void BM_RouterAllocateSwitch(benchmark::State& state) { runStage(state, Stage::SA); }
+static void BM_RouterTraverseSwitch(benchmark::State& state) { runStage(state, Stage::ST); }
+BENCHMARK(BM_RouterComputeRoute)->DenseRange(1, 4)->UseManualTime();
+BENCHMARK(BM_RouterAllocateVirtualChannel)->DenseRange(1, 4)->UseManualTime();
+BENCHMARK(BM_RouterAllocateSwitch)->DenseRange(1, 4)->UseManualTime();
+BENCHMARK(BM_RouterTraverseSwitch)->DenseRange(1, 4)->UseManualTime();
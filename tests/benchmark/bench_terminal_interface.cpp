@@ -0,0 +1,75 @@
+#include <chrono>
+#include "TerminalInterface.h"
+#undef BENCHMARK // the release flag of soxim, a macro of Google Benchmark
+#include <benchmark/benchmark.h>
+
+// reaches the injection and ejection paths of a terminal interface
+class TerminalInterfaceBenchmark
+{
+public:
+    static void makeFlits(TerminalInterface& terminal, const Packet& packet) { terminal.makeFlits(packet); }
+    static void receiveFlit(TerminalInterface& terminal) { terminal.receiveFlit(); }
+};
+
+// terminal -1 of a 4x4 mesh routed per hop, so no source routing table
+// is searched; the argument is the packet length in floats
+static TerminalInterface* createTerminal()
+{
+    g_x = 4;
+    g_y = 4;
+    g_z = 1;
+    g_shape = "MESH";
+    g_routingAlgorithm = "DOR";
+    g_routingMode = "distributed";
+    g_virtualChannelNumber = 4;
+    g_flitSize = 1;
+    TerminalInterface* terminal = new TerminalInterface(-1);
+    terminal->getPort(0);
+    return terminal;
+}
+
+// packet to flits into the source queue
+static void BM_TerminalInterfaceInject(benchmark::State& state)
+{
+    TerminalInterface* terminal = createTerminal();
+    const Packet packet(0, -1, -16, std::vector<float>(state.range(0), 1.0f));
+    for (auto _ : state) {
+        TerminalInterfaceBenchmark::makeFlits(*terminal, packet);
+        benchmark::DoNotOptimize(terminal->m_sourceQueue.back());
+        terminal->m_sourceQueue.clear();
+    }
+    state.SetItemsProcessed(state.iterations());
+    delete terminal;
+}
+BENCHMARK(BM_TerminalInterfaceInject)->RangeMultiplier(4)->Range(4, 64);
+
+// flits from the input register through the reorder buffer into a packet;
+// refilling the register is not timed
+static void BM_TerminalInterfaceEject(benchmark::State& state)
+{
+    TerminalInterface* terminal = createTerminal();
+    const Packet packet(0, -16, -1, std::vector<float>(state.range(0), 1.0f));
+    TerminalInterfaceBenchmark::makeFlits(*terminal, packet);
+    std::vector<Flit> flits(terminal->m_sourceQueue.begin(), terminal->m_sourceQueue.end());
+    terminal->m_sourceQueue.clear();
+    for (auto& flit : flits)
+        flit.m_flitVirtualChannel = 0;
+
+    for (auto _ : state) {
+        double seconds = 0.0;
+        for (auto& flit : flits) {
+            terminal->m_port.m_inputRegister.pushbackFlit(flit);
+            terminal->m_port.m_inputRegister.m_flitEnable = true;
+            auto start = std::chrono::steady_clock::now();
+            TerminalInterfaceBenchmark::receiveFlit(*terminal);
+            auto end = std::chrono::steady_clock::now();
+            seconds += std::chrono::duration<double>(end - start).count();
+        }
+        state.SetIterationTime(seconds);
+        terminal->m_inputTrafficInfoBuffer.clear();
+        terminal->m_inputTrafficDataBuffer.clear();
+    }
+    state.SetItemsProcessed(state.iterations());
+    delete terminal;
+}
+BENCHMARK(BM_TerminalInterfaceEject)->RangeMultiplier(4)->Range(4, 64)->UseManualTime();
@@ -0,0 +1,350 @@
+// soxim_scaling: runs a fixed corpus of simulations, one child process
+// each, and reports simulator speed and memory as JSON; with a baseline
+// report it flags every case that got slower or larger than the tolerance
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Simulation.h"
+
+struct ScalingCase
+{
+    std::string m_name;
+    int m_x, m_y, m_z;
+    std::string m_shape;
+    std::string m_routingAlgorithm;
+    std::string m_routingMode;
+    float m_injectionRate;
+};
+
+// what a child process sends back
+struct ScalingSample
+{
+    double m_startupSeconds{};
+    double m_cycleSeconds{};
+    float m_throughput{};
+};
+
+struct ScalingResult
+{
+    ScalingCase m_case;
+    int m_cycles{};
+    double m_startupSeconds{};
+    double m_cyclesPerSecond{};
+    double m_flitsPerSecond{};
+    long m_peakRSS{}; // KiB
+    float m_throughput{};
+    bool m_failed{};
+};
+
+struct ScalingOptions
+{
+    std::string m_outputPath{ "scaling.json" };
+    std::string m_baselinePath{};
+    std::string m_filter{};
+    std::string m_directory{ "/tmp/soxim_scaling/" };
+    double m_tolerance{ 0.1 };
+    int m_cycles{ 1000 };
+};
+
+// low, medium and saturated load of uniform random traffic
+static const std::pair<const char*, float> c_loads[]{
+    { "low", 0.005f }, { "medium", 0.02f }, { "saturated", 0.08f } };
+
+static std::vector<ScalingCase> createCorpus()
+{
+    std::vector<ScalingCase> corpus;
+    for (auto& [load, rate] : c_loads) {
+        // the source routing tables of every terminal pair outgrow memory
+        // beyond 16x16, so the larger meshes route per hop
+        for (int side : { 4, 8, 16 })
+            corpus.push_back({ "mesh" + std::to_string(side) + "_DOR_" + load,
+                side, side, 1, "MESH", "DOR", "source", rate });
+        for (int side : { 32, 64 })
+            corpus.push_back({ "mesh" + std::to_string(side) + "_DOR_distributed_" + load,
+                side, side, 1, "MESH", "DOR", "distributed", rate });
+        corpus.push_back({ std::string("torus4x4x4_DOR_") + load,
+            4, 4, 4, "TORUS", "DOR", "source", rate });
+        // the other algorithms of RegularNetwork::generateRoutes
+        for (const char* algorithm : { "MAD", "ODD_EVEN" })
+            corpus.push_back({ std::string("mesh8_") + algorithm + "_" + load,
+                8, 8, 1, "MESH", algorithm, "source", rate });
+    }
+    return corpus;
+}
+
+static SimulationConfiguration createConfiguration(const ScalingCase& scalingCase,
+    const int cycles)
+{
+    SimulationConfiguration configuration;
+    configuration.m_x = scalingCase.m_x;
+    configuration.m_y = scalingCase.m_y;
+    configuration.m_z = scalingCase.m_z;
+    configuration.m_shape = scalingCase.m_shape;
+    configuration.m_routingAlgorithm = scalingCase.m_routingAlgorithm;
+    configuration.m_routingMode = scalingCase.m_routingMode;
+    configuration.m_virtualChannelNumber = 4;
+    configuration.m_bufferSize = 8;
+    configuration.m_flitSize = 1;
+    configuration.m_packetSize = 4;
+    configuration.m_packetSizeOption = "fixed";
+    configuration.m_injectionRate = scalingCase.m_injectionRate;
+    configuration.m_injectionProcess = "periodic";
+    configuration.m_trafficPattern = "random uniform";
+    configuration.m_totalCycles = cycles;
+    configuration.m_warmupCycles = cycles / 5;
+    configuration.m_measurementCycles = cycles / 2;
+    configuration.m_ejectionSink = "statistics";
+    configuration.m_traceBufferSize = 1 << 16;
+    configuration.m_traceBufferNumber = 2;
+    configuration.m_traceBackpressure = "block";
+    configuration.m_traceFormat = "csv";
+    configuration.m_statisticsWindow = cycles;
+    return configuration;
+}
+
+// meshes beyond 16x16 run fewer cycles, in proportion to their side, since
+// the source queues of a saturated network grow with nodes x cycles
+static int getCycles(const ScalingCase& scalingCase, const ScalingOptions& options)
+{
+    return std::max(10, options.m_cycles * 16 / std::max(16, scalingCase.m_x));
+}
+
+// run one case in a child process, so its peak RSS is its own
+static ScalingResult runCase(const ScalingCase& scalingCase,
+    const ScalingOptions& options)
+{
+    ScalingResult result{ scalingCase, getCycles(scalingCase, options) };
+    int pipeDescriptors[2];
+    if (::pipe(pipeDescriptors) != 0) {
+        result.m_failed = true;
+        return result;
+    }
+    const pid_t child = ::fork();
+    if (child == 0) {
+        ::close(pipeDescriptors[0]);
+        std::string directory = options.m_directory + scalingCase.m_name + "/";
+        std::filesystem::create_directories(directory);
+        Simulation simulation(createConfiguration(scalingCase, result.m_cycles), directory);
+        ScalingSample sample;
+        sample.m_throughput = simulation.run(true, true, false).m_throughput;
+        sample.m_startupSeconds = simulation.getStartupSeconds();
+        sample.m_cycleSeconds = simulation.getCycleSeconds();
+        std::filesystem::remove_all(directory);
+        const bool written = ::write(pipeDescriptors[1], &sample, sizeof(sample))
+            == static_cast<ssize_t>(sizeof(sample));
+        ::_exit(written ? 0 : 1);
+    }
+    ::close(pipeDescriptors[1]);
+
+    ScalingSample sample;
+    const bool read = child > 0 && ::read(pipeDescriptors[0], &sample, sizeof(sample))
+        == static_cast<ssize_t>(sizeof(sample));
+    ::close(pipeDescriptors[0]);
+    int status = 0;
+    struct rusage usage {};
+    if (child < 0 || ::wait4(child, &status, 0, &usage) != child || !read
+        || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        if (WIFSIGNALED(status)) // e.g. SIGKILL of the OOM killer
+            std::cerr << "killed by signal " << WTERMSIG(status) << " ";
+        result.m_failed = true;
+        return result;
+    }
+
+    const int nodes = scalingCase.m_x * scalingCase.m_y * scalingCase.m_z;
+    result.m_startupSeconds = sample.m_startupSeconds;
+    result.m_cyclesPerSecond = result.m_cycles / sample.m_cycleSeconds;
+    // accepted flits per second of wall time, from the measured throughput
+    result.m_flitsPerSecond = sample.m_throughput * nodes * result.m_cyclesPerSecond;
+    result.m_peakRSS = usage.ru_maxrss;
+    result.m_throughput = sample.m_throughput;
+    return result;
+}
+
+// one case per line, so a report reads back line by line as a baseline
+static void writeReport(std::ostream& stream, const std::vector<ScalingResult>& results)
+{
+    stream << "[\n" << std::setprecision(6);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ScalingResult& result = results[i];
+        stream << "  {\"name\": \"" << result.m_case.m_name << "\""
+            << ", \"x\": " << result.m_case.m_x
+            << ", \"y\": " << result.m_case.m_y
+            << ", \"z\": " << result.m_case.m_z
+            << ", \"shape\": \"" << result.m_case.m_shape << "\""
+            << ", \"routing_algorithm\": \"" << result.m_case.m_routingAlgorithm << "\""
+            << ", \"routing_mode\": \"" << result.m_case.m_routingMode << "\""
+            << ", \"injection_rate\": " << result.m_case.m_injectionRate
+            << ", \"cycles\": " << result.m_cycles
+            << ", \"failed\": " << (result.m_failed ? "true" : "false")
+            << ", \"startup_seconds\": " << result.m_startupSeconds
+            << ", \"cycles_per_second\": " << result.m_cyclesPerSecond
+            << ", \"flits_per_second\": " << result.m_flitsPerSecond
+            << ", \"peak_rss_kib\": " << result.m_peakRSS
+            << ", \"throughput\": " << result.m_throughput
+            << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    stream << "]\n";
+}
+
+static double readNumber(const std::string& line, const std::string& key)
+{
+    const size_t position = line.find("\"" + key + "\": ");
+    if (position == std::string::npos)
+        return 0.0;
+    return std::strtod(line.c_str() + position + key.size() + 4, nullptr);
+}
+
+// the cases of a report written by writeReport, by name
+static std::map<std::string, ScalingResult> readReport(const std::string& filePath)
+{
+    std::map<std::string, ScalingResult> results;
+    std::ifstream report(filePath);
+    std::string line;
+    while (std::getline(report, line)) {
+        const size_t begin = line.find("\"name\": \"");
+        if (begin == std::string::npos)
+            continue;
+        const size_t end = line.find('"', begin + 9);
+        ScalingResult result;
+        result.m_case.m_name = line.substr(begin + 9, end - begin - 9);
+        result.m_cycles = static_cast<int>(readNumber(line, "cycles"));
+        result.m_failed = line.find("\"failed\": true") != std::string::npos;
+        result.m_startupSeconds = readNumber(line, "startup_seconds");
+        result.m_cyclesPerSecond = readNumber(line, "cycles_per_second");
+        result.m_flitsPerSecond = readNumber(line, "flits_per_second");
+        result.m_peakRSS = static_cast<long>(readNumber(line, "peak_rss_kib"));
+        results[result.m_case.m_name] = result;
+    }
+    return results;
+}
+
+// print every case outside the tolerance of the baseline; startups within
+// 10 ms of the baseline are noise and are left out
+static int compareReport(const std::vector<ScalingResult>& results,
+    const std::string& baselinePath, const double tolerance)
+{
+    if (!std::filesystem::exists(baselinePath)) {
+        std::cerr << "Error: Baseline not found: " << baselinePath << "\n";
+        return 1;
+    }
+    std::map<std::string, ScalingResult> baseline = readReport(baselinePath);
+    int regressions = 0;
+    for (auto& result : results) {
+        auto found = baseline.find(result.m_case.m_name);
+        if (found == baseline.end() || found->second.m_failed
+            || found->second.m_cycles != result.m_cycles)
+            continue; // not comparable
+        const ScalingResult& before = found->second;
+        auto report = [&](const char* metric, const double was, const double is) {
+            std::cout << "REGRESSION " << result.m_case.m_name << " " << metric
+                << ": " << was << " -> " << is << "\n";
+            ++regressions;
+        };
+        if (result.m_failed)
+            report("failed", 0, 1);
+        else {
+            if (result.m_cyclesPerSecond < before.m_cyclesPerSecond * (1.0 - tolerance))
+                report("cycles_per_second", before.m_cyclesPerSecond, result.m_cyclesPerSecond);
+            if (result.m_peakRSS > before.m_peakRSS * (1.0 + tolerance))
+                report("peak_rss_kib", before.m_peakRSS, result.m_peakRSS);
+            if (result.m_startupSeconds > before.m_startupSeconds + 0.01
+                && result.m_startupSeconds > before.m_startupSeconds * (1.0 + tolerance))
+                report("startup_seconds", before.m_startupSeconds, result.m_startupSeconds);
+        }
+    }
+    std::cout << regressions << " regression(s) against " << baselinePath
+        << " with tolerance " << tolerance << "\n";
+    return regressions ? 1 : 0;
+}
+
+static void printUsage(const char* programName)
+{
+    std::cout << "Usage: " << programName << " [OPTIONS]\n\n"
+        << "Runs the scaling corpus and writes simulator speed and memory as JSON\n\n"
+        << "  -o, --output FILE     JSON report (default: scaling.json)\n"
+        << "  -b, --baseline FILE   Compare against an earlier report, exit 1 on regression\n"
+        << "  -t, --tolerance FRAC  Allowed slowdown or growth (default: 0.1)\n"
+        << "  -f, --filter TEXT     Only cases whose name contains TEXT\n"
+        << "  -c, --cycles CYCLES   Simulated cycles per case up to 16x16 (default: 1000)\n"
+        << "  -d, --directory DIR   Scratch directory of the runs (default: /tmp/soxim_scaling/)\n"
+        << "  -l, --list            List the cases and exit\n";
+}
+
+int main(int argc, char* argv[])
+{
+    ScalingOptions options;
+    bool list = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "-h" || argument == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+        else if (argument == "-l" || argument == "--list")
+            list = true;
+        else if ((argument == "-o" || argument == "--output") && hasValue)
+            options.m_outputPath = argv[++i];
+        else if ((argument == "-b" || argument == "--baseline") && hasValue)
+            options.m_baselinePath = argv[++i];
+        else if ((argument == "-t" || argument == "--tolerance") && hasValue)
+            options.m_tolerance = std::stod(argv[++i]);
+        else if ((argument == "-f" || argument == "--filter") && hasValue)
+            options.m_filter = argv[++i];
+        else if ((argument == "-c" || argument == "--cycles") && hasValue)
+            options.m_cycles = std::stoi(argv[++i]);
+        else if ((argument == "-d" || argument == "--directory") && hasValue)
+            options.m_directory = std::string(argv[++i]) + "/";
+        else {
+            std::cerr << "Error: Unknown option: " << argument << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.m_cycles < 10) {
+        std::cerr << "Error: At least 10 cycles per case are needed\n";
+        return 1;
+    }
+
+    std::vector<ScalingResult> results;
+    for (auto& scalingCase : createCorpus()) {
+        if (scalingCase.m_name.find(options.m_filter) == std::string::npos)
+            continue;
+        if (list) {
+            std::cout << scalingCase.m_name << "\n";
+            continue;
+        }
+        std::cout << std::left << std::setw(36) << scalingCase.m_name << std::flush;
+        results.push_back(runCase(scalingCase, options));
+        const ScalingResult& result = results.back();
+        if (result.m_failed)
+            std::cout << "failed\n";
+        else
+            std::cout << std::right << std::setw(12) << result.m_cyclesPerSecond << " cycles/s"
+                << std::setw(14) << result.m_flitsPerSecond << " flits/s"
+                << std::setw(10) << result.m_peakRSS << " KiB\n" << std::left;
+    }
+    if (list)
+        return 0;
+
+    std::ofstream report(options.m_outputPath);
+    if (!report.is_open()) {
+        std::cerr << "Error: Could not write report: " << options.m_outputPath << "\n";
+        return 1;
+    }
+    writeReport(report, results);
+    report.close();
+    std::cout << "Report written to " << options.m_outputPath << "\n";
+
+    if (!options.m_baselinePath.empty())
+        return compareReport(results, options.m_baselinePath, options.m_tolerance);
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "Arena.h"
+#include "RegularNetwork.h"
+#include "Simulation.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+
+static std::string makeOutputDirectory(const std::string& name)
+{
+    std::string directory = "/tmp/test_arena/" + name + "/";
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+struct Counted
+{
+    Counted(const int value) : m_value(value) { ++s_alive; }
+    ~Counted() { --s_alive; }
+
+    long long m_value = 0;
+    static inline int s_alive = 0;
+};
+
+// Test that allocations are aligned, in the arena, and grow it past its capacity
+TEST(ArenaTest, Allocate)
+{
+    Arena arena("none", 1000);
+    EXPECT_EQ(arena.getMappedBytes(), 2u << 20); // whole huge pages
+    void* first = arena.allocate(3, 1);
+    void* second = arena.allocate(sizeof(double), alignof(double));
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(second) % alignof(double), 0u);
+    EXPECT_EQ(static_cast<char*>(second) - static_cast<char*>(first), 8);
+    EXPECT_TRUE(arena.contains(first));
+    EXPECT_TRUE(arena.contains(second));
+    EXPECT_EQ(arena.getUsedBytes(), 16u);
+
+    void* large = arena.allocate(3 << 20, 64);
+    std::memset(large, 1, 3 << 20);
+    EXPECT_TRUE(arena.contains(large));
+    EXPECT_EQ(arena.getMappedBytes(), (2u << 20) + (4u << 20));
+    EXPECT_EQ(arena.getUsedBytes(), 16u + (3u << 20));
+
+    int local = 0;
+    EXPECT_FALSE(arena.contains(&local));
+}
+
+// Test that objects go into the active arena and on the heap without one
+TEST(ArenaTest, CreateAndDestroy)
+{
+    Arena arena("thp", 0);
+    Counted* onHeap = Arena::create<Counted>(1);
+    {
+        ActiveArena activeArena(&arena);
+        EXPECT_EQ(Arena::getActive(), &arena);
+        Counted* inArena = Arena::create<Counted>(2);
+        EXPECT_TRUE(arena.contains(inArena));
+        EXPECT_FALSE(arena.contains(onHeap));
+        EXPECT_EQ(inArena->m_value, 2);
+        EXPECT_EQ(Counted::s_alive, 2);
+        Arena::destroy(inArena);
+        EXPECT_EQ(Counted::s_alive, 1);
+    }
+    EXPECT_EQ(Arena::getActive(), nullptr);
+    // an object made on the heap is destroyed without an active arena
+    Arena::destroy(onHeap);
+    EXPECT_EQ(Counted::s_alive, 0);
+}
+
+// Test that reserved huge pages fall back to normal mappings without any
+TEST(ArenaTest, HugeTLBFallsBack)
+{
+    Arena arena("hugetlb", 0);
+    char* bytes = static_cast<char*>(arena.allocate(4096, 64));
+    std::memset(bytes, 7, 4096);
+    EXPECT_EQ(bytes[4095], 7);
+    EXPECT_TRUE(arena.contains(bytes));
+}
+
+// Test that the backing of the network arena does not change results
+TEST(ArenaTest, Simulation)
+{
+    SimulationConfiguration configuration;
+    configuration.m_x = 4;
+    configuration.m_y = 4;
+    configuration.m_z = 2;
+    configuration.m_shape = "TORUS";
+    configuration.m_routingAlgorithm = "DOR";
+    configuration.m_virtualChannelNumber = 4;
+    configuration.m_bufferSize = 8;
+    configuration.m_flitSize = 1;
+    configuration.m_packetSize = 4;
+    configuration.m_packetSizeOption = "fixed";
+    configuration.m_injectionRate = 0.05f;
+    configuration.m_injectionProcess = "periodic";
+    configuration.m_trafficPattern = "random uniform";
+    configuration.m_totalCycles = 1000;
+    configuration.m_warmupCycles = 200;
+    configuration.m_measurementCycles = 500;
+    configuration.m_ejectionSink = "statistics";
+    configuration.m_traceBufferSize = 1 << 16;
+    configuration.m_traceBufferNumber = 2;
+    configuration.m_traceBackpressure = "block";
+    configuration.m_traceFormat = "csv";
+    configuration.m_statisticsWindow = 1000;
+
+    Performance none = Simulation(configuration, makeOutputDirectory("none"))
+        .run(true, true, false);
+    EXPECT_GT(none.m_throughput, 0.0f);
+    EXPECT_EQ(Arena::getActive(), nullptr);
+    for (std::string hugePages : { "thp", "hugetlb" }) {
+        configuration.m_hugePages = hugePages;
+        Performance performance = Simulation(configuration,
+            makeOutputDirectory(hugePages)).run(true, true, false);
+        EXPECT_EQ(performance.m_throughput, none.m_throughput) << hugePages;
+        EXPECT_EQ(performance.m_latency, none.m_latency) << hugePages;
+    }
+}
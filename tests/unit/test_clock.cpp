@@ -134,3 +134,14 @@ TEST(ClockTest, TriggerAfterReset)
     clock.tick();
     EXPECT_TRUE(clock.trigger());  // 2.0f >= 0.0f
 }
+
+// Test that the clock keeps counting past 2^24, where a float stops
+TEST(ClockTest, CountPastFloatPrecision)
+{
+    Clock::reset();
+    Clock clock;
+    for (long long i = 0; i < (1LL << 24) + 3; ++i)
+        clock.tick();
+    EXPECT_EQ(clock.get(), 16777219.0);
+    Clock::reset();
+}
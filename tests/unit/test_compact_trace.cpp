@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include "CompactTrace.h"
+#include <filesystem>
+
+static std::vector<TrafficInformationEntry> makeEntries(const int number)
+{
+    std::vector<TrafficInformationEntry> entries;
+    for (int i = 0; i < number; ++i) {
+        int source = -(i % 16) - 1;
+        int destination = -((i * 7) % 16) - 1;
+        float sentTime = static_cast<float>(i);
+        if (i % 3 == 0)
+            entries.push_back({ i / 16, source, destination, 20, "S", sentTime, 0 });
+        else
+            entries.push_back({ i / 16, source, destination, 1 + i % 20, "R",
+                sentTime, sentTime + 10 + i % 7 });
+    }
+    return entries;
+}
+
+// Test that encoding and decoding round-trips every field
+TEST(CompactTraceTest, RoundTrip)
+{
+    std::filesystem::create_directories("/tmp/test_compact_trace");
+    std::string filePath = "/tmp/test_compact_trace/roundtrip.sxt";
+    auto entries = makeEntries(10000);
+    {
+        CompactTraceWriter writer(filePath, 256);
+        for (auto& entry : entries)
+            writer.write(entry);
+    }
+
+    CompactTraceReader reader(filePath);
+    ASSERT_TRUE(reader.isOpen());
+    EXPECT_EQ(reader.getRecordNumber(), 10000);
+    auto decoded = reader.read();
+    ASSERT_EQ(decoded.size(), entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        EXPECT_EQ(decoded[i].m_packetID, entries[i].m_packetID);
+        EXPECT_EQ(decoded[i].m_source, entries[i].m_source);
+        EXPECT_EQ(decoded[i].m_destination, entries[i].m_destination);
+        EXPECT_EQ(decoded[i].m_packetSize, entries[i].m_packetSize);
+        EXPECT_EQ(decoded[i].m_status, entries[i].m_status);
+        EXPECT_FLOAT_EQ(decoded[i].m_sentTime, entries[i].m_sentTime);
+        EXPECT_FLOAT_EQ(decoded[i].m_receivedTime, entries[i].m_receivedTime);
+    }
+
+    // a few bytes per record instead of a CSV line
+    EXPECT_LT(std::filesystem::file_size(filePath), 10000u * 8);
+}
+
+// Test seeking by time range
+TEST(CompactTraceTest, ReadTimeRange)
+{
+    std::filesystem::create_directories("/tmp/test_compact_trace");
+    std::string filePath = "/tmp/test_compact_trace/range.sxt";
+    auto entries = makeEntries(5000);
+    {
+        CompactTraceWriter writer(filePath, 128);
+        for (auto& entry : entries)
+            writer.write(entry);
+    }
+
+    CompactTraceReader reader(filePath);
+    ASSERT_TRUE(reader.isOpen());
+    auto ranged = reader.read(1000, 2000);
+
+    size_t expected = 0;
+    for (auto& entry : entries) {
+        if (getTraceTime(entry) >= 1000 && getTraceTime(entry) < 2000)
+            expected++;
+    }
+    EXPECT_EQ(ranged.size(), expected);
+    for (auto& entry : ranged) {
+        EXPECT_GE(getTraceTime(entry), 1000);
+        EXPECT_LT(getTraceTime(entry), 2000);
+    }
+}
+
+// Test that an empty trace is still readable
+TEST(CompactTraceTest, EmptyTrace)
+{
+    std::filesystem::create_directories("/tmp/test_compact_trace");
+    std::string filePath = "/tmp/test_compact_trace/empty.sxt";
+    {
+        CompactTraceWriter writer(filePath);
+    }
+    CompactTraceReader reader(filePath);
+    EXPECT_TRUE(reader.isOpen());
+    EXPECT_EQ(reader.getRecordNumber(), 0);
+    EXPECT_TRUE(reader.read().empty());
+}
+
+// Test that a missing file is reported
+TEST(CompactTraceTest, MissingFile)
+{
+    CompactTraceReader reader("/tmp/test_compact_trace/does_not_exist.sxt");
+    EXPECT_FALSE(reader.isOpen());
+}
@@ -4,12 +4,15 @@
 // Test Flit construction and properties
 TEST(FlitTest, HeadFlitConstruction)
 {
-    std::deque<int> route = {1, 2, 3};
+    std::vector<int> route = {1, 2, 3};
     Flit flit(0, route);
     
     EXPECT_EQ(flit.m_flitType, FlitType::H);
     EXPECT_EQ(flit.m_source, 0);
-    EXPECT_EQ(flit.m_route, route);
+    // the head points into the route instead of copying it
+    EXPECT_EQ(flit.m_route, route.data());
+    EXPECT_EQ(flit.m_destination, 3);
+    EXPECT_EQ(Flit(0, {}).m_route, nullptr);
 }
 
 TEST(FlitTest, BodyFlitConstruction)
@@ -34,9 +37,10 @@ TEST(FlitTest, EqualityOperator)
 {
     // Flit equality only compares m_flitType, m_flitVirtualChannel, and m_flitNumberB
     // m_source and m_route are not compared
-    Flit flit1(1, {1, 2});
-    Flit flit2(1, {1, 2});
-    Flit flit3(2, {1, 2});
+    static const int route[] = {1, 2};
+    Flit flit1(1, route);
+    Flit flit2(1, route);
+    Flit flit3(2, route);
 
     // All three have same flitType (H), same flitVirtualChannel (-1), same flitNumberB (-1)
     EXPECT_TRUE(flit1 == flit2);
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include "FlitTracer.h"
+#include "Simulation.h"
+#include <filesystem>
+#include <map>
+
+static std::string makeOutputDirectory(const std::string& name)
+{
+    std::string directory = "/tmp/test_flit_tracer/" + name + "/";
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+static SimulationConfiguration makeConfiguration()
+{
+    SimulationConfiguration configuration;
+    configuration.m_x = 4;
+    configuration.m_y = 4;
+    configuration.m_z = 1;
+    configuration.m_shape = "MESH";
+    configuration.m_routingAlgorithm = "DOR";
+    configuration.m_virtualChannelNumber = 2;
+    configuration.m_bufferSize = 8;
+    configuration.m_flitSize = 1;
+    configuration.m_packetSize = 4;
+    configuration.m_packetSizeOption = "fixed";
+    configuration.m_injectionRate = 0.05f;
+    configuration.m_injectionProcess = "periodic";
+    configuration.m_trafficPattern = "random uniform";
+    configuration.m_totalCycles = 1000;
+    configuration.m_warmupCycles = 200;
+    configuration.m_measurementCycles = 500;
+    configuration.m_ejectionSink = "statistics";
+    configuration.m_traceBufferSize = 1 << 16;
+    configuration.m_traceBufferNumber = 2;
+    configuration.m_traceBackpressure = "block";
+    configuration.m_traceFormat = "csv";
+    configuration.m_statisticsWindow = 1000;
+    return configuration;
+}
+
+static std::deque<Flit> makePacketFlits(const int source, const int destination)
+{
+    std::deque<Flit> flits;
+    flits.push_back(Flit(source, {}));
+    flits.front().m_destination = destination;
+    flits.push_back(Flit(std::vector<float>(g_flitSize), 0));
+    flits.push_back(Flit(7));
+    return flits;
+}
+
+// Test that tagged flits are recorded, spilled and read back in order
+TEST(FlitTracerTest, RecordAndRead)
+{
+    std::string filePath = makeOutputDirectory("record") + "FlitTrace.sft";
+    g_flitTraceSample = 1;
+    g_flitTraceSource = -1;
+    g_flitTraceDestination = -1;
+    {
+        FlitTracer tracer(filePath, 16);
+        ASSERT_TRUE(tracer.isOpen());
+        FlitTracer::setActive(&tracer);
+        std::deque<Flit> flits = makePacketFlits(-1, -3);
+        FlitTracer::tagPacket(flits.begin(), flits.end(), 7);
+        for (auto& flit : flits)
+            EXPECT_EQ(flit.m_traceID, 0);
+        for (auto& flit : flits)
+            FlitTracer::trace(flit, FlitTraceEvent::DEPART, 5, 6, 1);
+        FlitTracer::setActive(nullptr);
+        tracer.close();
+        EXPECT_EQ(tracer.getRecordNumber(), 4);
+        EXPECT_EQ(tracer.getDroppedRecordNumber(), 0);
+    }
+
+    std::vector<FlitTraceRecord> records = readFlitTrace(filePath);
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[0].m_event, FlitTraceEvent::INJECT);
+    EXPECT_EQ(records[0].m_node, -1);
+    EXPECT_EQ(records[0].m_port, -3);
+    EXPECT_EQ(records[0].m_packetID, 7);
+    EXPECT_EQ(records[3].m_event, FlitTraceEvent::DEPART);
+    EXPECT_EQ(records[3].m_flitType, 'T');
+    EXPECT_EQ(records[3].m_source, -1);
+    EXPECT_EQ(records[3].m_node, 5);
+    EXPECT_EQ(records[3].m_port, 6);
+    EXPECT_EQ(records[3].m_virtualChannel, 1);
+}
+
+// Test that untagged flits and flits without an active tracer are not recorded
+TEST(FlitTracerTest, SamplingAndFilters)
+{
+    std::string filePath = makeOutputDirectory("filter") + "FlitTrace.sft";
+    g_flitTraceSample = 2;
+    g_flitTraceSource = 0; // node 0, terminal interface -1
+    g_flitTraceDestination = -1;
+    FlitTracer tracer(filePath, 16);
+    FlitTracer::setActive(&tracer);
+
+    std::deque<Flit> odd = makePacketFlits(-1, -3);
+    FlitTracer::tagPacket(odd.begin(), odd.end(), 3);
+    EXPECT_EQ(odd.front().m_traceID, -1);
+    std::deque<Flit> otherSource = makePacketFlits(-2, -3);
+    FlitTracer::tagPacket(otherSource.begin(), otherSource.end(), 4);
+    EXPECT_EQ(otherSource.front().m_traceID, -1);
+    std::deque<Flit> sampled = makePacketFlits(-1, -3);
+    FlitTracer::tagPacket(sampled.begin(), sampled.end(), 4);
+    EXPECT_EQ(sampled.back().m_traceID, 0);
+
+    FlitTracer::trace(odd.front(), FlitTraceEvent::ARRIVE, 0, 1, 0);
+    FlitTracer::setActive(nullptr);
+    FlitTracer::trace(sampled.front(), FlitTraceEvent::ARRIVE, 0, 1, 0);
+    tracer.close();
+    EXPECT_EQ(readFlitTrace(filePath).size(), 1u); // the INJECT record
+    g_flitTraceSample = 0;
+    g_flitTraceSource = -1;
+}
+
+// Test that a traced run records every hop of the sampled packets and
+// simulates the same as an untraced run
+TEST(FlitTracerTest, TracedSimulation)
+{
+    SimulationConfiguration configuration = makeConfiguration();
+    Performance untraced = Simulation(configuration,
+        makeOutputDirectory("untraced")).run(true, true, false);
+
+    configuration.m_flitTraceSample = 4;
+    std::string directory = makeOutputDirectory("traced");
+    Performance traced = Simulation(configuration, directory).run(true, true, false);
+    EXPECT_EQ(traced.m_throughput, untraced.m_throughput);
+    EXPECT_EQ(traced.m_latency, untraced.m_latency);
+
+    std::vector<FlitTraceRecord> records = readFlitTrace(directory + "FlitTrace.sft");
+    ASSERT_FALSE(records.empty());
+    std::map<int, std::map<FlitTraceEvent, int>> events; // per trace ID
+    int lastCycle = 0;
+    for (auto& record : records) {
+        EXPECT_EQ(record.m_packetID % 4, 0);
+        EXPECT_GE(record.m_cycle, lastCycle);
+        lastCycle = record.m_cycle;
+        ++events[record.m_traceID][record.m_event];
+    }
+    // DOR in a 4x4 mesh: a packet of six flits crosses one to seven routers
+    int delivered = 0;
+    for (auto& [traceID, counts] : events) {
+        EXPECT_EQ(counts[FlitTraceEvent::INJECT], 1);
+        if (counts[FlitTraceEvent::EJECT] < 6)
+            continue; // still in flight at the end of the run
+        ++delivered;
+        EXPECT_EQ(counts[FlitTraceEvent::SEND], 6);
+        EXPECT_EQ(counts[FlitTraceEvent::ARRIVE], counts[FlitTraceEvent::DEPART]);
+        EXPECT_EQ(counts[FlitTraceEvent::ARRIVE], counts[FlitTraceEvent::SA_GRANT]);
+        EXPECT_EQ(counts[FlitTraceEvent::ROUTE], counts[FlitTraceEvent::VA_GRANT]);
+        EXPECT_EQ(counts[FlitTraceEvent::ARRIVE], 6 * counts[FlitTraceEvent::ROUTE]);
+        EXPECT_GE(counts[FlitTraceEvent::ROUTE], 1);
+        EXPECT_LE(counts[FlitTraceEvent::ROUTE], 7);
+    }
+    EXPECT_GT(delivered, 0);
+}
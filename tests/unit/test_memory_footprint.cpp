@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include "MemoryFootprint.h"
+#include "Simulation.h"
+#include "Sweep.h"
+#include <filesystem>
+
+static SimulationConfiguration makeConfiguration()
+{
+    SimulationConfiguration configuration;
+    configuration.m_x = 4;
+    configuration.m_y = 4;
+    configuration.m_z = 1;
+    configuration.m_shape = "MESH";
+    configuration.m_routingAlgorithm = "DOR";
+    configuration.m_virtualChannelNumber = 2;
+    configuration.m_bufferSize = 8;
+    configuration.m_flitSize = 1;
+    configuration.m_packetSize = 4;
+    configuration.m_packetSizeOption = "fixed";
+    configuration.m_injectionRate = 0.05f;
+    configuration.m_injectionProcess = "periodic";
+    configuration.m_trafficPattern = "random uniform";
+    configuration.m_totalCycles = 1000;
+    configuration.m_warmupCycles = 200;
+    configuration.m_measurementCycles = 500;
+    configuration.m_ejectionSink = "statistics";
+    configuration.m_traceBufferSize = 1 << 16;
+    configuration.m_traceBufferNumber = 2;
+    configuration.m_traceBackpressure = "block";
+    configuration.m_traceFormat = "csv";
+    configuration.m_statisticsWindow = 1000;
+    return configuration;
+}
+
+static RegularNetwork* createNetwork()
+{
+    RegularNetwork* network = new RegularNetwork;
+    for (int i = 0; i < network->getRouterNumber(); ++i)
+        network->connectTerminal(i);
+    network->loadNetworkData();
+    return network;
+}
+
+// Test the container estimates against the libstdc++ layout
+TEST(MemoryFootprintTest, HeapBytes)
+{
+    EXPECT_EQ(getHeapBytes(std::deque<int>{}), 512u + 8 * sizeof(int*));
+    EXPECT_EQ(getHeapBytes(std::deque<int>(200)), 2 * 512u + 8 * sizeof(int*));
+    std::vector<float> data;
+    data.reserve(10);
+    EXPECT_EQ(getHeapBytes(data), 10 * sizeof(float));
+
+    g_flitSize = 1;
+    Register flitRegister;
+    size_t empty = flitRegister.getHeapBytes();
+    static const int route[] = { 1, 2, -3 };
+    flitRegister.pushbackFlit(Flit(-1, route));
+    EXPECT_GT(flitRegister.getHeapBytes(), empty);
+}
+
+// Test that the routing tables are accounted to source routing only and
+// that a network does not hold more than its estimate
+TEST(MemoryFootprintTest, MeasureNetwork)
+{
+    SimulationConfiguration configuration = makeConfiguration();
+    configuration.apply();
+    RegularNetwork* network = createNetwork();
+    MemoryFootprint footprint;
+    network->measureMemory(footprint);
+    delete network;
+    EXPECT_GT(footprint[MemorySubsystem::VIRTUAL_CHANNELS], 0u);
+    EXPECT_GT(footprint[MemorySubsystem::REGISTERS], 0u);
+    // every route holds its destination at least
+    EXPECT_GT(footprint[MemorySubsystem::ROUTING_TABLES], 16u * 15 * sizeof(int));
+    // empty source queues hold one deque node each
+    EXPECT_EQ(footprint[MemorySubsystem::SOURCE_QUEUES], 16 * getHeapBytes(std::deque<Flit>{}));
+
+    MemoryFootprint estimate = estimateMemoryFootprint(configuration);
+    for (auto subsystem : { MemorySubsystem::VIRTUAL_CHANNELS,
+        MemorySubsystem::REGISTERS, MemorySubsystem::ROUTING_TABLES })
+        EXPECT_LE(footprint[subsystem], estimate[subsystem]);
+
+    configuration.m_routingMode = "distributed";
+    configuration.apply();
+    network = createNetwork();
+    MemoryFootprint distributed;
+    network->measureMemory(distributed);
+    delete network;
+    EXPECT_EQ(distributed[MemorySubsystem::ROUTING_TABLES], 0u);
+    EXPECT_EQ(estimateMemoryFootprint(configuration)[MemorySubsystem::ROUTING_TABLES], 0u);
+
+    // a bounded source queue holds one packet beyond its capacity at most
+    size_t unbounded = estimateMemoryFootprint(configuration)[MemorySubsystem::SOURCE_QUEUES];
+    configuration.m_sourceQueueCapacity = 16;
+    size_t bounded = estimateMemoryFootprint(configuration)[MemorySubsystem::SOURCE_QUEUES];
+    EXPECT_LT(bounded, unbounded);
+    EXPECT_EQ(bounded * 50 * 6, unbounded * (16 + 6 - 1)); // 50 packets of 6 flits per node
+}
+
+// Test that the account keeps the peak per subsystem and of the total
+TEST(MemoryFootprintTest, AccountPeak)
+{
+    MemoryAccount account(4);
+    MemoryFootprint first, second;
+    first[MemorySubsystem::SOURCE_QUEUES] = 4096;
+    second[MemorySubsystem::SOURCE_QUEUES] = 1024;
+    second[MemorySubsystem::TRAFFIC_BUFFERS] = 2048;
+    std::ostringstream samples;
+    account.sample("warmup", first, &samples);
+    account.sample("drain", second, nullptr);
+    EXPECT_EQ(account.getPeak(), 4096u);
+    EXPECT_NE(samples.str().find("Memory after warmup"), std::string::npos);
+
+    std::ostringstream report;
+    account.report(report);
+    EXPECT_NE(report.str().find("source queues"), std::string::npos);
+    EXPECT_NE(report.str().find("total"), std::string::npos);
+}
+
+// Test that a sweep skips the points over its memory limit and keeps
+// their rows without results
+TEST(MemoryFootprintTest, SweepRefusesOversizedPoints)
+{
+    std::string directory = "/tmp/test_memory_footprint/sweep/";
+    std::filesystem::remove_all(directory);
+    SweepGrid grid;
+    grid.m_injectionRates = { 0.01f, 0.5f };
+    SimulationConfiguration configuration = makeConfiguration();
+    configuration.m_routingMode = "distributed";
+    size_t small = estimateMemoryFootprint([&] {
+        SimulationConfiguration point = configuration;
+        point.m_injectionRate = 0.01f;
+        return point;
+    }()).getTotal();
+
+    Sweep sweep(configuration, grid, directory);
+    sweep.setMemoryLimit(small + small / 2);
+    sweep.run(1);
+    ASSERT_EQ(sweep.getPoints().size(), 2u);
+    EXPECT_FALSE(sweep.getPoints()[0].m_refused);
+    EXPECT_GT(sweep.getPoints()[0].m_performance.m_throughput, 0.0f);
+    EXPECT_TRUE(sweep.getPoints()[1].m_refused);
+
+    std::ostringstream table;
+    sweep.writeResults(table);
+    EXPECT_NE(table.str().find("0.5,,,,,,\n"), std::string::npos);
+}
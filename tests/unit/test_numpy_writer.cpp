@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "NumpyWriter.h"
+#include <cstring>
+#include <filesystem>
+
+static std::string readFile(const std::string& filePath)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+static unsigned int readUint32(const std::string& bytes, size_t position)
+{
+    unsigned int value = 0;
+    for (int i = 3; i >= 0; --i)
+        value = (value << 8) | static_cast<unsigned char>(bytes[position + i]);
+    return value;
+}
+
+// Test that the header is aligned and its length does not depend on the shape
+TEST(NumpyWriterTest, HeaderLayout)
+{
+    std::string empty = makeNpyHeader(getTrafficInformationFields(), 0);
+    std::string large = makeNpyHeader(getTrafficInformationFields(), 123456789012ULL);
+    EXPECT_EQ(empty.size(), large.size());
+    EXPECT_EQ(empty.size() % 64, 0u);
+    EXPECT_EQ(empty.substr(0, 8), std::string("\x93NUMPY\x01\x00", 8));
+    EXPECT_EQ(empty.back(), '\n');
+    EXPECT_NE(large.find("'shape': (123456789012,)"), std::string::npos);
+    EXPECT_NE(empty.find("('status', '|S1')"), std::string::npos);
+}
+
+// Test that streamed records follow the header and the shape is patched on close
+TEST(NumpyWriterTest, StreamRecords)
+{
+    std::filesystem::create_directories("/tmp/test_numpy_writer");
+    std::string filePath = "/tmp/test_numpy_writer/records.npy";
+    {
+        NpyWriter writer(filePath, getTrafficInformationFields());
+        for (int i = 0; i < 1000; ++i)
+            writer.write(makeTrafficInformationRecord(
+                { i, -1, -2, 20, "R", static_cast<float>(i), i + 30.5f }));
+    }
+
+    std::string bytes = readFile(filePath);
+    std::string header = makeNpyHeader(getTrafficInformationFields(), 1000);
+    ASSERT_EQ(bytes.size(), header.size() + 1000 * 33);
+    EXPECT_EQ(bytes.substr(0, header.size()), header);
+
+    // last record: packet_id, ..., status, received_time
+    size_t record = header.size() + 999 * 33;
+    EXPECT_EQ(readUint32(bytes, record), 999u);
+    EXPECT_EQ(static_cast<int>(readUint32(bytes, record + 4)), -1);
+    EXPECT_EQ(bytes[record + 16], 'R');
+    double receivedTime;
+    std::memcpy(&receivedTime, bytes.data() + record + 25, sizeof(receivedTime));
+    EXPECT_DOUBLE_EQ(receivedTime, 1029.5);
+}
+
+// Test that the archive is a valid stored zip with one member per array
+TEST(NumpyWriterTest, NpzArchive)
+{
+    std::filesystem::create_directories("/tmp/test_numpy_writer");
+    std::string filePath = "/tmp/test_numpy_writer/results.npz";
+    std::string array = makeNpyArray({ 1.0, 2.0, 3.0 });
+    {
+        NpzWriter writer(filePath);
+        writer.add("latency", makeNpyScalar(42.0));
+        writer.add("window_start", array);
+    }
+
+    std::string bytes = readFile(filePath);
+    EXPECT_EQ(readUint32(bytes, 0), 0x04034B50u);
+    // end of central directory record with two entries
+    ASSERT_GE(bytes.size(), 22u);
+    size_t end = bytes.size() - 22;
+    EXPECT_EQ(readUint32(bytes, end), 0x06054B50u);
+    EXPECT_EQ(bytes[end + 10], 2);
+    EXPECT_NE(bytes.find("latency.npy"), std::string::npos);
+    EXPECT_NE(bytes.find(array), std::string::npos);
+    // CRC-32 of the first member, as stored in the local header
+    std::string scalar = makeNpyScalar(42.0);
+    EXPECT_EQ(readUint32(bytes, 18), scalar.size());
+}
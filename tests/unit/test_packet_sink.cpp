@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include "PacketSink.h"
+#include "TrafficOperator.h"
+#include "RegularNetwork.h"
+#include "TerminalInterface.h"
+#include <filesystem>
+
+static void setUpParameters()
+{
+    g_x = 2;
+    g_y = 2;
+    g_z = 1;
+    g_shape = "MESH";
+    g_routingAlgorithm = "DOR";
+    g_virtualChannelNumber = 2;
+    g_bufferSize = 4;
+    g_flitSize = 1;
+    g_packetSize = 4;
+    g_packetSizeOption = "fixed";
+    g_injectionRate = 0.1f;
+    g_injectionProcess = "periodic";
+    g_alpha = 0.5f;
+    g_beta = 0.5f;
+    g_trafficPattern = "random uniform";
+    g_totalCycles = 200;
+    g_warmupCycles = 0;
+    g_measurementCycles = 200;
+    g_drainCycles = 0;
+    g_packetNumber = 5;
+}
+
+// Test StatisticsSink accounting inside and outside the measurement window
+TEST(PacketSinkTest, StatisticsSinkWindow)
+{
+    setUpParameters();
+    g_warmupCycles = 10;
+    g_measurementCycles = 10;
+
+    StatisticsSink sink;
+    sink.writeSentPacket({ 0, -1, -2, 4, "S", 12, 0 });
+    sink.writeSentPacket({ 1, -1, -2, 4, "S", 5, 0 });
+    sink.writeReceivedPacket({ 0, -1, -2, 4, "R", 12, 18 }, {});
+    sink.writeReceivedPacket({ 1, -1, -2, 4, "R", 5, 15 }, {});
+
+    EXPECT_FLOAT_EQ(sink.m_trafficData.m_sentPacketNumber, 1);
+    EXPECT_FLOAT_EQ(sink.m_trafficData.m_sentFlitNumber, 4);
+    EXPECT_FLOAT_EQ(sink.m_trafficData.m_receivedPacketNumber, 2);
+    EXPECT_FLOAT_EQ(sink.m_trafficData.m_receivedFlitNumber, 8);
+    EXPECT_FLOAT_EQ(sink.m_trafficData.m_accumulatedLatency, 5);
+}
+
+// Test that counts and latencies stay exact in a run past 2^24 cycles
+TEST(PacketSinkTest, StatisticsSinkPastFloatPrecision)
+{
+    setUpParameters();
+    const double start = 1 << 24;
+    g_warmupCycles = 1 << 24;
+    g_measurementCycles = 1 << 24;
+    g_statisticsWindow = 1 << 20;
+
+    StatisticsSink sink;
+    const long long packetNumber = (1LL << 24) + 3;
+    for (long long i = 0; i < packetNumber; ++i)
+        sink.writeSentPacket({ 0, -1, -2, 1, "S", start + 1, 0 });
+    sink.writeReceivedPacket({ 0, -1, -2, 4, "R", start + 1, start + 4 }, {});
+
+    EXPECT_EQ(sink.m_trafficData.m_sentPacketNumber, packetNumber);
+    EXPECT_EQ(sink.m_trafficData.m_sentFlitNumber, packetNumber);
+    EXPECT_EQ(sink.m_trafficData.m_receivedPacketNumber, 1);
+    EXPECT_DOUBLE_EQ(sink.m_trafficData.m_accumulatedLatency, 2.0);
+    g_statisticsWindow = 1000;
+}
+
+// Test that a terminal interface with a sink retains no received packets
+TEST(PacketSinkTest, CallbackSinkConsumesPackets)
+{
+    setUpParameters();
+
+    RegularNetwork network;
+    for (int i = 0; i < 4; ++i) {
+        network.connectTerminal(i);
+    }
+    network.loadNetworkData();
+
+    std::string trafficFolderPath = "/tmp/test_packet_sink/";
+    std::filesystem::create_directories(trafficFolderPath);
+    TrafficOperator trafficOp(trafficFolderPath, &network);
+    trafficOp.generateTraffic();
+
+    int receivedPacketNumber{};
+    CallbackSink sink([&](const TrafficInformationEntry& entry,
+        const std::vector<float>& data) {
+        EXPECT_EQ(entry.m_status, "R");
+        EXPECT_GT(entry.m_receivedTime, entry.m_sentTime);
+        EXPECT_EQ(static_cast<int>(data.size()), entry.m_packetSize);
+        receivedPacketNumber++;
+    });
+    for (auto& ti : network.m_terminalInterfaces)
+        ti->m_packetSink = &sink;
+
+    for (Clock clk; clk.get() < g_totalCycles; clk.tick())
+        network.runOneCycle();
+
+    EXPECT_GT(receivedPacketNumber, 0);
+    for (auto& ti : network.m_terminalInterfaces) {
+        EXPECT_TRUE(ti->m_inputTrafficInfoBuffer.empty());
+        EXPECT_TRUE(ti->m_inputTrafficDataBuffer.empty());
+        ti->m_packetSink = nullptr;
+    }
+}
+
+// Test that with a sink packets are drawn when due instead of buffered ahead
+TEST(PacketSinkTest, SinkDrawsPacketsWhenDue)
+{
+    setUpParameters();
+    g_ejectionSink = "statistics";
+    Clock::reset();
+
+    RegularNetwork network;
+    for (int i = 0; i < 4; ++i) {
+        network.connectTerminal(i);
+    }
+    network.loadNetworkData();
+
+    std::string trafficFolderPath = "/tmp/test_packet_sink/drawn/";
+    std::filesystem::create_directories(trafficFolderPath);
+    {
+        TrafficOperator trafficOp(trafficFolderPath, &network);
+        trafficOp.generateTraffic();
+        for (auto& ti : network.m_terminalInterfaces)
+            EXPECT_TRUE(ti->m_outputTrafficInfoBuffer.empty());
+
+        for (Clock clk; clk.get() < g_totalCycles; clk.tick())
+            network.runOneCycle();
+        trafficOp.analyzeTraffic();
+
+        for (auto& ti : network.m_terminalInterfaces) {
+            EXPECT_TRUE(ti->m_outputTrafficInfoBuffer.empty());
+            EXPECT_TRUE(ti->m_outputTrafficDataBuffer.empty());
+            EXPECT_EQ(ti->m_nextPacket, static_cast<size_t>(g_packetNumber));
+        }
+        EXPECT_GT(trafficOp.getPerformance().m_throughput, 0.0f);
+    }
+    g_ejectionSink = "buffer";
+}
+
+// Test that a permutation is drawn when due as well, towards its destination
+TEST(PacketSinkTest, SinkDrawsPermutationWhenDue)
+{
+    setUpParameters();
+    g_ejectionSink = "statistics";
+    g_trafficPattern = "permutation";
+    Clock::reset();
+
+    RegularNetwork network;
+    for (int i = 0; i < 4; ++i) {
+        network.connectTerminal(i);
+    }
+    network.loadNetworkData();
+
+    std::string trafficFolderPath = "/tmp/test_packet_sink/permutation/";
+    std::filesystem::create_directories(trafficFolderPath);
+    {
+        TrafficOperator trafficOp(trafficFolderPath, &network);
+        trafficOp.generateTraffic(-1);
+        for (auto& ti : network.m_terminalInterfaces)
+            EXPECT_TRUE(ti->m_outputTrafficInfoBuffer.empty());
+        EXPECT_EQ(network.m_terminalInterfaces.at(1)->drawPacket(0, 4).m_destination, -1);
+
+        for (Clock clk; clk.get() < g_totalCycles; clk.tick())
+            network.runOneCycle();
+        trafficOp.analyzeTraffic();
+
+        for (auto& ti : network.m_terminalInterfaces)
+            EXPECT_EQ(ti->m_nextPacket, ti->m_terminalInterfaceID == -1
+                ? 0u : static_cast<size_t>(g_packetNumber));
+        EXPECT_GT(trafficOp.getPerformance().m_throughput, 0.0f);
+    }
+    g_ejectionSink = "buffer";
+    g_trafficPattern = "random uniform";
+}
@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include "Profiler.h"
+#include <sstream>
+#include <thread>
+
+// Test that a profile scope adds its time to its own phase only
+TEST(ProfilerTest, ScopeAccumulates)
+{
+    Profiler::reset();
+    {
+        ProfileScope scope(ProfilePhase::COMPUTE_ROUTE);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_GT(Profiler::getSeconds(ProfilePhase::COMPUTE_ROUTE), 0.01);
+    EXPECT_LT(Profiler::getSeconds(ProfilePhase::COMPUTE_ROUTE), 1.0);
+    EXPECT_EQ(Profiler::getSeconds(ProfilePhase::ALLOCATE_SWITCH), 0.0);
+
+    Profiler::reset();
+    EXPECT_EQ(Profiler::getSeconds(ProfilePhase::COMPUTE_ROUTE), 0.0);
+}
+
+// Test that the report lists every phase and the simulation speed
+TEST(ProfilerTest, Report)
+{
+    Profiler::reset();
+    {
+        ProfileScope scope(ProfilePhase::LINK_TRAVERSAL);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    std::ostringstream report;
+    Profiler::report(report, 1000);
+    for (std::string phase : { "link traversal", "receive flit",
+        "receive credit", "compute route", "allocate virtual channel",
+        "traverse switch", "allocate switch", "terminal inject", "terminal eject" })
+        EXPECT_NE(report.str().find(phase), std::string::npos) << phase;
+    EXPECT_NE(report.str().find("100.0%"), std::string::npos);
+    EXPECT_NE(report.str().find("Simulated cycles per second: "), std::string::npos);
+}
@@ -19,12 +19,14 @@ TEST(RegisterTest, FlitOperations)
     EXPECT_TRUE(reg.isFlitRegisterEmpty());
     
     // Push a flit
-    Flit flit1(1, {1, 2, 3});
+    static const int route1[] = {1, 2, 3};
+    Flit flit1(1, route1);
     reg.pushbackFlit(flit1);
     EXPECT_FALSE(reg.isFlitRegisterEmpty());
     
     // Push another flit
-    Flit flit2(2, {4, 5, 6});
+    static const int route2[] = {4, 5, 6};
+    Flit flit2(2, route2);
     reg.pushbackFlit(flit2);
     
     // Pop first flit
@@ -91,8 +93,9 @@ TEST(RegisterTest, MultipleOperations)
     Register reg;
     
     // Add multiple flits
+    static const int routes[5][3] = {{0, 1, 2}, {1, 2, 3}, {2, 3, 4}, {3, 4, 5}, {4, 5, 6}};
     for (int i = 0; i < 5; ++i) {
-        Flit flit(i, {i, i + 1, i + 2});
+        Flit flit(i, routes[i]);
         reg.pushbackFlit(flit);
     }
     
@@ -129,7 +132,8 @@ TEST(RegisterTest, EmptyStateAfterOperations)
     Register reg;
     
     // Add and remove flit
-    Flit flit(1, {1, 2});
+    static const int route[] = {1, 2};
+    Flit flit(1, route);
     reg.pushbackFlit(flit);
     reg.popfrontFlit();
     EXPECT_TRUE(reg.isFlitRegisterEmpty());
@@ -147,7 +151,8 @@ TEST(RegisterTest, DifferentFlitTypes)
     Register reg;
     
     // Head flit
-    Flit headFlit(1, {1, 2, 3});
+    static const int route[] = {1, 2, 3};
+    Flit headFlit(1, route);
     reg.pushbackFlit(headFlit);
     
     // Body flit
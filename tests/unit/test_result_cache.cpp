@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include "ResultCache.h"
+#include <filesystem>
+
+static SimulationConfiguration makeConfiguration()
+{
+    SimulationConfiguration configuration;
+    configuration.m_x = 4;
+    configuration.m_y = 4;
+    configuration.m_z = 1;
+    configuration.m_shape = "MESH";
+    configuration.m_routingAlgorithm = "DOR";
+    configuration.m_virtualChannelNumber = 2;
+    configuration.m_bufferSize = 8;
+    configuration.m_flitSize = 1;
+    configuration.m_packetSize = 4;
+    configuration.m_packetSizeOption = "fixed";
+    configuration.m_injectionRate = 0.05f;
+    configuration.m_injectionProcess = "periodic";
+    configuration.m_trafficPattern = "random uniform";
+    configuration.m_totalCycles = 1000;
+    configuration.m_warmupCycles = 200;
+    configuration.m_measurementCycles = 500;
+    configuration.m_ejectionSink = "statistics";
+    configuration.m_traceBufferSize = 1 << 16;
+    configuration.m_traceBufferNumber = 2;
+    configuration.m_traceBackpressure = "block";
+    configuration.m_traceFormat = "csv";
+    configuration.m_statisticsWindow = 1000;
+    return configuration;
+}
+
+static std::string makeCacheDirectory(const std::string& name)
+{
+    std::string directory = "/tmp/test_result_cache/" + name;
+    std::filesystem::remove_all(directory);
+    return directory;
+}
+
+// Test that the key follows the result-relevant settings only
+TEST(ResultCacheTest, KeyFollowsConfiguration)
+{
+    ResultCache cache(makeCacheDirectory("key"));
+    SimulationConfiguration configuration = makeConfiguration();
+    std::string key = cache.getKey(configuration);
+    EXPECT_EQ(key.size(), 16u);
+    EXPECT_EQ(cache.getKey(makeConfiguration()), key);
+
+    SimulationConfiguration outputOnly = makeConfiguration();
+    outputOnly.m_traceBufferSize = 1 << 20;
+    outputOnly.m_numpyExport = true;
+    EXPECT_EQ(cache.getKey(outputOnly), key);
+
+    SimulationConfiguration otherRate = makeConfiguration();
+    otherRate.m_injectionRate = 0.050001f;
+    EXPECT_NE(cache.getKey(otherRate), key);
+    SimulationConfiguration otherVCs = makeConfiguration();
+    otherVCs.m_virtualChannelNumber = 4;
+    EXPECT_NE(cache.getKey(otherVCs), key);
+}
+
+// Test that a stored result loads back exactly
+TEST(ResultCacheTest, StoreAndLoad)
+{
+    ResultCache cache(makeCacheDirectory("store"));
+    SimulationConfiguration configuration = makeConfiguration();
+    Performance performance;
+    EXPECT_FALSE(cache.load(configuration, performance));
+
+    cache.store(configuration, { 0.123456789f, 0.2f, 51.75f });
+    ASSERT_TRUE(cache.load(configuration, performance));
+    EXPECT_EQ(performance.m_throughput, 0.123456789f);
+    EXPECT_EQ(performance.m_demand, 0.2f);
+    EXPECT_EQ(performance.m_latency, 51.75f);
+}
+
+// Test that a file whose key text does not match is not used
+TEST(ResultCacheTest, RejectMismatchedFile)
+{
+    ResultCache cache(makeCacheDirectory("mismatch"));
+    SimulationConfiguration configuration = makeConfiguration();
+    std::ofstream(cache.getFilePath(configuration))
+        << "model_version = 1\n[result]\nthroughput = 1\ndemand = 1\nlatency = 1\n";
+    Performance performance;
+    EXPECT_FALSE(cache.load(configuration, performance));
+}
+
+// Test that a simulation with a cache simulates once and then reuses the result
+TEST(ResultCacheTest, SimulationUsesCache)
+{
+    std::string outputDirectory = "/tmp/test_result_cache/output/";
+    std::filesystem::create_directories(outputDirectory);
+    ResultCache cache(makeCacheDirectory("simulation"));
+    SimulationConfiguration configuration = makeConfiguration();
+
+    Simulation first(configuration, outputDirectory);
+    first.setResultCache(&cache);
+    Performance simulated = first.run(true, true, false);
+    Performance stored;
+    ASSERT_TRUE(cache.load(configuration, stored));
+    EXPECT_EQ(stored.m_throughput, simulated.m_throughput);
+    EXPECT_EQ(stored.m_latency, simulated.m_latency);
+
+    // a doctored entry proves the second run did not simulate
+    cache.store(configuration, { 9.0f, 9.0f, 9.0f });
+    Simulation second(configuration, outputDirectory);
+    second.setResultCache(&cache);
+    EXPECT_EQ(second.run(true, true, false).m_throughput, 9.0f);
+}
+
+// Test that runs with random injection and packet sizes repeat exactly, so
+// their cached result is the one they give
+TEST(ResultCacheTest, RandomRunsAreReproducible)
+{
+    std::string outputDirectory = "/tmp/test_result_cache/random/";
+    std::filesystem::create_directories(outputDirectory);
+    ASSERT_TRUE(ResultCache::isReproducible());
+    SimulationConfiguration configuration = makeConfiguration();
+    configuration.m_packetSizeOption = "random uniform";
+    for (std::string injectionProcess : { "bernoulli", "markov modulated process" }) {
+        configuration.m_injectionProcess = injectionProcess;
+        configuration.m_alpha = 0.5f;
+        configuration.m_beta = 0.5f;
+        for (std::string sink : { "statistics", "buffer" }) {
+            configuration.m_ejectionSink = sink;
+            Performance first = Simulation(configuration, outputDirectory).run(true, true, false);
+            Performance second = Simulation(configuration, outputDirectory).run(true, true, false);
+            EXPECT_GT(first.m_throughput, 0.0f) << injectionProcess << ' ' << sink;
+            EXPECT_EQ(first.m_throughput, second.m_throughput) << injectionProcess << ' ' << sink;
+            EXPECT_EQ(first.m_latency, second.m_latency) << injectionProcess << ' ' << sink;
+        }
+    }
+}
+
+// Test that the model version pins the results; a change that alters them
+// must bump SOXIM_MODEL_VERSION and the values below together, or stale
+// cached results would be served
+TEST(ResultCacheTest, ModelVersionPinsResults)
+{
+    std::string outputDirectory = "/tmp/test_result_cache/pinned/";
+    std::filesystem::create_directories(outputDirectory);
+    SimulationConfiguration configuration = makeConfiguration();
+    configuration.m_injectionProcess = "bernoulli";
+    configuration.m_injectionRate = 0.2f;
+    Performance performance = Simulation(configuration, outputDirectory).run(true, true, false);
+    EXPECT_EQ(SOXIM_MODEL_VERSION, 2);
+    EXPECT_EQ(performance.m_throughput, 0.304f);
+    EXPECT_EQ(performance.m_latency, 166.502747f);
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "Simulation.h"
+#include "Sweep.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+static SimulationConfiguration makeConfiguration(const std::string& routingAlgorithm)
+{
+    SimulationConfiguration configuration;
+    configuration.m_x = 4;
+    configuration.m_y = 4;
+    configuration.m_z = 1;
+    configuration.m_shape = "MESH";
+    configuration.m_routingAlgorithm = routingAlgorithm;
+    configuration.m_virtualChannelNumber = 2;
+    configuration.m_bufferSize = 8;
+    configuration.m_flitSize = 1;
+    configuration.m_packetSize = 4;
+    configuration.m_packetSizeOption = "fixed";
+    configuration.m_injectionRate = 0.05f;
+    configuration.m_injectionProcess = "periodic";
+    configuration.m_trafficPattern = "random uniform";
+    configuration.m_totalCycles = 1000;
+    configuration.m_warmupCycles = 200;
+    configuration.m_measurementCycles = 500;
+    configuration.m_ejectionSink = "statistics";
+    configuration.m_traceBufferSize = 1 << 16;
+    configuration.m_traceBufferNumber = 2;
+    configuration.m_traceBackpressure = "block";
+    configuration.m_traceFormat = "csv";
+    configuration.m_statisticsWindow = 1000;
+    return configuration;
+}
+
+static std::string makeDirectory(const std::string& name)
+{
+    std::string directory = "/tmp/test_route_table/" + name + "/";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+// Test that every route reads back from the file as generated
+TEST(RouteTableTest, WriteAndMap)
+{
+    std::string directory = makeDirectory("map");
+    SimulationConfiguration configuration = makeConfiguration("MAD");
+    RoutingTables routingTables =
+        Simulation(configuration, directory).generateRoutingTables();
+    ASSERT_TRUE(RouteTable::write(directory + "mad.routes", "key", routingTables));
+
+    RouteTable routeTable(directory + "mad.routes", "key");
+    ASSERT_TRUE(routeTable.isOpen());
+    ASSERT_EQ(routeTable.getTerminalNumber(), 16);
+    for (int source = 0; source < 16; ++source) {
+        EXPECT_TRUE(routeTable.getRoute(source, source).empty());
+        for (auto& route : routingTables[source])
+            EXPECT_TRUE(std::ranges::equal(routeTable.getRoute(source, -route.back() - 1), route));
+    }
+    EXPECT_TRUE(routeTable.getRoute(0, 16).empty());
+}
+
+// Test that a file of another network or a damaged file is not used
+TEST(RouteTableTest, RejectMismatchedFile)
+{
+    std::string directory = makeDirectory("mismatch");
+    RoutingTables routingTables =
+        Simulation(makeConfiguration("DOR"), directory).generateRoutingTables();
+    ASSERT_TRUE(RouteTable::write(directory + "dor.routes", "key", routingTables));
+    EXPECT_FALSE(RouteTable(directory + "dor.routes", "other key").isOpen());
+    EXPECT_FALSE(RouteTable(directory + "missing.routes", "key").isOpen());
+
+    std::filesystem::resize_file(directory + "dor.routes", 200);
+    EXPECT_FALSE(RouteTable(directory + "dor.routes", "key").isOpen());
+}
+
+// overwrite a word of a route table file in place
+static void patchFile(const std::string& filePath, const long offset, const void* value,
+    const size_t size)
+{
+    std::fstream file(filePath, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(offset);
+    file.write(static_cast<const char*>(value), size);
+}
+
+// Test that offsets pointing outside the hops or running backwards are not used
+TEST(RouteTableTest, RejectDamagedOffsets)
+{
+    std::string directory = makeDirectory("damaged");
+    RoutingTables routingTables =
+        Simulation(makeConfiguration("DOR"), directory).generateRoutingTables();
+    // key "key": the 16 source starts follow at 24, the route ends at 160
+    const long sourceStarts = 24, routeEnds = 24 + 17 * 8;
+    const unsigned long long hugeStart = 1ULL << 40;
+    const unsigned int hugeEnd = 0xffffffffu, zeroEnd = 0;
+
+    ASSERT_TRUE(RouteTable::write(directory + "start.routes", "key", routingTables));
+    ASSERT_TRUE(RouteTable(directory + "start.routes", "key").isOpen());
+    patchFile(directory + "start.routes", sourceStarts + 3 * 8, &hugeStart, 8);
+    EXPECT_FALSE(RouteTable(directory + "start.routes", "key").isOpen());
+
+    ASSERT_TRUE(RouteTable::write(directory + "end.routes", "key", routingTables));
+    patchFile(directory + "end.routes", routeEnds + 5 * 4, &hugeEnd, 4);
+    EXPECT_FALSE(RouteTable(directory + "end.routes", "key").isOpen());
+
+    ASSERT_TRUE(RouteTable::write(directory + "order.routes", "key", routingTables));
+    patchFile(directory + "order.routes", routeEnds + 15 * 4, &zeroEnd, 4);
+    EXPECT_FALSE(RouteTable(directory + "order.routes", "key").isOpen());
+}
+
+// Test that runs with a route cache create the file once and match a run
+// generating its routes
+TEST(RouteTableTest, SimulationUsesRouteCache)
+{
+    std::string directory = makeDirectory("simulation");
+    SimulationConfiguration configuration = makeConfiguration("ODD_EVEN");
+    Performance generated = Simulation(configuration, directory).run(true, true, false);
+
+    configuration.m_routeCacheDirectory = directory + "routes";
+    Performance first = Simulation(configuration, directory).run(true, true, false);
+    std::string filePath = directory + "routes/MESH_4x4x1_ODD_EVEN_42.routes";
+    ASSERT_TRUE(std::filesystem::exists(filePath));
+    auto writeTime = std::filesystem::last_write_time(filePath);
+    Performance second = Simulation(configuration, directory).run(true, true, false);
+    EXPECT_EQ(std::filesystem::last_write_time(filePath), writeTime);
+
+    EXPECT_EQ(first.m_throughput, generated.m_throughput);
+    EXPECT_EQ(first.m_latency, generated.m_latency);
+    EXPECT_EQ(second.m_latency, generated.m_latency);
+}
+
+// Test that sweep points share one mapped route table per algorithm
+TEST(RouteTableTest, SweepUsesRouteCache)
+{
+    std::string directory = makeDirectory("sweep");
+    SimulationConfiguration configuration = makeConfiguration("DOR");
+    configuration.m_routeCacheDirectory = directory + "routes";
+    SweepGrid grid;
+    grid.m_injectionRates = { 0.02f, 0.05f };
+    grid.m_routingAlgorithms = { "DOR", "MAD" };
+    Sweep sweep(configuration, grid, directory);
+    sweep.run(2);
+
+    EXPECT_TRUE(std::filesystem::exists(directory + "routes/MESH_4x4x1_DOR_42.routes"));
+    EXPECT_TRUE(std::filesystem::exists(directory + "routes/MESH_4x4x1_MAD_42.routes"));
+    for (auto& point : sweep.getPoints()) {
+        SimulationConfiguration single = point.m_configuration;
+        single.m_routeCacheDirectory = "";
+        Performance performance = Simulation(single, directory).run(true, true, false);
+        EXPECT_EQ(point.m_performance.m_throughput, performance.m_throughput);
+        EXPECT_EQ(point.m_performance.m_latency, performance.m_latency);
+    }
+}
@@ -2,6 +2,14 @@
 #include "Router.h"
 #include "DataStructures.h"
 #include "Port.h"
+#include <span>
+
+// a head points into its route; keep the routes alive as a network does
+static std::span<const int> makeRoute(std::initializer_list<int> hops)
+{
+    static std::deque<std::vector<int>> routes;
+    return routes.emplace_back(hops);
+}
 
 // Test Router construction
 TEST(RouterTest, DefaultConstruction)
@@ -111,7 +119,7 @@ TEST(RouterTest, RunOneCycleWithFlit)
     router.initiatePriorities();
     
     // Add a flit to an input register
-    std::deque<int> route = {1, 2, 3};
+    std::span<const int> route = makeRoute({1, 2, 3});
     Flit flit(0, route);
     router.m_ports[0]->m_inputRegister.pushbackFlit(flit);
     
@@ -156,7 +164,7 @@ TEST(RouterTest, MultipleFlits)
     
     // Add multiple flits to different ports
     for (int i = 0; i < 3; ++i) {
-        std::deque<int> route = {i + 1, i + 2};
+        std::span<const int> route = makeRoute({i + 1, i + 2});
         Flit flit(i, route);
         router.m_ports[i]->m_inputRegister.pushbackFlit(flit);
     }
@@ -207,7 +215,7 @@ TEST(RouterTest, WithFlitsAndCredits)
     
     // Add flits to input registers
     for (int i = 0; i < 3; ++i) {
-        std::deque<int> route = {i + 1, i + 2};
+        std::span<const int> route = makeRoute({i + 1, i + 2});
         Flit flit(i, route);
         router.m_ports[i]->m_inputRegister.pushbackFlit(flit);
     }
@@ -245,7 +253,7 @@ TEST(RouterTest, WithVirtualChannels)
     // Add flits with different virtual channels
     for (int vc = 0; vc < 4; ++vc) {
         for (int i = 0; i < 2; ++i) {
-            std::deque<int> route = {1, 2, 3};
+            std::span<const int> route = makeRoute({1, 2, 3});
             Flit flit(i, route);
             flit.m_flitVirtualChannel = vc;
             router.m_ports[0]->m_inputRegister.pushbackFlit(flit);
@@ -273,7 +281,7 @@ TEST(RouterTest, WithDifferentFlitTypes)
     router.initiatePriorities();
     
     // Add head flit
-    std::deque<int> route = {1, 2, 3};
+    std::span<const int> route = makeRoute({1, 2, 3});
     Flit headFlit(0, route);
     router.m_ports[0]->m_inputRegister.pushbackFlit(headFlit);
     
@@ -318,7 +326,7 @@ TEST(RouterTest, PipelineStages)
     // 6. Traverse Switch - move flit through crossbar
     
     // Add test flits
-    std::deque<int> route = {1, 2, 3};
+    std::span<const int> route = makeRoute({1, 2, 3});
     Flit flit(0, route);
     router.m_ports[0]->m_inputRegister.pushbackFlit(flit);
     
@@ -364,7 +372,7 @@ TEST(RouterTest, HighLoad)
     
     // Add many flits to create high load
     for (int i = 0; i < 50; ++i) {
-        std::deque<int> route = {1, 2, 3};
+        std::span<const int> route = makeRoute({1, 2, 3});
         Flit flit(i, route);
         router.m_ports[0]->m_inputRegister.pushbackFlit(flit);
     }
@@ -395,7 +403,7 @@ TEST(RouterTest, DifferentBufferSizes)
     
     // Add flits
     for (int i = 0; i < 10; ++i) {
-        std::deque<int> route = {1, 2, 3};
+        std::span<const int> route = makeRoute({1, 2, 3});
         Flit flit(i, route);
         router.m_ports[0]->m_inputRegister.pushbackFlit(flit);
     }
@@ -427,7 +435,7 @@ TEST(RouterTest, DifferentVCCounts)
     // Add flits with different VCs
     for (int vc = 0; vc < 8; ++vc) {
         for (int i = 0; i < 2; ++i) {
-            std::deque<int> route = {1, 2, 3};
+            std::span<const int> route = makeRoute({1, 2, 3});
             Flit flit(i, route);
             flit.m_flitVirtualChannel = vc;
             router.m_ports[0]->m_inputRegister.pushbackFlit(flit);
@@ -458,7 +466,7 @@ TEST(RouterTest, SelfRouting)
     router.initiatePriorities();
     
     // Add flit with route that goes back to same router
-    std::deque<int> route = {0, 1, 2};
+    std::span<const int> route = makeRoute({0, 1, 2});
     Flit flit(0, route);
     router.m_ports[0]->m_inputRegister.pushbackFlit(flit);
     
@@ -483,7 +491,7 @@ TEST(RouterTest, LongRoute)
     router.initiatePriorities();
     
     // Add flit with long route
-    std::deque<int> route = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    std::span<const int> route = makeRoute({1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
     Flit flit(0, route);
     router.m_ports[0]->m_inputRegister.pushbackFlit(flit);
     
@@ -510,7 +518,7 @@ TEST(RouterTest, MultipleInputPortsActive)
     // Add flits to multiple input ports
     for (int port = 0; port < 3; ++port) {
         for (int i = 0; i < 5; ++i) {
-            std::deque<int> route = {port + 1, port + 2};
+            std::span<const int> route = makeRoute({port + 1, port + 2});
             Flit flit(i, route);
             router.m_ports[port]->m_inputRegister.pushbackFlit(flit);
         }
@@ -538,7 +546,7 @@ TEST(RouterTest, WithContention)
     
     // Add flits that will contend for the same output port
     for (int i = 0; i < 10; ++i) {
-        std::deque<int> route = {1, 2, 3};  // All want to go to port 1
+        std::span<const int> route = makeRoute({1, 2, 3});  // All want to go to port 1
         Flit flit(i, route);
         router.m_ports[i % 4]->m_inputRegister.pushbackFlit(flit);
     }
@@ -565,7 +573,7 @@ TEST(RouterTest, CreditBasedFlowControl)
     
     // Add flits
     for (int i = 0; i < 10; ++i) {
-        std::deque<int> route = {1, 2, 3};
+        std::span<const int> route = makeRoute({1, 2, 3});
         Flit flit(i, route);
         router.m_ports[0]->m_inputRegister.pushbackFlit(flit);
     }
@@ -598,7 +606,7 @@ TEST(RouterTest, DifferentPacketSizes)
     
     // Test with small packets (2 flits)
     for (int i = 0; i < 5; ++i) {
-        std::deque<int> route = {1, 2};
+        std::span<const int> route = makeRoute({1, 2});
         Flit headFlit(i, route);
         router.m_ports[0]->m_inputRegister.pushbackFlit(headFlit);
         
@@ -630,14 +638,14 @@ TEST(RouterTest, MixedTraffic)
     // Add different types of traffic
     // 1. Single flit packets
     for (int i = 0; i < 3; ++i) {
-        std::deque<int> route = {1};
+        std::span<const int> route = makeRoute({1});
         Flit flit(i, route);
         router.m_ports[0]->m_inputRegister.pushbackFlit(flit);
     }
     
     // 2. Multi-flit packets
     for (int i = 0; i < 3; ++i) {
-        std::deque<int> route = {2, 3, 4};
+        std::span<const int> route = makeRoute({2, 3, 4});
         Flit headFlit(i, route);
         router.m_ports[1]->m_inputRegister.pushbackFlit(headFlit);
         
@@ -673,7 +681,7 @@ TEST(RouterTest, RandomFlitInjection)
         // Randomly add flits
         if (cycle % 3 == 0) {
             int port = cycle % 4;
-            std::deque<int> route = {1, 2, 3};
+            std::span<const int> route = makeRoute({1, 2, 3});
             Flit flit(cycle, route);
             router.m_ports[port]->m_inputRegister.pushbackFlit(flit);
         }
@@ -698,7 +706,7 @@ TEST(RouterTest, Backpressure)
     
     // Add many flits to create backpressure
     for (int i = 0; i < 100; ++i) {
-        std::deque<int> route = {1, 2, 3};
+        std::span<const int> route = makeRoute({1, 2, 3});
         Flit flit(i, route);
         router.m_ports[0]->m_inputRegister.pushbackFlit(flit);
     }
@@ -730,7 +738,7 @@ TEST(RouterTest, DifferentNetworkSizes)
     
     // Add flits
     for (int i = 0; i < 10; ++i) {
-        std::deque<int> route = {1, 2};
+        std::span<const int> route = makeRoute({1, 2});
         Flit flit(i, route);
         router.m_ports[0]->m_inputRegister.pushbackFlit(flit);
     }
@@ -762,7 +770,7 @@ TEST(RouterTest, ThreeDNetwork)
     
     // Add flits
     for (int i = 0; i < 10; ++i) {
-        std::deque<int> route = {1, 2, 3};
+        std::span<const int> route = makeRoute({1, 2, 3});
         Flit flit(i, route);
         router.m_ports[0]->m_inputRegister.pushbackFlit(flit);
     }
@@ -774,3 +782,46 @@ TEST(RouterTest, ThreeDNetwork)
     
     SUCCEED();
 }
+
+// Test that route computation finds every routing VC past the first 64
+// packed states and skips the disabled one
+TEST(RouterTest, PackedStatesAcrossWords)
+{
+    g_x = 2;
+    g_y = 2;
+    g_z = 2;
+    g_shape = "MESH";
+    g_routingAlgorithm = "DOR";
+    g_routingMode = "source";
+    g_virtualChannelNumber = 16;
+    g_bufferSize = 8;
+
+    Router router(0);
+    for (int i = 0; i < 7; ++i)
+        router.createPort(i);
+    for (auto& port : router.m_ports) {
+        for (int vc = 0; vc < g_virtualChannelNumber; ++vc) {
+            port->m_virtualChannels[vc].push_back(Flit(-1, makeRoute({ (port->m_portID + vc) % 7, -1 })));
+            port->m_controlFields[vc].m_virtualChannelState = VirtualChannelState::R;
+        }
+    }
+    router.m_ports[5]->m_controlFields[3].m_enable = false;
+    router.initiatePriorities(); // packs the VC states
+    router.runOneCycle();
+
+    // routing disables a VC, so none of them reaches VA in the same cycle;
+    // they are enabled again at the end of it
+    for (auto& port : router.m_ports) {
+        for (int vc = 0; vc < g_virtualChannelNumber; ++vc) {
+            const ControlField& field = port->m_controlFields[vc];
+            if (port->m_portID == 5 && vc == 3) {
+                EXPECT_EQ(field.m_virtualChannelState, VirtualChannelState::R);
+                EXPECT_FALSE(field.m_enable);
+                continue;
+            }
+            EXPECT_EQ(field.m_virtualChannelState, VirtualChannelState::V);
+            EXPECT_TRUE(field.m_enable);
+            EXPECT_EQ(field.m_routedOutputPort, (port->m_portID + vc) % 7);
+        }
+    }
+}
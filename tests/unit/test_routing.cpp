@@ -31,8 +31,7 @@ TEST(RoutingTest, Mesh2DRouting)
 
     // Create terminal interfaces
     for (int i = 0; i < 4; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -71,8 +70,7 @@ TEST(RoutingTest, Torus2DRouting)
 
     // Create terminal interfaces
     for (int i = 0; i < 4; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -111,8 +109,7 @@ TEST(RoutingTest, Mesh3DRouting)
 
     // Create terminal interfaces
     for (int i = 0; i < 2; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -185,8 +182,7 @@ TEST(RoutingTest, SelfRouting)
     
     // Create terminal interfaces
     for (int i = 0; i < 4; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
@@ -195,7 +191,7 @@ TEST(RoutingTest, SelfRouting)
     TerminalInterface* source = network.m_terminalInterfaces[0];
     
     // Find the route to itself
-    std::deque<int> route;
+    std::vector<int> route;
     for (const auto& entry : source->m_sourceRoutingTable) {
         if (entry.back() == source->m_terminalInterfaceID) {
             route = entry;
@@ -2,6 +2,7 @@
 #include "RegularNetwork.h"
 #include "TerminalInterface.h"
 #include "DataStructures.h"
+#include <set>
 
 // Test ROMM routing algorithm
 TEST(RoutingAlgorithmsTest, ROMM)
@@ -32,18 +33,17 @@ TEST(RoutingAlgorithmsTest, ROMM)
     
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
     
-    // Verify routes were generated
     EXPECT_FALSE(network.m_terminalInterfaces.empty());
     
-    // Check that routes exist for all source-destination pairs
+    // Routes are chosen per packet, so no tables are kept
     for (auto& ti : network.m_terminalInterfaces) {
-        EXPECT_FALSE(ti->m_sourceRoutingTable.empty());
+        EXPECT_TRUE(ti->m_sourceRoutingTable.empty());
+        EXPECT_TRUE(ti->m_routingFunction.isDistributed());
     }
     
     SUCCEED();
@@ -78,8 +78,7 @@ TEST(RoutingAlgorithmsTest, MAD)
     
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
@@ -124,18 +123,17 @@ TEST(RoutingAlgorithmsTest, VAL)
     
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
     
-    // Verify routes were generated
     EXPECT_FALSE(network.m_terminalInterfaces.empty());
     
-    // Check that routes exist for all source-destination pairs
+    // Routes are chosen per packet, so no tables are kept
     for (auto& ti : network.m_terminalInterfaces) {
-        EXPECT_FALSE(ti->m_sourceRoutingTable.empty());
+        EXPECT_TRUE(ti->m_sourceRoutingTable.empty());
+        EXPECT_TRUE(ti->m_routingFunction.isDistributed());
     }
     
     SUCCEED();
@@ -170,8 +168,7 @@ TEST(RoutingAlgorithmsTest, OddEven)
     
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
@@ -216,18 +213,17 @@ TEST(RoutingAlgorithmsTest, ROMMTorus)
     
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
     
-    // Verify routes were generated
     EXPECT_FALSE(network.m_terminalInterfaces.empty());
     
-    // Check that routes exist for all source-destination pairs
+    // Routes are chosen per packet, so no tables are kept
     for (auto& ti : network.m_terminalInterfaces) {
-        EXPECT_FALSE(ti->m_sourceRoutingTable.empty());
+        EXPECT_TRUE(ti->m_sourceRoutingTable.empty());
+        EXPECT_TRUE(ti->m_routingFunction.isDistributed());
     }
     
     SUCCEED();
@@ -262,8 +258,7 @@ TEST(RoutingAlgorithmsTest, MAD3D)
     
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 8; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
@@ -308,18 +303,17 @@ TEST(RoutingAlgorithmsTest, VALSmall)
     
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 4; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
     
-    // Verify routes were generated
     EXPECT_FALSE(network.m_terminalInterfaces.empty());
     
-    // Check that routes exist for all source-destination pairs
+    // Routes are chosen per packet, so no tables are kept
     for (auto& ti : network.m_terminalInterfaces) {
-        EXPECT_FALSE(ti->m_sourceRoutingTable.empty());
+        EXPECT_TRUE(ti->m_sourceRoutingTable.empty());
+        EXPECT_TRUE(ti->m_routingFunction.isDistributed());
     }
     
     SUCCEED();
@@ -354,8 +348,7 @@ TEST(RoutingAlgorithmsTest, OddEven2x2)
     
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 4; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
@@ -404,8 +397,7 @@ TEST(RoutingAlgorithmsTest, AllAlgorithms)
         
         // Create terminal interfaces (one per router)
         for (int i = 0; i < 16; ++i) {
-            TerminalInterface* ti = new TerminalInterface(-i - 1);
-            network.connectTerminal(i, ti);
+            network.connectTerminal(i);
         }
         
         network.loadNetworkData();
@@ -413,9 +405,11 @@ TEST(RoutingAlgorithmsTest, AllAlgorithms)
         // Verify routes were generated
         EXPECT_FALSE(network.m_terminalInterfaces.empty());
         
-        // Check that routes exist for all source-destination pairs
+        // Check that routes exist for all source-destination pairs;
+        // VAL and ROMM choose them per packet instead
+        bool perPacket = std::string(algorithm) == "VAL" || std::string(algorithm) == "ROMM";
         for (auto& ti : network.m_terminalInterfaces) {
-            EXPECT_FALSE(ti->m_sourceRoutingTable.empty());
+            EXPECT_EQ(ti->m_sourceRoutingTable.empty(), perPacket);
         }
     }
     
@@ -455,8 +449,7 @@ TEST(RoutingAlgorithmsTest, RouteLength)
         
         // Create terminal interfaces (one per router)
         for (int i = 0; i < 16; ++i) {
-            TerminalInterface* ti = new TerminalInterface(-i - 1);
-            network.connectTerminal(i, ti);
+            network.connectTerminal(i);
         }
         
         network.loadNetworkData();
@@ -504,8 +497,7 @@ TEST(RoutingAlgorithmsTest, ROMMRandomness)
     
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network1.connectTerminal(i, ti);
+        network1.connectTerminal(i);
     }
     
     network1.loadNetworkData();
@@ -514,26 +506,25 @@ TEST(RoutingAlgorithmsTest, ROMMRandomness)
     RegularNetwork network2;
     
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network2.connectTerminal(i, ti);
+        network2.connectTerminal(i);
     }
     
     network2.loadNetworkData();
     
-    // Routes should be different due to randomness
-    // (unless we're using REPRODUCE_RANDOM mode)
-    bool routesDifferent = false;
-    for (int i = 0; i < 16; ++i) {
-        if (network1.m_terminalInterfaces[i]->m_sourceRoutingTable !=
-            network2.m_terminalInterfaces[i]->m_sourceRoutingTable) {
-            routesDifferent = true;
-            break;
-        }
+    // Packets of one pair take different intermediates, all inside the
+    // minimal quadrant between router 0 (0, 0) and router 10 (2, 2)
+    std::set<int> intermediates;
+    std::mt19937 generator(1);
+    for (int packet = 0; packet < 100; ++packet) {
+        Flit head(-1, {});
+        head.m_destination = -11;
+        network1.m_terminalInterfaces[0]->m_routingFunction.preparePacket(head, generator);
+        EXPECT_LE(head.m_intermediate % 4, 2);
+        EXPECT_LE(head.m_intermediate / 4, 2);
+        intermediates.insert(head.m_intermediate);
     }
+    EXPECT_EQ(intermediates.size(), 9u);
     
-    // In non-reproducible mode, routes should be different
-    // In reproducible mode, they should be the same
-    // We'll just verify that routes exist
     EXPECT_FALSE(network1.m_terminalInterfaces.empty());
     EXPECT_FALSE(network2.m_terminalInterfaces.empty());
     
@@ -569,8 +560,7 @@ TEST(RoutingAlgorithmsTest, VALRandomness)
     
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network1.connectTerminal(i, ti);
+        network1.connectTerminal(i);
     }
     
     network1.loadNetworkData();
@@ -579,26 +569,25 @@ TEST(RoutingAlgorithmsTest, VALRandomness)
     RegularNetwork network2;
     
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network2.connectTerminal(i, ti);
+        network2.connectTerminal(i);
     }
     
     network2.loadNetworkData();
     
-    // Routes should be different due to randomness
-    // (unless we're using REPRODUCE_RANDOM mode)
-    bool routesDifferent = false;
-    for (int i = 0; i < 16; ++i) {
-        if (network1.m_terminalInterfaces[i]->m_sourceRoutingTable !=
-            network2.m_terminalInterfaces[i]->m_sourceRoutingTable) {
-            routesDifferent = true;
-            break;
-        }
+    // Packets of one pair take different intermediates, never the
+    // source or the destination
+    std::set<int> intermediates;
+    std::mt19937 generator(1);
+    for (int packet = 0; packet < 200; ++packet) {
+        Flit head(-1, {});
+        head.m_destination = -11;
+        network1.m_terminalInterfaces[0]->m_routingFunction.preparePacket(head, generator);
+        EXPECT_NE(head.m_intermediate, 0);
+        EXPECT_NE(head.m_intermediate, 10);
+        intermediates.insert(head.m_intermediate);
     }
+    EXPECT_EQ(intermediates.size(), 14u);
     
-    // In non-reproducible mode, routes should be different
-    // In reproducible mode, they should be the same
-    // We'll just verify that routes exist
     EXPECT_FALSE(network1.m_terminalInterfaces.empty());
     EXPECT_FALSE(network2.m_terminalInterfaces.empty());
     
@@ -634,8 +623,7 @@ TEST(RoutingAlgorithmsTest, OddEvenProperties)
     
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
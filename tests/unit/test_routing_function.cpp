@@ -0,0 +1,436 @@
+#include <gtest/gtest.h>
+#include "Simulation.h"
+#include "Router.h"
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+
+static SimulationConfiguration makeConfiguration(const std::string& shape,
+    const std::string& routingAlgorithm, const std::string& routingMode)
+{
+    SimulationConfiguration configuration;
+    configuration.m_x = 4;
+    configuration.m_y = 4;
+    configuration.m_z = 1;
+    configuration.m_shape = shape;
+    configuration.m_routingAlgorithm = routingAlgorithm;
+    configuration.m_routingMode = routingMode;
+    configuration.m_virtualChannelNumber = 2;
+    configuration.m_bufferSize = 8;
+    configuration.m_flitSize = 1;
+    configuration.m_packetSize = 4;
+    configuration.m_packetSizeOption = "fixed";
+    configuration.m_injectionRate = 0.05f;
+    configuration.m_injectionProcess = "periodic";
+    configuration.m_trafficPattern = "random uniform";
+    configuration.m_totalCycles = 1000;
+    configuration.m_warmupCycles = 200;
+    configuration.m_measurementCycles = 500;
+    configuration.m_ejectionSink = "statistics";
+    configuration.m_traceBufferSize = 1 << 16;
+    configuration.m_traceBufferNumber = 2;
+    configuration.m_traceBackpressure = "block";
+    configuration.m_traceFormat = "csv";
+    configuration.m_statisticsWindow = 1000;
+    return configuration;
+}
+
+static std::string makeOutputDirectory()
+{
+    std::string directory = "/tmp/test_routing_function/";
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+// follow the routing function hop by hop from a source router
+static std::vector<int> walkRoute(int source, int destination, Flit head)
+{
+    head.m_destination = destination;
+    std::vector<int> route;
+    for (int router = source; router >= 0 && route.size() < 64;) {
+        router = RoutingFunction(router).computeOutputPort(head);
+        route.push_back(router);
+    }
+    return route;
+}
+
+// Test that distributed routing takes the paths of the route tables
+TEST(RoutingFunctionTest, MatchesRouteTables)
+{
+    for (std::string shape : { "MESH", "TORUS" }) {
+        for (std::string algorithm : { "DOR", "MAD", "ODD_EVEN" }) {
+            for (int z : { 1, 2 }) {
+                SimulationConfiguration source = makeConfiguration(shape, algorithm, "source");
+                source.m_z = z;
+                RoutingTables routingTables =
+                    Simulation(source, makeOutputDirectory()).generateRoutingTables();
+
+                SimulationConfiguration distributed = source;
+                distributed.m_routingMode = "distributed";
+                distributed.apply();
+                ASSERT_TRUE(RoutingFunction(0).isDistributed());
+                for (size_t i = 0; i < routingTables.size(); ++i) {
+                    for (auto& route : routingTables[i]) {
+                        EXPECT_EQ(walkRoute(static_cast<int>(i), route.back(), Flit(-1, {})),
+                            route) << shape << " " << algorithm << " z=" << z;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Test that a distributed run keeps no tables and matches a source routed run
+TEST(RoutingFunctionTest, DistributedSimulation)
+{
+    SimulationConfiguration source = makeConfiguration("MESH", "DOR", "source");
+    Performance tables = Simulation(source, makeOutputDirectory()).run(true, true, false);
+
+    SimulationConfiguration distributed = makeConfiguration("MESH", "DOR", "distributed");
+    EXPECT_TRUE(Simulation(distributed, makeOutputDirectory()).generateRoutingTables()[0].empty());
+    Performance perHop = Simulation(distributed, makeOutputDirectory()).run(true, true, false);
+
+    EXPECT_GT(tables.m_throughput, 0.0f);
+    EXPECT_EQ(perHop.m_throughput, tables.m_throughput);
+    EXPECT_EQ(perHop.m_latency, tables.m_latency);
+}
+
+// Test that O1TURN picks both orders and keeps them on separate VCs
+TEST(RoutingFunctionTest, O1TurnOrders)
+{
+    SimulationConfiguration configuration = makeConfiguration("MESH", "O1TURN", "source");
+    configuration.apply();
+    RoutingFunction routingFunction(0);
+    ASSERT_TRUE(routingFunction.isDistributed());
+
+    std::mt19937 generator(1);
+    int yFirst = 0;
+    Flit head(-1, {});
+    for (int i = 0; i < 100; ++i) {
+        routingFunction.preparePacket(head, generator);
+        yFirst += head.m_routingPhase;
+        EXPECT_NE(routingFunction.admitsVirtualChannel(head, 0),
+            routingFunction.admitsVirtualChannel(head, 1));
+    }
+    EXPECT_GT(yFirst, 20);
+    EXPECT_LT(yFirst, 80);
+
+    // from router 0 to router 5: XY goes to 1 first, YX to 4
+    head.m_routingPhase = 0;
+    EXPECT_EQ(walkRoute(0, -6, head), std::vector<int>({ 1, 5, -6 }));
+    head.m_routingPhase = 1;
+    EXPECT_EQ(walkRoute(0, -6, head), std::vector<int>({ 4, 5, -6 }));
+
+    Performance performance = Simulation(configuration, makeOutputDirectory()).run(true, true, false);
+    EXPECT_GT(performance.m_throughput, 0.0f);
+}
+
+// Test that VAL and ROMM pass the intermediate of each packet, ROMM on a
+// minimal path
+TEST(RoutingFunctionTest, TwoPhaseRouting)
+{
+    for (std::string shape : { "MESH", "TORUS" }) {
+        for (std::string algorithm : { "VAL", "ROMM" }) {
+            SimulationConfiguration configuration = makeConfiguration(shape, algorithm, "source");
+            configuration.apply();
+            std::mt19937 generator(1);
+            for (int source = 0; source < 16; ++source) {
+                RoutingFunction routingFunction(source);
+                ASSERT_TRUE(routingFunction.isDistributed());
+                for (int destination = 0; destination < 16; ++destination) {
+                    if (destination == source)
+                        continue;
+                    Flit head(-1, {});
+                    head.m_destination = -destination - 1;
+                    routingFunction.preparePacket(head, generator);
+                    ASSERT_GE(head.m_intermediate, 0);
+                    std::vector<int> route = walkRoute(source, head.m_destination, head);
+                    ASSERT_EQ(route.back(), -destination - 1);
+                    EXPECT_TRUE(head.m_intermediate == source
+                        || std::find(route.begin(), route.end(), head.m_intermediate) != route.end());
+                    if (algorithm == "ROMM") {
+                        // as long as the DOR route
+                        Flit dorHead(-1, {});
+                        SimulationConfiguration dor = makeConfiguration(shape, "DOR", "distributed");
+                        dor.apply();
+                        EXPECT_EQ(route.size(),
+                            walkRoute(source, head.m_destination, dorHead).size());
+                        configuration.apply();
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Test that the phases of VAL use disjoint virtual channels and that a
+// VAL run without route tables delivers its packets
+TEST(RoutingFunctionTest, TwoPhaseSimulation)
+{
+    SimulationConfiguration configuration = makeConfiguration("MESH", "VAL", "source");
+    configuration.apply();
+    RoutingFunction routingFunction(0);
+    Flit head(-1, {});
+    head.m_routingPhase = 0;
+    EXPECT_TRUE(routingFunction.admitsVirtualChannel(head, 0));
+    EXPECT_FALSE(routingFunction.admitsVirtualChannel(head, 1));
+    head.m_routingPhase = 1;
+    EXPECT_TRUE(routingFunction.admitsVirtualChannel(head, 1));
+
+    // below saturation: VAL doubles the hops and has one VC per phase here
+    configuration.m_injectionRate = 0.01f;
+    EXPECT_TRUE(Simulation(configuration, makeOutputDirectory()).generateRoutingTables()[0].empty());
+    Performance performance = Simulation(configuration, makeOutputDirectory()).run(true, true, false);
+    EXPECT_GT(performance.m_throughput, 0.0f);
+    EXPECT_NEAR(performance.m_throughput, performance.m_demand, 0.005f);
+}
+
+// the admissible output ports at a router, for a head from source to
+// destination router
+static std::vector<int> getOutputPorts(int router, int source, int destination)
+{
+    Flit head(-source - 1, {});
+    head.m_destination = -destination - 1;
+    std::vector<int> outputPorts;
+    RoutingFunction(router).computeOutputPorts(head, outputPorts);
+    return outputPorts;
+}
+
+// Test the minimal output ports MAD and the odd-even turn model admit
+TEST(RoutingFunctionTest, AdaptiveOutputPorts)
+{
+    SimulationConfiguration configuration = makeConfiguration("MESH", "MAD", "source");
+    configuration.m_selectionFunction = "max_credit";
+    configuration.apply();
+    ASSERT_TRUE(RoutingFunction(0).isAdaptive());
+    EXPECT_EQ(getOutputPorts(0, 0, 5), std::vector<int>({ 1, 4 }));
+    EXPECT_EQ(getOutputPorts(6, 0, 5), std::vector<int>({ 5 }));
+    EXPECT_EQ(getOutputPorts(5, 0, 5), std::vector<int>({ -6 }));
+
+    configuration.m_routingAlgorithm = "ODD_EVEN";
+    configuration.apply();
+    ASSERT_TRUE(RoutingFunction(0).isAdaptive());
+    // east from the source column may turn
+    EXPECT_EQ(getOutputPorts(0, 0, 6), std::vector<int>({ 1, 4 }));
+    // no east-to-north turn in an even column
+    EXPECT_EQ(getOutputPorts(2, 0, 7), std::vector<int>({ 3 }));
+    // into an even column, east must not be the last x hop with y left
+    EXPECT_EQ(getOutputPorts(5, 4, 10), std::vector<int>({ 9 }));
+    // west: y only from even columns
+    EXPECT_EQ(getOutputPorts(2, 3, 4), std::vector<int>({ 1, 6 }));
+    EXPECT_EQ(getOutputPorts(1, 3, 4), std::vector<int>({ 0 }));
+
+    configuration.m_selectionFunction = "none";
+    configuration.apply();
+    EXPECT_FALSE(RoutingFunction(0).isAdaptive());
+    EXPECT_FALSE(RoutingFunction::isDistributedRouting());
+}
+
+// Test that a router sends a head to the output port with more credits
+TEST(RoutingFunctionTest, SelectionFunction)
+{
+    SimulationConfiguration configuration = makeConfiguration("MESH", "MAD", "source");
+    configuration.m_escapeVirtualChannelNumber = 0; // VC 0 routes adaptively
+    for (std::string selection : { "max_credit", "local_neighbour" }) {
+        configuration.m_selectionFunction = selection;
+        configuration.apply();
+        for (int congested : { 6, 9 }) {
+            // router 5 with its neighbours and terminal; head to router 10
+            Router router(5);
+            for (int portID : { 1, 4, 6, 9, -6 })
+                router.createPort(portID);
+            for (auto& port : router.m_ports)
+                if (port->m_portID == congested)
+                    port->m_controlFields.at(0).m_credit = 2;
+            Flit head(-1, {});
+            head.m_destination = -11;
+            router.m_ports[0]->m_virtualChannels[0].push_back(head);
+            router.m_ports[0]->m_controlFields[0].m_virtualChannelState = VirtualChannelState::R;
+            router.initiatePriorities(); // packs the VC states
+            router.runOneCycle();
+            EXPECT_EQ(router.m_ports[0]->m_controlFields[0].m_routedOutputPort,
+                congested == 6 ? 9 : 6) << selection;
+        }
+    }
+}
+
+// Test that every selection function delivers adaptive traffic
+TEST(RoutingFunctionTest, AdaptiveSimulation)
+{
+    for (std::string algorithm : { "MAD", "ODD_EVEN" }) {
+        for (std::string selection : { "max_credit", "random", "local_neighbour" }) {
+            SimulationConfiguration configuration = makeConfiguration("MESH", algorithm, "source");
+            configuration.m_selectionFunction = selection;
+            configuration.m_injectionRate = 0.02f;
+            EXPECT_TRUE(Simulation(configuration, makeOutputDirectory()).generateRoutingTables()[0].empty());
+            Performance performance = Simulation(configuration, makeOutputDirectory()).run(true, true, false);
+            EXPECT_NEAR(performance.m_throughput, performance.m_demand, 0.005f)
+                << algorithm << " " << selection;
+        }
+    }
+}
+
+// Test that torus packets switch to the upper dateline class on the
+// wrap-around link and start each dimension in the lower one
+TEST(RoutingFunctionTest, DatelineClasses)
+{
+    SimulationConfiguration configuration = makeConfiguration("TORUS", "DOR", "source");
+    configuration.apply();
+    Flit head(-1, {});
+    // router 3 to 0 and router 0 to 3 wrap around in x
+    EXPECT_EQ(RoutingFunction(3).computeDatelineClass(head, -4, 0, 0), 1);
+    EXPECT_EQ(RoutingFunction(0).computeDatelineClass(head, -1, 0, 3), 1);
+    EXPECT_EQ(RoutingFunction(0).computeDatelineClass(head, -1, 0, 1), 0);
+    // router 0 entered from router 3: the class stays in x, resets in y
+    EXPECT_EQ(RoutingFunction(0).computeDatelineClass(head, 3, 1, 1), 1);
+    EXPECT_EQ(RoutingFunction(0).computeDatelineClass(head, 3, 0, 1), 0);
+    EXPECT_EQ(RoutingFunction(0).computeDatelineClass(head, 3, 1, 4), 0);
+    EXPECT_EQ(RoutingFunction(0).computeDatelineClass(head, 3, 1, 12), 1);
+    EXPECT_EQ(RoutingFunction(0).computeDatelineClass(head, 3, 1, -1), -1);
+    EXPECT_FALSE(RoutingFunction(0).admitsVirtualChannel(head, 0, 1));
+    EXPECT_TRUE(RoutingFunction(0).admitsVirtualChannel(head, 1, 1));
+    EXPECT_TRUE(RoutingFunction(0).admitsVirtualChannel(head, 0, -1));
+
+    // O1TURN: the classes split each phase
+    configuration.m_routingAlgorithm = "O1TURN";
+    configuration.m_virtualChannelNumber = 4;
+    configuration.apply();
+    head.m_routingPhase = 1;
+    EXPECT_EQ(RoutingFunction(0).computeDatelineClass(head, 3, 3, 1), 1);
+    EXPECT_EQ(RoutingFunction(0).computeDatelineClass(head, 3, 1, 1), 0);
+    EXPECT_TRUE(RoutingFunction(0).admitsVirtualChannel(head, 3, 1));
+    EXPECT_FALSE(RoutingFunction(0).admitsVirtualChannel(head, 1, 1));
+
+    // a mesh has no wrap-around links
+    configuration = makeConfiguration("MESH", "DOR", "source");
+    configuration.apply();
+    EXPECT_EQ(RoutingFunction(1).computeDatelineClass(head, 0, 1, 2), -1);
+}
+
+// Test that a torus ring loaded past saturation keeps delivering
+TEST(RoutingFunctionTest, DatelineSimulation)
+{
+    for (std::string mode : { "source", "distributed" }) {
+        SimulationConfiguration configuration = makeConfiguration("TORUS", "DOR", mode);
+        configuration.m_x = 8;
+        configuration.m_y = 1;
+        configuration.m_bufferSize = 2;
+        configuration.m_injectionRate = 0.2f;
+        configuration.m_totalCycles = 4000;
+        configuration.m_warmupCycles = 1000;
+        configuration.m_measurementCycles = 2000;
+        Performance performance = Simulation(configuration, makeOutputDirectory()).run(true, true, false);
+        EXPECT_GT(performance.m_throughput, 0.05f) << mode;
+    }
+}
+
+// Test the escape network of adaptive MAD: DOR ports, the lowest VCs and
+// their dateline classes on a torus
+TEST(RoutingFunctionTest, EscapeChannels)
+{
+    SimulationConfiguration configuration = makeConfiguration("TORUS", "MAD", "source");
+    configuration.m_selectionFunction = "max_credit";
+    configuration.m_virtualChannelNumber = 4;
+    configuration.m_escapeVirtualChannelNumber = 2;
+    configuration.apply();
+    RoutingFunction routingFunction(0);
+    ASSERT_TRUE(routingFunction.hasEscapeChannels());
+
+    Flit head(-1, {});
+    head.m_destination = -6;
+    EXPECT_EQ(routingFunction.computeEscapePort(head), 1);
+    EXPECT_EQ(RoutingFunction(5).computeEscapePort(head), -6);
+    // adaptive ports take the wrap-around links too
+    EXPECT_EQ(getOutputPorts(0, 0, 3), std::vector<int>({ 3 }));
+    EXPECT_EQ(getOutputPorts(0, 0, 15), std::vector<int>({ 3, 12 }));
+
+    EXPECT_FALSE(routingFunction.admitsVirtualChannel(head, 1));
+    EXPECT_TRUE(routingFunction.admitsVirtualChannel(head, 2));
+    EXPECT_TRUE(routingFunction.admitsEscapeVirtualChannel(0, 0));
+    EXPECT_FALSE(routingFunction.admitsEscapeVirtualChannel(1, 0));
+    EXPECT_TRUE(routingFunction.admitsEscapeVirtualChannel(1, 1));
+    EXPECT_FALSE(routingFunction.admitsEscapeVirtualChannel(2, -1));
+
+    EXPECT_EQ(routingFunction.computeEscapeClass(-1, 0, 3), 1);
+    EXPECT_EQ(routingFunction.computeEscapeClass(3, 1, 1), 1);
+    // from an adaptive VC the packet enters the escape network anew
+    EXPECT_EQ(routingFunction.computeEscapeClass(3, 3, 1), 0);
+    EXPECT_EQ(routingFunction.computeEscapeClass(3, 1, 4), 0);
+
+    // no VC left to route adaptively
+    configuration.m_escapeVirtualChannelNumber = 4;
+    configuration.apply();
+    EXPECT_FALSE(RoutingFunction(0).hasEscapeChannels());
+}
+
+// Test that a torus rejects a single escape VC, which would take the
+// wrap-around links without dateline classes, and all VCs as escape VCs
+TEST(RoutingFunctionTest, TorusSingleEscapeChannel)
+{
+    SimulationConfiguration configuration = makeConfiguration("TORUS", "MAD", "source");
+    configuration.m_selectionFunction = "max_credit";
+    configuration.m_virtualChannelNumber = 4;
+    configuration.m_escapeVirtualChannelNumber = 1;
+    std::ostringstream messages;
+    EXPECT_FALSE(configuration.validate(messages));
+    EXPECT_NE(messages.str().find("Error: the escape virtual channels of a torus"), std::string::npos);
+    configuration.apply();
+    EXPECT_FALSE(RoutingFunction(0).hasEscapeChannels());
+
+    configuration.m_escapeVirtualChannelNumber = 4;
+    EXPECT_FALSE(configuration.validate(messages));
+    configuration.m_escapeVirtualChannelNumber = 2;
+    EXPECT_TRUE(configuration.validate(messages));
+    configuration.m_escapeVirtualChannelNumber = -1;
+    EXPECT_TRUE(configuration.validate(messages));
+    EXPECT_EQ(configuration.getEscapeVirtualChannelNumber(), 2);
+    configuration.m_shape = "MESH";
+    configuration.m_escapeVirtualChannelNumber = 1;
+    EXPECT_TRUE(configuration.validate(messages));
+}
+
+// Test that a router falls back to the escape VC of the DOR port once the
+// adaptive VCs are taken
+TEST(RoutingFunctionTest, EscapeFallback)
+{
+    SimulationConfiguration configuration = makeConfiguration("MESH", "MAD", "source");
+    configuration.m_selectionFunction = "max_credit";
+    configuration.m_escapeVirtualChannelNumber = 1;
+    configuration.apply();
+    for (bool adaptiveTaken : { false, true }) {
+        // router 5 with its neighbours and terminal; head to router 10
+        Router router(5);
+        for (int portID : { 1, 4, 6, 9, -6 })
+            router.createPort(portID);
+        for (auto& port : router.m_ports) {
+            if (port->m_portID == 6)
+                port->m_controlFields.at(1).m_credit = 2;
+            if (adaptiveTaken)
+                port->m_controlFields.at(1).m_downstreamVirtualChannelState = VirtualChannelState::A;
+        }
+        Flit head(-1, {});
+        head.m_destination = -11;
+        router.m_ports[0]->m_virtualChannels[1].push_back(head);
+        router.m_ports[0]->m_controlFields[1].m_virtualChannelState = VirtualChannelState::R;
+        router.initiatePriorities(); // packs the VC states
+        router.runOneCycle();
+        router.updateEnable();
+        router.runOneCycle();
+        EXPECT_EQ(router.m_ports[0]->m_controlFields[1].m_routedOutputPort, adaptiveTaken ? 6 : 9);
+        EXPECT_EQ(router.m_ports[0]->m_controlFields[1].m_allocatedVirtualChannel, adaptiveTaken ? 0 : 1);
+    }
+}
+
+// Test that fully adaptive MAD with escape VCs delivers on mesh and torus
+TEST(RoutingFunctionTest, EscapeSimulation)
+{
+    for (std::string shape : { "MESH", "TORUS" }) {
+        SimulationConfiguration configuration = makeConfiguration(shape, "MAD", "source");
+        configuration.m_selectionFunction = "max_credit";
+        configuration.m_virtualChannelNumber = 4;
+        configuration.m_escapeVirtualChannelNumber = 2;
+        configuration.m_injectionRate = 0.02f;
+        Performance performance = Simulation(configuration, makeOutputDirectory()).run(true, true, false);
+        EXPECT_NEAR(performance.m_throughput, performance.m_demand, 0.005f) << shape;
+    }
+}
@@ -0,0 +1,372 @@
+#include <gtest/gtest.h>
+#include "Simulation.h"
+#include "Sweep.h"
+#include "TraceReplay.h"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <thread>
+
+static SimulationConfiguration makeConfiguration()
+{
+    SimulationConfiguration configuration;
+    configuration.m_x = 4;
+    configuration.m_y = 4;
+    configuration.m_z = 1;
+    configuration.m_shape = "MESH";
+    configuration.m_routingAlgorithm = "DOR";
+    configuration.m_virtualChannelNumber = 2;
+    configuration.m_bufferSize = 8;
+    configuration.m_flitSize = 1;
+    configuration.m_packetSize = 4;
+    configuration.m_packetSizeOption = "fixed";
+    configuration.m_injectionRate = 0.05f;
+    configuration.m_injectionProcess = "periodic";
+    configuration.m_trafficPattern = "random uniform";
+    configuration.m_totalCycles = 1000;
+    configuration.m_warmupCycles = 200;
+    configuration.m_measurementCycles = 500;
+    configuration.m_ejectionSink = "statistics";
+    configuration.m_traceBufferSize = 1 << 16;
+    configuration.m_traceBufferNumber = 2;
+    configuration.m_traceBackpressure = "block";
+    configuration.m_traceFormat = "csv";
+    configuration.m_statisticsWindow = 1000;
+    return configuration;
+}
+
+static std::string makeOutputDirectory(const std::string& name)
+{
+    std::string directory = "/tmp/test_simulation/" + name + "/";
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+// Test that a configuration round-trips through the globals and owns its strings
+TEST(SimulationTest, CaptureAndApply)
+{
+    SimulationConfiguration configuration = makeConfiguration();
+    configuration.apply();
+    EXPECT_EQ(g_x, 4);
+    EXPECT_EQ(g_shape, "MESH");
+    EXPECT_EQ(g_drainCycles, 300);
+    EXPECT_EQ(g_packetNumber, 50);
+
+    SimulationConfiguration captured = SimulationConfiguration::capture();
+    configuration.m_routingAlgorithm = "VAL";
+    EXPECT_EQ(captured.m_routingAlgorithm, "DOR");
+    EXPECT_EQ(captured.m_injectionRate, 0.05f);
+}
+
+// Test that the globals of one thread do not leak into another
+TEST(SimulationTest, GlobalsAreThreadLocal)
+{
+    SimulationConfiguration configuration = makeConfiguration();
+    configuration.apply();
+    int otherX = -1;
+    std::thread other([&otherX] { otherX = g_x; });
+    other.join();
+    EXPECT_EQ(otherX, 0);
+    EXPECT_EQ(g_x, 4);
+}
+
+// Test that simulations running concurrently give the sequential result
+TEST(SimulationTest, ConcurrentRunsMatchSequential)
+{
+    SimulationConfiguration configuration = makeConfiguration();
+    Performance sequential = Simulation(configuration,
+        makeOutputDirectory("sequential")).run(true, true, false);
+    EXPECT_GT(sequential.m_throughput, 0.0f);
+
+    Performance first, second;
+    std::thread firstThread([&] {
+        first = Simulation(configuration, makeOutputDirectory("first"))
+            .run(true, true, false); });
+    std::thread secondThread([&] {
+        second = Simulation(configuration, makeOutputDirectory("second"))
+            .run(true, true, false); });
+    firstThread.join();
+    secondThread.join();
+
+    EXPECT_EQ(first.m_throughput, sequential.m_throughput);
+    EXPECT_EQ(first.m_latency, sequential.m_latency);
+    EXPECT_EQ(second.m_throughput, sequential.m_throughput);
+    EXPECT_EQ(second.m_latency, sequential.m_latency);
+}
+
+// Test that shared routes give the same result as generated ones
+TEST(SimulationTest, SharedRoutingTables)
+{
+    SimulationConfiguration configuration = makeConfiguration();
+    configuration.m_routingAlgorithm = "MAD";
+    Simulation generating(configuration, makeOutputDirectory("generating"));
+    Performance generated = generating.run(true, true, false);
+
+    RoutingTables routingTables = generating.generateRoutingTables();
+    EXPECT_EQ(routingTables.size(), 16u);
+    Simulation sharing(configuration, makeOutputDirectory("sharing"));
+    sharing.setRoutingTables(&routingTables);
+    Performance shared = sharing.run(true, true, false);
+
+    EXPECT_EQ(shared.m_throughput, generated.m_throughput);
+    EXPECT_EQ(shared.m_latency, generated.m_latency);
+}
+
+// Test that a sweep runs every grid point and each matches a single run
+TEST(SimulationTest, SweepGrid)
+{
+    SweepGrid grid;
+    grid.m_injectionRates = { 0.02f, 0.05f };
+    grid.m_routingAlgorithms = { "DOR", "VAL" };
+    Sweep sweep(makeConfiguration(), grid, makeOutputDirectory("sweep"));
+    sweep.run(3);
+
+    ASSERT_EQ(sweep.getPoints().size(), 4u);
+    for (auto& point : sweep.getPoints()) {
+        Performance single = Simulation(point.m_configuration,
+            makeOutputDirectory("single")).run(true, true, false);
+        EXPECT_EQ(point.m_performance.m_throughput, single.m_throughput);
+        EXPECT_EQ(point.m_performance.m_latency, single.m_latency);
+    }
+
+    std::ostringstream table;
+    sweep.writeResults(table);
+    std::string text = table.str();
+    EXPECT_EQ(std::count(text.begin(), text.end(), '\n'), 5);
+}
+
+// Test that sweep points get the escape VCs of adaptive MAD like a single run
+TEST(SimulationTest, SweepReservesEscapeChannels)
+{
+    SimulationConfiguration configuration = makeConfiguration();
+    configuration.m_selectionFunction = "max_credit";
+    SweepGrid grid;
+    grid.m_routingAlgorithms = { "DOR", "MAD" };
+    grid.m_injectionRates = { 0.02f, 0.05f };
+    Sweep sweep(configuration, grid, makeOutputDirectory("escape"));
+    std::ostringstream messages;
+    EXPECT_TRUE(sweep.validate(messages));
+    EXPECT_EQ(messages.str(), "Warning: adaptive MAD reserves 1 escape virtual channel(s); "
+        "set escape_virtual_channels to choose\n");
+
+    for (auto& point : sweep.getPoints()) {
+        point.m_configuration.apply();
+        EXPECT_EQ(g_escapeVirtualChannelNumber, point.m_configuration.m_routingAlgorithm == "MAD" ? 1 : 0);
+    }
+    configuration.m_escapeVirtualChannelNumber = 0;
+    EXPECT_EQ(configuration.getEscapeVirtualChannelNumber(), 0);
+}
+
+// Test that a torus without VCs for its dateline classes is reported
+TEST(SimulationTest, DatelineWarning)
+{
+    SimulationConfiguration configuration = makeConfiguration();
+    configuration.m_shape = "TORUS";
+    std::ostringstream messages;
+    EXPECT_TRUE(configuration.validate(messages));
+    EXPECT_EQ(messages.str(), "");
+
+    configuration.m_routingAlgorithm = "VAL";
+    EXPECT_TRUE(configuration.validate(messages));
+    EXPECT_EQ(messages.str(), "Warning: VAL on a torus needs 4 virtual channels "
+        "for its dateline classes; with 2 it can deadlock\n");
+}
+
+// Test that lists are split on commas
+TEST(SimulationTest, SplitSweepList)
+{
+    auto values = splitSweepList("0.01,0.02,,0.05");
+    ASSERT_EQ(values.size(), 3u);
+    EXPECT_EQ(values[2], "0.05");
+}
+
+// Test that the port counters of the measurement window are written per port
+TEST(SimulationTest, LinkCounters)
+{
+    SimulationConfiguration configuration = makeConfiguration();
+    configuration.m_injectionRate = 0.5f; // saturated
+    configuration.m_bufferSize = 2; // shorter than a packet, so VCs run out of credits
+    configuration.m_linkCounters = true;
+    std::string directory = makeOutputDirectory("link_counters");
+    std::filesystem::remove(directory + "LinkCounters.json");
+    Simulation(configuration, directory).run(true, true, false);
+
+    std::ifstream file(directory + "LinkCounters.json");
+    ASSERT_TRUE(file.is_open());
+    std::string line;
+    std::getline(file, line);
+    EXPECT_NE(line.find("\"cycles\": 500"), std::string::npos);
+
+    // 16 terminal ports and 48 link directions of a 4x4 mesh
+    int rows = 0;
+    unsigned long long linkFlits = 0, ejectedFlits = 0, creditStalls = 0;
+    while (std::getline(file, line)) {
+        int router, port;
+        unsigned long long flits, stalls;
+        double occupancy;
+        if (std::sscanf(line.c_str(), " [%d, %d, %llu, %llu, %lf]",
+            &router, &port, &flits, &stalls, &occupancy) != 5)
+            continue;
+        ++rows;
+        EXPECT_GE(occupancy, 0.0);
+        EXPECT_LE(occupancy, 2.0 * 2); // two VCs of two flits
+        if (port < 0) {
+            EXPECT_EQ(port, -router - 1);
+            ejectedFlits += flits;
+        } else {
+            linkFlits += flits;
+            creditStalls += stalls;
+        }
+    }
+    EXPECT_EQ(rows, 64);
+    EXPECT_GT(ejectedFlits, 0u);
+    EXPECT_GT(linkFlits, ejectedFlits); // most packets take more than one hop
+    EXPECT_LE(ejectedFlits, 16u * 500); // a flit per terminal per cycle
+    EXPECT_GT(creditStalls, 0u);
+}
+
+// Test the exported counts of a single packet on a known DOR route: router
+// 0 to router 3 of the top row, through routers 1 and 2
+TEST(SimulationTest, LinkCountersOnKnownRoute)
+{
+    std::string directory = makeOutputDirectory("link_counters_route");
+    std::ofstream(directory + "route.csv") << "cycle,source,destination,size\n"
+        << "0,15,14,4\n" // a warmup packet, delivered before the window
+        << "300,0,3,4\n";
+    ASSERT_TRUE(convertReplayTrace(directory + "route.csv", directory + "route.rpl"));
+    SimulationConfiguration configuration = makeConfiguration();
+    configuration.m_injectionProcess = "trace";
+    configuration.m_replayTraceFile = directory + "route.rpl";
+    configuration.m_linkCounters = true;
+    std::filesystem::remove(directory + "LinkCounters.json");
+    Simulation(configuration, directory).run(true, true, false);
+
+    std::ifstream file(directory + "LinkCounters.json");
+    ASSERT_TRUE(file.is_open());
+    // a head, four data flits and a tail over every output port of the route
+    std::map<std::pair<int, int>, unsigned long long> routeFlits = {
+        { { 0, 1 }, 6 }, { { 1, 2 }, 6 }, { { 2, 3 }, 6 }, { { 3, -4 }, 6 } };
+    int rows = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        int router, port;
+        unsigned long long flits, stalls;
+        double occupancy;
+        if (std::sscanf(line.c_str(), " [%d, %d, %llu, %llu, %lf]",
+            &router, &port, &flits, &stalls, &occupancy) != 5)
+            continue;
+        ++rows;
+        auto hop = routeFlits.find({ router, port });
+        EXPECT_EQ(flits, hop == routeFlits.end() ? 0u : hop->second) << router << ' ' << port;
+        EXPECT_EQ(stalls, 0u) << router << ' ' << port;
+    }
+    EXPECT_EQ(rows, 64);
+}
+
+// Test that the latency parts add up to the latency with either sink
+TEST(SimulationTest, LatencyBreakdown)
+{
+    SimulationConfiguration configuration = makeConfiguration();
+    Performance online = Simulation(configuration,
+        makeOutputDirectory("breakdown_statistics")).run(true, true, false);
+    configuration.m_ejectionSink = "buffer";
+    Performance buffered = Simulation(configuration,
+        makeOutputDirectory("breakdown_buffer")).run(true, true, false);
+
+    for (const Performance& performance : { online, buffered }) {
+        EXPECT_NEAR(performance.m_queueingLatency + performance.m_networkLatency
+            + performance.m_serialisationLatency, performance.m_latency, 0.01f);
+        EXPECT_GE(performance.m_queueingLatency, 0.0f);
+        EXPECT_GT(performance.m_networkLatency, 0.0f);
+        EXPECT_GE(performance.m_serialisationLatency, 5.0f); // 6 flits follow the head
+    }
+    EXPECT_FLOAT_EQ(buffered.m_latency, online.m_latency);
+    EXPECT_FLOAT_EQ(buffered.m_queueingLatency, online.m_queueingLatency);
+    EXPECT_FLOAT_EQ(buffered.m_networkLatency, online.m_networkLatency);
+    EXPECT_FLOAT_EQ(buffered.m_serialisationLatency, online.m_serialisationLatency);
+
+    // past saturation the packets mostly wait in their source queues
+    configuration.m_ejectionSink = "statistics";
+    configuration.m_injectionRate = 0.15f;
+    Performance saturated = Simulation(configuration,
+        makeOutputDirectory("breakdown_saturated")).run(true, true, false);
+    EXPECT_GT(saturated.m_queueingLatency, saturated.m_networkLatency);
+    EXPECT_GT(saturated.m_queueingLatency, online.m_queueingLatency);
+}
+
+// Test that a bounded source queue stalls or drops packets past saturation
+TEST(SimulationTest, SourceQueueCapacity)
+{
+    SimulationConfiguration configuration = makeConfiguration();
+    configuration.m_injectionRate = 0.15f; // saturated
+    Simulation unbounded(configuration, makeOutputDirectory("queue_unbounded"));
+    Performance unboundedPerformance = unbounded.run(true, true, false);
+    EXPECT_EQ(unbounded.getStalledPacketNumber(), 0);
+    EXPECT_EQ(unbounded.getDroppedPacketNumber(), 0);
+
+    configuration.m_sourceQueueCapacity = 16; // flits; a packet is 6
+    configuration.m_sourceQueueHistograms = true;
+    std::string directory = makeOutputDirectory("queue_stall");
+    Simulation stalling(configuration, directory);
+    Performance stalled = stalling.run(true, true, false);
+    EXPECT_GT(stalling.getStalledPacketNumber(), 0);
+    EXPECT_EQ(stalling.getDroppedPacketNumber(), 0);
+    // the queue never runs dry, so the network sees the same flits; the
+    // wait for room counts in the latency, so a stall does not hide it
+    EXPECT_EQ(stalled.m_throughput, unboundedPerformance.m_throughput);
+    EXPECT_GE(stalled.m_queueingLatency, unboundedPerformance.m_queueingLatency);
+
+    std::ifstream file(directory + "SourceQueues.json");
+    ASSERT_TRUE(file.is_open());
+    std::string line;
+    std::getline(file, line);
+    EXPECT_NE(line.find("\"capacity\": 16, \"policy\": \"stall\", \"cycles\": 500"),
+        std::string::npos);
+    int rows = 0;
+    long long stalls = 0;
+    while (std::getline(file, line)) {
+        int terminal;
+        long long terminalStalls, drops;
+        if (std::sscanf(line.c_str(), " [%d, %lld, %lld, [", &terminal,
+            &terminalStalls, &drops) != 3)
+            continue;
+        ++rows;
+        stalls += terminalStalls;
+        EXPECT_EQ(drops, 0);
+        // below 16 flits plus a packet: depth buckets up to 16..31
+        std::istringstream histogram(line.substr(line.rfind('[') + 1));
+        long long cycles = 0, bucketCycles;
+        int bucket = 0;
+        char separator;
+        while (histogram >> bucketCycles) {
+            if (bucket > 5) {
+                EXPECT_EQ(bucketCycles, 0);
+            }
+            cycles += bucketCycles;
+            ++bucket;
+            histogram >> separator;
+        }
+        EXPECT_EQ(cycles, 500);
+    }
+    EXPECT_EQ(rows, 16);
+    EXPECT_EQ(stalls, stalling.getStalledPacketNumber());
+
+    configuration.m_sourceQueuePolicy = "drop";
+    Simulation dropping(configuration, makeOutputDirectory("queue_drop"));
+    Performance dropped = dropping.run(true, true, false);
+    EXPECT_EQ(dropping.getStalledPacketNumber(), 0);
+    EXPECT_GT(dropping.getDroppedPacketNumber(), 0);
+    EXPECT_LT(dropped.m_demand, unboundedPerformance.m_demand);
+}
+
+// Test that source queue depths fall in power-of-two buckets
+TEST(SimulationTest, SourceQueueDepthBuckets)
+{
+    EXPECT_EQ(TerminalInterface::getDepthBucket(0), 0);
+    EXPECT_EQ(TerminalInterface::getDepthBucket(1), 1);
+    EXPECT_EQ(TerminalInterface::getDepthBucket(3), 2);
+    EXPECT_EQ(TerminalInterface::getDepthBucket(4), 3);
+    for (int bucket = 0; bucket < 20; ++bucket)
+        EXPECT_EQ(TerminalInterface::getDepthBucket(
+            TerminalInterface::getDepthBucketStart(bucket)), bucket);
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include "Telemetry.h"
+#include "Simulation.h"
+#include <filesystem>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static std::string makeOutputDirectory(const std::string& name)
+{
+    std::string directory = "/tmp/test_telemetry/" + name + "/";
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+// map a telemetry file the way a watching process would
+class TelemetryMapping
+{
+public:
+    TelemetryMapping(const std::string& filePath)
+    {
+        m_fileDescriptor = open(filePath.c_str(), O_RDONLY);
+        void* mapping = mmap(nullptr, sizeof(TelemetryBlock), PROT_READ, MAP_SHARED,
+            m_fileDescriptor, 0);
+        if (mapping != MAP_FAILED)
+            m_block = static_cast<const TelemetryBlock*>(mapping);
+    }
+    ~TelemetryMapping()
+    {
+        if (m_block)
+            munmap(const_cast<TelemetryBlock*>(m_block), sizeof(TelemetryBlock));
+        if (m_fileDescriptor >= 0)
+            close(m_fileDescriptor);
+    }
+
+    int m_fileDescriptor = -1;
+    const TelemetryBlock* m_block = nullptr;
+};
+
+// Test that every latency falls in a bucket ending within 1/16 above it
+TEST(TelemetryTest, LatencyBuckets)
+{
+    int lastBucket = 0;
+    for (long long latency = 0; latency < 100000; ++latency) {
+        int bucket = Telemetry::getLatencyBucket(latency);
+        EXPECT_GE(bucket, lastBucket);
+        lastBucket = bucket;
+        long long end = Telemetry::getLatencyBucketEnd(bucket);
+        EXPECT_GE(end, latency);
+        EXPECT_LE(end - latency, latency / 16);
+    }
+    EXPECT_EQ(Telemetry::getLatencyBucket(-3), 0);
+}
+
+// Test that a published snapshot reads back through another mapping
+TEST(TelemetryTest, PublishAndRead)
+{
+    std::string filePath = makeOutputDirectory("publish") + "Telemetry.stats";
+    g_totalCycles = 1000;
+    Telemetry telemetry(filePath);
+    ASSERT_TRUE(telemetry.isOpen());
+    Telemetry::setActive(&telemetry);
+    for (int i = 0; i < 100; ++i)
+        Telemetry::countInjection();
+    for (int i = 0; i < 99; ++i)
+        Telemetry::countDelivery(10.0f);
+    Telemetry::countDelivery(1000.0f);
+    Telemetry::setActive(nullptr);
+    Telemetry::countInjection(); // not counted
+    telemetry.publish(500, 12, 5);
+
+    TelemetryMapping mapping(filePath);
+    ASSERT_NE(mapping.m_block, nullptr);
+    TelemetrySnapshot snapshot;
+    ASSERT_TRUE(readTelemetry(*mapping.m_block, snapshot));
+    EXPECT_EQ(snapshot.m_processID, getpid());
+    EXPECT_EQ(snapshot.m_cycle, 500);
+    EXPECT_EQ(snapshot.m_totalCycles, 1000);
+    EXPECT_EQ(snapshot.m_injectedPackets, 100);
+    EXPECT_EQ(snapshot.m_deliveredPackets, 100);
+    EXPECT_EQ(snapshot.m_inFlightPackets, 0);
+    EXPECT_DOUBLE_EQ(snapshot.m_meanLatency, (99 * 10.0 + 1000.0) / 100);
+    EXPECT_EQ(snapshot.m_p99Latency, 1023.0); // the bucket of 1000
+    EXPECT_EQ(snapshot.m_sourceQueueFlits, 12);
+    EXPECT_EQ(snapshot.m_maxSourceQueueFlits, 5);
+}
+
+// Test that a reader never sees a torn snapshot while the writer publishes
+TEST(TelemetryTest, SeqlockUnderConcurrentWrites)
+{
+    std::string filePath = makeOutputDirectory("seqlock") + "Telemetry.stats";
+    Telemetry telemetry(filePath);
+    TelemetryMapping mapping(filePath);
+    ASSERT_NE(mapping.m_block, nullptr);
+
+    std::thread writer([&telemetry]() {
+        for (long long cycle = 1; cycle <= 200000; ++cycle)
+            telemetry.publish(cycle, cycle, cycle);
+    });
+    int reads = 0;
+    TelemetrySnapshot snapshot;
+    while (reads < 200000) {
+        if (readTelemetry(*mapping.m_block, snapshot)) {
+            EXPECT_EQ(snapshot.m_sourceQueueFlits, snapshot.m_cycle);
+            EXPECT_EQ(snapshot.m_maxSourceQueueFlits, snapshot.m_cycle);
+        }
+        ++reads;
+    }
+    writer.join();
+    ASSERT_TRUE(readTelemetry(*mapping.m_block, snapshot));
+    EXPECT_EQ(snapshot.m_cycle, 200000);
+}
+
+// Test that a run publishes its progress and ends with its last cycle
+TEST(TelemetryTest, Simulation)
+{
+    SimulationConfiguration configuration;
+    configuration.m_x = 4;
+    configuration.m_y = 4;
+    configuration.m_z = 1;
+    configuration.m_shape = "MESH";
+    configuration.m_routingAlgorithm = "DOR";
+    configuration.m_virtualChannelNumber = 2;
+    configuration.m_bufferSize = 8;
+    configuration.m_flitSize = 1;
+    configuration.m_packetSize = 4;
+    configuration.m_packetSizeOption = "fixed";
+    configuration.m_injectionRate = 0.05f;
+    configuration.m_injectionProcess = "periodic";
+    configuration.m_trafficPattern = "random uniform";
+    configuration.m_totalCycles = 1000;
+    configuration.m_warmupCycles = 200;
+    configuration.m_measurementCycles = 500;
+    configuration.m_ejectionSink = "statistics";
+    configuration.m_traceBufferSize = 1 << 16;
+    configuration.m_traceBufferNumber = 2;
+    configuration.m_traceBackpressure = "block";
+    configuration.m_traceFormat = "csv";
+    configuration.m_statisticsWindow = 1000;
+    configuration.m_telemetryInterval = 100;
+    std::string directory = makeOutputDirectory("simulation");
+    Simulation(configuration, directory).run(true, true, false);
+
+    TelemetryMapping mapping(directory + "Telemetry.stats");
+    ASSERT_NE(mapping.m_block, nullptr);
+    TelemetrySnapshot snapshot;
+    ASSERT_TRUE(readTelemetry(*mapping.m_block, snapshot));
+    EXPECT_EQ(snapshot.m_cycle, 1000);
+    EXPECT_EQ(snapshot.m_totalCycles, 1000);
+    EXPECT_EQ(snapshot.m_injectedPackets, 16 * 50);
+    EXPECT_GT(snapshot.m_deliveredPackets, 0);
+    EXPECT_EQ(snapshot.m_injectedPackets,
+        snapshot.m_deliveredPackets + snapshot.m_inFlightPackets);
+    EXPECT_GT(snapshot.m_meanLatency, 0.0);
+    EXPECT_GE(snapshot.m_p99Latency, snapshot.m_meanLatency);
+    EXPECT_GE(snapshot.m_sourceQueueFlits, snapshot.m_maxSourceQueueFlits);
+}
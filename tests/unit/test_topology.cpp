@@ -34,8 +34,7 @@ TEST(TopologyTest, Mesh2DConstruction)
     
     // Create terminal interfaces
     for (int i = 0; i < 4; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
@@ -74,8 +73,7 @@ TEST(TopologyTest, Torus2DConstruction)
     
     // Create terminal interfaces
     for (int i = 0; i < 4; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
@@ -114,8 +112,7 @@ TEST(TopologyTest, Mesh3DConstruction)
     
     // Create terminal interfaces
     for (int i = 0; i < 2; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
@@ -154,8 +151,7 @@ TEST(TopologyTest, Torus3DConstruction)
     
     // Create terminal interfaces
     for (int i = 0; i < 2; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
@@ -194,8 +190,7 @@ TEST(TopologyTest, SmallNetwork1x1)
     
     // Create terminal interfaces
     for (int i = 0; i < 1; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
@@ -234,8 +229,7 @@ TEST(TopologyTest, DifferentNetworkSizes)
     
     // Create terminal interfaces
     for (int i = 0; i < 8; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
@@ -274,8 +268,7 @@ TEST(TopologyTest, RouterProperties)
 
     // Create terminal interfaces
     for (int i = 0; i < 4; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -313,8 +306,7 @@ TEST(TopologyTest, LinkCreation)
 
     // Create terminal interfaces
     for (int i = 0; i < 4; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -352,8 +344,7 @@ TEST(TopologyTest, TerminalInterfaceConnection)
     
     // Create terminal interfaces
     for (int i = 0; i < 4; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
     
     network.loadNetworkData();
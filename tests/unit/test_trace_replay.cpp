@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "TraceReplay.h"
+#include <filesystem>
+
+static std::string makeReplayTrace(const std::string& name, const std::string& csv)
+{
+    std::filesystem::create_directories("/tmp/test_trace_replay");
+    std::string csvPath = "/tmp/test_trace_replay/" + name + ".csv";
+    std::string tracePath = "/tmp/test_trace_replay/" + name + ".rpl";
+    std::ofstream(csvPath) << "cycle,source,destination,size\n" << csv;
+    EXPECT_TRUE(convertReplayTrace(csvPath, tracePath));
+    return tracePath;
+}
+
+// Test that the converted file is a header followed by 16 byte records
+TEST(TraceReplayTest, ConvertLayout)
+{
+    std::string tracePath = makeReplayTrace("layout", "1000,0,1,4\n1002,1,0,8\n");
+    EXPECT_EQ(std::filesystem::file_size(tracePath), 16u + 2 * 16u);
+
+    TraceReplay replay(tracePath, 4);
+    ASSERT_TRUE(replay.isOpen());
+    EXPECT_EQ(replay.getRecordNumber(), 2u);
+}
+
+// Test that packets are handed to their source at the recorded cycle,
+// relative to the first record
+TEST(TraceReplayTest, InjectAtRecordedCycle)
+{
+    std::string tracePath = makeReplayTrace("cycles",
+        "1005,2,0,8\n1000,0,3,4\n1005,0,1,4\n1010,3,2,20\n");
+    TraceReplay replay(tracePath, 4);
+    ASSERT_TRUE(replay.isOpen());
+
+    TrafficInformationEntry entry;
+    ASSERT_TRUE(replay.getPacket(-1, 0, entry));
+    EXPECT_EQ(entry.m_packetID, 0);
+    EXPECT_EQ(entry.m_source, -1);
+    EXPECT_EQ(entry.m_destination, -4);
+    EXPECT_EQ(entry.m_packetSize, 4);
+    EXPECT_FALSE(replay.getPacket(-1, 4, entry));
+    EXPECT_FALSE(replay.getPacket(-3, 4, entry));
+
+    ASSERT_TRUE(replay.getPacket(-1, 5, entry));
+    EXPECT_EQ(entry.m_packetID, 1);
+    EXPECT_EQ(entry.m_destination, -2);
+    ASSERT_TRUE(replay.getPacket(-3, 5, entry));
+    EXPECT_EQ(entry.m_packetID, 0);
+    EXPECT_EQ(entry.m_packetSize, 8);
+    EXPECT_FALSE(replay.getPacket(-4, 9, entry));
+
+    // a terminal that polls late still gets its packet
+    ASSERT_TRUE(replay.getPacket(-4, 50, entry));
+    EXPECT_EQ(entry.m_destination, -3);
+    EXPECT_EQ(entry.m_packetSize, 20);
+}
+
+// Test that records with terminals outside the network are skipped
+TEST(TraceReplayTest, SkipInvalidRecords)
+{
+    std::string tracePath = makeReplayTrace("invalid",
+        "0,0,9,4\n0,1,1,4\n0,1,2,0\n0,1,2,4\n");
+    TraceReplay replay(tracePath, 4);
+    TrafficInformationEntry entry;
+    EXPECT_FALSE(replay.getPacket(-1, 0, entry));
+    ASSERT_TRUE(replay.getPacket(-2, 0, entry));
+    EXPECT_EQ(entry.m_destination, -3);
+    EXPECT_FALSE(replay.getPacket(-2, 0, entry));
+}
+
+// Test that a source that stops taking packets reads its records later, in
+// order and with their recorded cycles, while the other sources go on
+TEST(TraceReplayTest, SourceFallsBehind)
+{
+    std::string csv;
+    for (int cycle = 0; cycle < 200; ++cycle)
+        csv += std::to_string(cycle) + ",0,1,4\n" + std::to_string(cycle) + ",1,0,4\n";
+    std::string tracePath = makeReplayTrace("behind", csv);
+    TraceReplay replay(tracePath, 2);
+    TrafficInformationEntry entry;
+    for (int cycle = 0; cycle < 200; ++cycle) {
+        ASSERT_TRUE(replay.getPacket(-2, cycle, entry));
+        EXPECT_EQ(entry.m_packetID, cycle);
+        EXPECT_FLOAT_EQ(entry.m_sentTime, cycle);
+    }
+    EXPECT_FALSE(replay.getPacket(-2, 200, entry));
+
+    for (int packet = 0; packet < 200; ++packet) {
+        ASSERT_TRUE(replay.getPacket(-1, 200, entry));
+        EXPECT_EQ(entry.m_packetID, packet);
+        EXPECT_EQ(entry.m_destination, -2);
+        EXPECT_FLOAT_EQ(entry.m_sentTime, packet);
+    }
+    EXPECT_FALSE(replay.getPacket(-1, 200, entry));
+}
+
+// Test that a missing file is reported
+TEST(TraceReplayTest, MissingFile)
+{
+    TraceReplay replay("/tmp/test_trace_replay/missing.rpl", 4);
+    EXPECT_FALSE(replay.isOpen());
+    TrafficInformationEntry entry;
+    EXPECT_FALSE(replay.getPacket(-1, 100, entry));
+}
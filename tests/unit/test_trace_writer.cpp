@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "TraceWriter.h"
+#include <filesystem>
+
+static std::string readFile(const std::string& filePath)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+// Test that every record reaches the file once the writer is closed
+TEST(TraceWriterTest, WritesAllRecords)
+{
+    std::filesystem::create_directories("/tmp/test_trace_writer");
+    std::string filePath = "/tmp/test_trace_writer/block.csv";
+
+    // small buffers force many hand-offs to the I/O thread
+    TraceWriter writer(filePath, 64, 2, BackpressurePolicy::Block);
+    std::string expected;
+    for (int i = 0; i < 1000; ++i) {
+        writer << i << ',' << static_cast<float>(i) / 2 << ',' << "R" << '\n';
+        writer.endRecord();
+        expected += std::to_string(i) + ",";
+        expected += (i % 2 ? std::to_string(i / 2) + ".5" : std::to_string(i / 2));
+        expected += ",R\n";
+    }
+    writer.close();
+
+    EXPECT_EQ(writer.getDroppedRecordNumber(), 0);
+    EXPECT_EQ(readFile(filePath), expected);
+}
+
+// Test that the drop policy only ever loses whole records
+TEST(TraceWriterTest, DropPolicyKeepsRecordsWhole)
+{
+    std::filesystem::create_directories("/tmp/test_trace_writer");
+    std::string filePath = "/tmp/test_trace_writer/drop.csv";
+
+    const int recordNumber = 100000;
+    TraceWriter writer(filePath, 256, 2, BackpressurePolicy::Drop);
+    for (int i = 0; i < recordNumber; ++i) {
+        writer << "record," << i << '\n';
+        writer.endRecord();
+    }
+    writer.close();
+
+    std::istringstream content(readFile(filePath));
+    std::string line;
+    long long writtenRecordNumber = 0;
+    while (std::getline(content, line)) {
+        EXPECT_EQ(line.rfind("record,", 0), 0u);
+        writtenRecordNumber++;
+    }
+    EXPECT_EQ(writtenRecordNumber + writer.getDroppedRecordNumber(), recordNumber);
+}
+
+// Test that closing twice is harmless
+TEST(TraceWriterTest, CloseIsIdempotent)
+{
+    std::filesystem::create_directories("/tmp/test_trace_writer");
+    TraceWriter writer("/tmp/test_trace_writer/close.csv", 1024, 2,
+        BackpressurePolicy::Block);
+    writer << "a" << '\n';
+    writer.endRecord();
+    writer.close();
+    writer.close();
+    EXPECT_FALSE(writer.isOpen());
+    EXPECT_EQ(readFile("/tmp/test_trace_writer/close.csv"), "a\n");
+}
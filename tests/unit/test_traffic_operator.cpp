@@ -34,8 +34,7 @@ TEST(TrafficOperatorTest, Construction)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -79,8 +78,7 @@ TEST(TrafficOperatorTest, GenerateRandomUniform)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -127,8 +125,7 @@ TEST(TrafficOperatorTest, GeneratePermutation)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -175,8 +172,7 @@ TEST(TrafficOperatorTest, PeriodicInjectionProcess)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -223,8 +219,7 @@ TEST(TrafficOperatorTest, BernoulliInjectionProcess)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -271,8 +266,7 @@ TEST(TrafficOperatorTest, MarkovInjectionProcess)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -318,8 +312,7 @@ TEST(TrafficOperatorTest, DifferentInjectionRates)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -368,8 +361,7 @@ TEST(TrafficOperatorTest, DifferentPacketSizes)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -419,8 +411,7 @@ TEST(TrafficOperatorTest, DifferentNetworkSizes)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 4; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -463,8 +454,7 @@ TEST(TrafficOperatorTest, ThreeDNetwork)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 8; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -507,8 +497,7 @@ TEST(TrafficOperatorTest, TorusTopology)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -550,8 +539,7 @@ TEST(TrafficOperatorTest, DifferentTrafficPatterns)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -601,8 +589,7 @@ TEST(TrafficOperatorTest, VariablePacketSize)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -645,8 +632,7 @@ TEST(TrafficOperatorTest, HighInjectionRate)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -689,8 +675,7 @@ TEST(TrafficOperatorTest, LowInjectionRate)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -733,8 +718,7 @@ TEST(TrafficOperatorTest, AnalyzeTraffic)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -780,8 +764,7 @@ TEST(TrafficOperatorTest, MultipleGenerations)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -831,8 +814,7 @@ TEST(TrafficOperatorTest, SmallNetwork)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 4; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -875,8 +857,7 @@ TEST(TrafficOperatorTest, LargeNetwork)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 64; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -917,8 +898,7 @@ TEST(TrafficOperatorTest, MarkovWithDifferentParameters)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -969,8 +949,7 @@ TEST(TrafficOperatorTest, DifferentCycleConfigurations)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();
@@ -1027,8 +1006,7 @@ TEST(TrafficOperatorTest, DifferentPacketNumbers)
 
     // Create terminal interfaces (one per router)
     for (int i = 0; i < 16; ++i) {
-        TerminalInterface* ti = new TerminalInterface(-i - 1);
-        network.connectTerminal(i, ti);
+        network.connectTerminal(i);
     }
 
     network.loadNetworkData();